@@ -9,6 +9,7 @@ struct file {
 	off_t pos;                  /* Current position. */
 	bool deny_write;            /* Has file_deny_write() been called? */
 	int ref_cnt;
+	struct file_ra ra;          /* Fault-around state of mappings. */
 };
 
 /* Opens a file for the given INODE, of which it takes ownership,
@@ -67,6 +68,13 @@ file_get_inode (struct file *file) {
 	return file->inode;
 }
 
+/* Returns the fault-around state of memory mappings of FILE.
+ * It starts out zeroed. */
+struct file_ra *
+file_get_ra (struct file *file) {
+	return &file->ra;
+}
+
 /* Reads SIZE bytes from FILE into BUFFER,
  * starting at the file's current position.
  * Returns the number of bytes actually read,
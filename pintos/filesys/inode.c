@@ -9,6 +9,9 @@
 #include "filesys/free-map.h"
 #include "threads/malloc.h"
 #include "threads/synch.h"
+#ifdef VM
+#include "vm/text.h"
+#endif
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -159,6 +162,11 @@ void inode_close(struct inode *inode) {
     if (--inode->open_cnt == 0) {
         /* Remove from inode list and release lock. */
         list_remove(&inode->elem);
+#ifdef VM
+        /* Forget its shared text pages before the inode's address
+           can be reused by another inode. */
+        text_invalidate(inode, 0, inode_length(inode));
+#endif
 
         /* Deallocate blocks if removed. */
         if (inode->removed) {
@@ -238,6 +246,10 @@ off_t inode_write_at(struct inode *inode, const void *buffer_, off_t size, off_t
 
     if (inode->deny_write_cnt)
         return 0;
+#ifdef VM
+    /* Later faults must read the new contents. */
+    text_invalidate(inode, offset, size);
+#endif
 
     while (size > 0) {
         /* Sector to write, starting byte offset within sector. */
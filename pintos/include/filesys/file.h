@@ -5,12 +5,21 @@
 
 struct inode;
 
+/* Fault-around state of the memory mappings of a file, kept by the
+ * VM system. */
+struct file_ra {
+	int window;                 /* Pages to map at the next fault, 0 if unset. */
+	void *start;                /* First page mapped at the last fault. */
+	int cnt;                    /* Pages mapped at the last fault. */
+};
+
 /* Opening and closing files. */
 struct file *file_open (struct inode *);
 struct file *file_reopen (struct file *);
 struct file *file_duplicate (struct file *file);
 void file_close (struct file *);
 struct inode *file_get_inode (struct file *);
+struct file_ra *file_get_ra (struct file *);
 
 /* Reading and writing. */
 off_t file_read (struct file *, void *, off_t);
@@ -0,0 +1,25 @@
+#ifndef __LIB_MMAN_H
+#define __LIB_MMAN_H
+
+/* Flags for mmap()'s WRITABLE argument, besides the writable bit. */
+#define MAP_POPULATE 0x100          /* Fault in the whole mapping now. */
+#define MAP_ANONYMOUS 0x200         /* No file: zero-filled memory shared
+                                       with children forked later. */
+
+/* Hints for madvise(). */
+#define MADV_NORMAL 0               /* No particular access pattern. */
+#define MADV_RANDOM 1               /* Random access: no readahead. */
+#define MADV_SEQUENTIAL 2           /* Sequential access: read far ahead,
+                                       drop pages behind. */
+#define MADV_WILLNEED 3             /* Read the range in now. */
+#define MADV_DONTNEED 4             /* Drop the range now; anonymous pages
+                                       read back as zeros. */
+#define MADV_FREE 8                 /* Drop the range when memory is short,
+                                       unless written first. */
+
+/* Flags for msync(). */
+#define MS_ASYNC 1                  /* Start writing; may return early. */
+#define MS_INVALIDATE 2             /* Drop cached copies of the file. */
+#define MS_SYNC 4                   /* Write and wait until done. */
+
+#endif /* lib/mman.h */
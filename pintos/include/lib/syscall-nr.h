@@ -36,6 +36,18 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Extra for Project 3 */
+	SYS_MEMSTAT,                /* Report memory usage. */
+	SYS_MADVISE,                /* Give an access pattern hint. */
+	SYS_MLOCK,                  /* Keep pages resident. */
+	SYS_MUNLOCK,                /* Allow locked pages to be evicted. */
+	SYS_MSYNC,                  /* Write a mapping's dirty pages back. */
+	SYS_VMSTAT,                 /* Report virtual memory event counts. */
+	SYS_UFFD_REGISTER,          /* Hand a range's faults to user code. */
+	SYS_UFFD_READ,              /* Wait for a fault to handle. */
+	SYS_UFFD_COPY,              /* Supply pages by copying. */
+	SYS_UFFD_ZERO,              /* Supply zero-filled pages. */
 };
 
 #endif /* lib/syscall-nr.h */
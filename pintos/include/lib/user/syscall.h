@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <mman.h>
+#include <vmstat.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -42,6 +44,50 @@ int dup2(int oldfd, int newfd);
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap (void *addr);
 
+/* Memory usage, in pages, as reported by memstat(). */
+struct memstat {
+	size_t rss;                 /* Resident pages of this process. */
+	size_t rss_peak;            /* Largest RSS so far. */
+	size_t swap;                /* Swapped-out pages of this process. */
+	size_t pgtable;             /* Page-table pages of this process. */
+	size_t user_total;          /* User pool size. */
+	size_t user_free;           /* Free pages in the user pool. */
+	size_t wmark_min;           /* User pool watermarks. */
+	size_t wmark_low;
+	size_t wmark_high;
+	size_t kernel_total;        /* Kernel pool size. */
+	size_t kernel_free;         /* Free pages in the kernel pool. */
+	size_t swap_total;          /* Swap slots. */
+	size_t swap_used;           /* Swap slots in use. */
+	size_t locked;              /* Pages locked by mlock(). */
+	size_t locked_limit;        /* Most pages a process may lock. */
+	size_t wss;                 /* Working set: pages referenced in the
+	                               last few samples. */
+	size_t wss_peak;            /* Largest working set so far. */
+	unsigned idle_samples;      /* Samples in a row in which this process
+	                               referenced none of its pages. */
+};
+
+/* Extra for Project 3 */
+bool memstat (struct memstat *);
+int madvise (void *addr, size_t length, int advice);
+int mlock (const void *addr, size_t length);
+int munlock (const void *addr, size_t length);
+int msync (void *addr, size_t length, int flags);
+bool vmstat (int who, struct vmstat *);
+
+/* A fault taken in a range registered with uffd_register(), as
+   reported to its handler by uffd_read(). */
+struct uffd_msg {
+	void *addr;                 /* Page that faulted. */
+	bool write;                 /* Faulted on a write. */
+};
+
+int uffd_register (void *addr, size_t length);
+bool uffd_read (struct uffd_msg *);
+int uffd_copy (void *dst, const void *src, size_t length);
+int uffd_zero (void *dst, size_t length);
+
 /* Project 4 only. */
 bool chdir (const char *dir);
 bool mkdir (const char *dir);
@@ -78,4 +124,14 @@ get_fs_disk_write_cnt (void) {
 	return write_cnt;
 }
 
+/* Returns the count of virtual memory EVENT, an enum vmstat_event,
+   for the calling process, or for the whole system if ALL. */
+static inline long long
+get_vm_event_cnt (int event, bool all) {
+	long long cnt;
+	asm volatile ("int $0x45" : "=a" (cnt) : "a" ((long long) event),
+			"d" ((long long) all) : "memory");
+	return cnt;
+}
+
 #endif /* lib/user/syscall.h */
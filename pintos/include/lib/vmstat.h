@@ -0,0 +1,51 @@
+#ifndef __LIB_VMSTAT_H
+#define __LIB_VMSTAT_H
+
+#include <stddef.h>
+
+/* Virtual memory events counted by the kernel, both for each process
+   and for the whole system.  Read them with vmstat(), or one at a time
+   with get_vm_event_cnt(). */
+enum vmstat_event {
+	VMSTAT_FAULT,               /* Page faults taken. */
+	VMSTAT_FAULT_MAJOR,         /* Faults that read from swap or a file,
+	                               or waited for a user-level handler. */
+	VMSTAT_FAULT_MINOR,         /* Faults handled without I/O. */
+	VMSTAT_FAULT_ZERO,          /* Read faults given the zero page. */
+	VMSTAT_FAULT_COW,           /* Write faults that copied a page. */
+	VMSTAT_FAULT_STACK,         /* Faults that grew the stack. */
+	VMSTAT_FAULT_USER,          /* Faults resolved by a user-level
+	                               handler. */
+	VMSTAT_FAULT_BAD,           /* Faults that could not be handled. */
+	VMSTAT_SWAP_IN,             /* Pages read from swap, readahead
+	                               included. */
+	VMSTAT_SWAP_OUT,            /* Pages written to swap. */
+	VMSTAT_FILE_IN,             /* Pages read from files. */
+	VMSTAT_EVICT,               /* Frames evicted. */
+	VMSTAT_SCAN,                /* Frames looked at to find victims. */
+	VMSTAT_TRIM,                /* Cold pages of idle processes reclaimed
+	                               ahead of need. */
+	VMSTAT_KSM_MERGE,           /* Pages moved onto a frame with the same
+	                               contents by ksmd. */
+	VMSTAT_EVENT_CNT
+};
+
+/* Arguments to vmstat(). */
+#define VMSTAT_SELF 0               /* The calling process. */
+#define VMSTAT_ALL 1                /* The whole system since boot. */
+
+/* Fault-service time histogram: bucket I counts faults that took
+   from 2^I up to 2^(I+1) cycles.  The last bucket also counts
+   anything longer. */
+#define VMSTAT_HIST_BUCKETS 32
+
+struct vmstat {
+	long long events[VMSTAT_EVENT_CNT];
+	/* Whole system, for either argument. */
+	long long minor_hist[VMSTAT_HIST_BUCKETS];
+	long long major_hist[VMSTAT_HIST_BUCKETS];
+	size_t swap_total;          /* Swap slots. */
+	size_t swap_used;           /* Swap slots in use. */
+};
+
+#endif /* lib/vmstat.h */
@@ -0,0 +1,17 @@
+#ifndef THREADS_MTRACE_H
+#define THREADS_MTRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Allocation tracing.  See mtrace.c. */
+
+/* -mtrace: Record malloc() and palloc allocations? */
+extern bool mtrace_enabled;
+
+void mtrace_init (void);
+void mtrace_alloc (void *ptr, size_t size, void *site);
+void mtrace_free (void *ptr);
+void mtrace_dump (void);
+
+#endif /* threads/mtrace.h */
@@ -1,6 +1,7 @@
 #ifndef THREADS_PALLOC_H
 #define THREADS_PALLOC_H
 
+#include <list.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -8,7 +9,8 @@
 enum palloc_flags {
 	PAL_ASSERT = 001,           /* Panic on failure. */
 	PAL_ZERO = 002,             /* Zero page contents. */
-	PAL_USER = 004              /* User page. */
+	PAL_USER = 004,             /* User page. */
+	PAL_NOTRACE = 010           /* Don't record with mtrace. */
 };
 
 /* Maximum number of pages to put in user pool. */
@@ -19,5 +21,32 @@ void *palloc_get_page (enum palloc_flags);
 void *palloc_get_multiple (enum palloc_flags, size_t page_cnt);
 void palloc_free_page (void *);
 void palloc_free_multiple (void *, size_t page_cnt);
+void palloc_free_pages (void **pages, size_t cnt);
+
+/* Page counts of a pool, as reported by palloc_get_stats(). */
+struct palloc_stats {
+	void *base;                 /* First page of the pool. */
+	size_t total;               /* Pages in the pool. */
+	size_t free;                /* Free pages. */
+	size_t wmark_min;           /* Watermarks, in free pages. */
+	size_t wmark_low;
+	size_t wmark_high;
+};
+
+/* A cache that can give pages back to a pool under pressure.
+   SHRINK should free up to TARGET pages and return the number it
+   actually freed. */
+struct shrinker {
+	const char *name;           /* For statistics. */
+	size_t (*shrink) (size_t target);
+	size_t freed_cnt;           /* Pages freed so far. */
+	struct list_elem elem;      /* Pool's shrinker list. */
+};
+
+void palloc_register_shrinker (enum palloc_flags, struct shrinker *);
+size_t palloc_shrink (enum palloc_flags, size_t target);
+void palloc_get_stats (enum palloc_flags, struct palloc_stats *);
+size_t palloc_free_cnt (enum palloc_flags);
+void palloc_print_stats (void);
 
 #endif /* threads/palloc.h */
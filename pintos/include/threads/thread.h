@@ -145,6 +145,23 @@ struct thread {
 	struct supplemental_page_table spt;
 	void *stack_bottom;
 	void *rsp_stack;
+	size_t stack_ahead;                 /* Pages the next stack-growth fault
+	                                       maps ahead of use. */
+	struct vm_usage vm_usage;           /* Memory usage, in pages. */
+	size_t wss_count;                   /* Working set counted so far in
+	                                       the current sample. */
+	bool wss_referenced;                /* Referenced a page in the current
+	                                       sample. */
+	unsigned wss_idle;                  /* Samples in a row without a
+	                                       referenced page. */
+	long long vm_events[VMSTAT_EVENT_CNT];  /* VM event counts, see
+	                                       lib/vmstat.h. */
+	struct swap_reservation swap_rsv;   /* Reserved swap cluster. */
+	struct uffd *uffd;                  /* User-level fault context this
+	                                       process owns or handles. */
+	struct list_elem reap_elem;         /* Element in the reaper's queue. */
+	struct semaphore reap_sema;         /* Upped when the reaper is done
+	                                       with this thread's memory. */
 #endif
 
 	/* Owned by thread.c. */
@@ -194,6 +211,10 @@ void remove_lock(struct lock *lock);
 void thread_check_preemption();
 struct thread * get_thread_tid(tid_t tid);
 
+/* Performs some operation on thread t, given auxiliary data AUX. */
+typedef void thread_action_func (struct thread *t, void *aux);
+void thread_foreach (thread_action_func *, void *);
+
 
 // 매크로 함수 정의
 /*
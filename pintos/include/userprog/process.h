@@ -20,5 +20,6 @@ struct container{
     struct file *file;
     off_t offset;
     size_t page_read_bytes;
+    bool text;                  /* 실행 파일의 읽기 전용 세그먼트: 프로세스끼리 공유 */
 };
 #endif /* userprog/process.h */
@@ -2,6 +2,7 @@
 #define VM_ANON_H
 #include "vm/vm.h"
 struct page;
+struct frame;
 enum vm_type;
 
 struct anon_page {
@@ -11,5 +12,9 @@ struct anon_page {
 
 void vm_anon_init (void);
 bool anon_initializer (struct page *page, enum vm_type type, void *kva);
+void anon_swap_fork (struct page *page);
+void anon_swap_commit (struct frame *frame, size_t slot);
+void anon_discard (struct page *page);
+bool anon_discardable (struct frame *frame);
 
 #endif
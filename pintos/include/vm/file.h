@@ -4,15 +4,38 @@
 #include "vm/vm.h"
 
 struct page;
+struct container;
+struct vm_area;
 enum vm_type;
 
 struct file_page {
 	void *aux;
 };
 
+/* fault-around: 한 번의 fault에서 함께 읽어 매핑하는 최대 페이지 수 */
+#define FAULT_AROUND_MAX 32
+extern int fault_around_pages;  /* 매핑마다 창의 처음 크기이자 상한. -fault-around=N, 1이면 끔 */
+extern long long writeback_pages;   /* msync나 munmap이 파일에 쓴 dirty 페이지 수 */
+extern long long writeback_writes;  /* 그 페이지들을 쓴 file_write_at() 횟수 */
+extern long long zero_copy_disk;    /* read()가 디스크에서 사용자 프레임으로 바로 읽은 페이지 수 */
+extern long long zero_copy_cached;  /* read()가 text 캐시에서 가져온 페이지 수 */
+extern long long zero_copy_writes;  /* write()가 사용자 프레임에서 바로 쓴 페이지 수 */
+
 void vm_file_init (void);
 bool file_backed_initializer (struct page *page, enum vm_type type, void *kva);
+bool file_backed_fork (struct page *page);
+size_t file_backed_around (struct page *page, struct page **pages, size_t max);
+size_t file_backed_run (struct page *page, struct page **pages, size_t max);
+bool file_backed_read_around (struct page **pages, size_t cnt);
+void file_backed_loaded (struct page *page, void *kva);
+struct container *file_backed_text (struct page *page);
+bool file_backed_fault_in (struct vm_area *area, void *va);
 void *do_mmap(void *addr, size_t length, int writable,
 		struct file *file, off_t offset);
 void do_munmap (void *va);
+bool do_msync (void *addr, size_t length, int flags);
+void file_backed_discard (struct page *page);
+bool file_pages_aligned (struct file *file, const void *buffer, size_t length);
+off_t file_read_direct (struct file *file, void *buffer, size_t length);
+off_t file_write_direct (struct file *file, const void *buffer, size_t length);
 #endif
@@ -0,0 +1,28 @@
+#ifndef VM_KSM_H
+#define VM_KSM_H
+#include <stddef.h>
+#include <stdint.h>
+
+struct frame;
+
+/* Same-page merging.  A background thread (ksmd) checksums resident
+ * anonymous frames; a frame whose checksum is unchanged since the
+ * previous pass is looked up in a table of frames keyed by checksum.
+ * Frames with equal contents are merged into one read-only frame
+ * that all of their pages map, and a write to any of them takes a
+ * private copy through the usual copy-on-write fault. */
+
+/* Frames scanned per pass, set by -ksm=N.  0 disables ksmd. */
+#define KSM_DEFAULT_SCAN 64
+extern size_t ksm_pages_to_scan;
+
+/* Milliseconds between passes, set by -ksm-sleep=MS. */
+#define KSM_DEFAULT_SLEEP 100
+extern unsigned ksm_sleep_ms;
+
+void ksm_init (void);
+struct frame *ksm_lookup (uint64_t sum);
+void ksm_insert (struct frame *frame);
+void ksm_remove (struct frame *frame);
+size_t ksm_listed_cnt (void);
+#endif
@@ -0,0 +1,22 @@
+#ifndef VM_LZ_H
+#define VM_LZ_H
+#include <stdbool.h>
+#include <stddef.h>
+
+/* A small LZ77 compressor in the style of LZ4, used for compressed
+ * swap.  The output is a series of sequences, each a token byte
+ * (literal length in the high nibble, match length - LZ_MIN_MATCH in
+ * the low nibble, 15 meaning more length bytes follow), the
+ * literals, and a two-byte little-endian back offset.  The last
+ * sequence has literals only. */
+
+#define LZ_MIN_MATCH 4
+
+/* Bytes of scratch memory lz_compress() needs. */
+#define LZ_WORK_SIZE 4096
+
+size_t lz_compress (const void *src, size_t src_len, void *dst,
+		size_t dst_cap, void *work);
+bool lz_decompress (const void *src, size_t src_len, void *dst,
+		size_t dst_len);
+#endif
@@ -0,0 +1,33 @@
+#ifndef VM_RADIX_H
+#define VM_RADIX_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* A map from user page addresses to pointers, laid out like the
+ * x86-64 page table: four levels of 512-entry nodes, each node one
+ * page, indexed by the same address bits as pml4e_walk().  Lookups
+ * take four dependent loads at most, or one when they hit the same
+ * 2 MiB leaf as the previous lookup.  Walks visit entries in address
+ * order and skip absent subtrees. */
+
+struct radix_node;
+
+struct radix {
+	struct radix_node *root;
+	size_t cnt;                 /* Number of entries. */
+	struct radix_node *leaf;    /* Leaf of the last lookup, or NULL. */
+	uint64_t leaf_tag;          /* Its address >> PDXSHIFT. */
+};
+
+/* Called on each entry VALUE by radix_walk() and radix_destroy(). */
+typedef void radix_func (void *value, void *aux);
+
+void radix_init (struct radix *);
+void *radix_find (struct radix *, const void *va);
+bool radix_insert (struct radix *, const void *va, void *value);
+void *radix_remove (struct radix *, const void *va);
+void radix_walk (struct radix *, const void *start, const void *end,
+		radix_func *, void *aux);
+void radix_destroy (struct radix *, radix_func *, void *aux);
+#endif
@@ -0,0 +1,21 @@
+#ifndef VM_REAP_H
+#define VM_REAP_H
+#include <stdbool.h>
+
+struct thread;
+
+/* Deferred address space teardown.  An exiting process writes back
+ * its shared file mappings and then hands the rest of its address
+ * space to a kernel thread (the reaper), so that its parent's wait()
+ * returns as soon as the exit status is known.  The reaper frees the
+ * process's pages in batches and then its page tables; the exiting
+ * thread stays around until the reaper is done with it. */
+
+/* Tear down exiting processes in the reaper.  Set false by
+ * -no-reaper, which frees them synchronously in process_exit(). */
+extern bool reap_enabled;
+
+void reap_init (void);
+bool reap_submit (struct thread *t);
+void reap_drain (void);
+#endif
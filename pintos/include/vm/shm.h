@@ -0,0 +1,52 @@
+#ifndef VM_SHM_H
+#define VM_SHM_H
+#include <stdbool.h>
+#include <stddef.h>
+#include "threads/synch.h"
+
+struct frame;
+struct page;
+struct vm_area;
+enum vm_type;
+
+/* Shared anonymous memory.  mmap() with MAP_ANONYMOUS creates an
+ * object that keeps, for each of its pages, either the frame holding
+ * the page or the swap slot it was written to.  Every process that
+ * maps the object, the creator and the children it forks, maps that
+ * same frame writable, so writes are seen by all of them.  When the
+ * frame is evicted its contents go to swap and the object remembers
+ * the slot; the next process to touch the page reads it back and
+ * the others find the new frame in the object. */
+
+/* One page of an object. */
+struct shm_slot {
+	struct frame *frame;        /* Frame holding the page, or NULL. */
+	size_t swap_index;          /* Swap slot, or SWAP_ERROR. */
+	bool held;                  /* FRAME is mapped nowhere and kept pinned
+	                               by the object because no swap slot
+	                               was free. */
+};
+
+/* A shared anonymous memory object. */
+struct shm {
+	size_t page_cnt;
+	struct shm_slot *slots;
+	int ref_cnt;                /* Regions mapping the object. */
+	struct lock lock;           /* Serializes loading its pages. */
+};
+
+/* Per-page data of a page that maps an object. */
+struct shm_page {
+	struct shm *obj;
+	size_t idx;                 /* Page index within OBJ. */
+};
+
+struct shm *shm_create (size_t page_cnt);
+void shm_get (struct shm *);
+void shm_put (struct shm *);
+bool shm_initializer (struct page *page, enum vm_type type, void *kva);
+bool shm_fault_in (struct vm_area *area, void *va);
+void shm_frame_unmapped (struct page *page);
+void shm_swap_commit (struct frame *frame, size_t idx);
+void *shm_mmap (void *addr, size_t length, bool writable);
+#endif
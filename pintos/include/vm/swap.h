@@ -0,0 +1,38 @@
+#ifndef VM_SWAP_H
+#define VM_SWAP_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct page;
+struct thread;
+
+/* Swap slots are grouped into clusters of this many slots. */
+#define SWAP_CLUSTER 16
+
+/* Returned by swap_alloc() when the swap disk is full. */
+#define SWAP_ERROR SIZE_MAX
+
+/* A process's reserved swap cluster.  Anonymous pages from one
+ * SWAP_CLUSTER-page aligned window of the address space are placed
+ * in the matching slots of this cluster, so that neighbouring virtual
+ * pages end up in neighbouring slots. */
+struct swap_reservation {
+	bool active;            /* Holds a cluster? */
+	uint64_t window;        /* Virtual window, in SWAP_CLUSTER pages */
+	size_t cluster;         /* Reserved cluster */
+};
+
+void swap_init (void);
+size_t swap_alloc (struct page *page);
+void swap_dup (size_t slot);
+void swap_free (size_t slot);
+void swap_free_multiple (const size_t *slots, size_t cnt);
+bool swap_in_use (size_t slot);
+void swap_read (size_t slot, void *kva);
+void swap_write (size_t slot, const void *kva);
+void swap_disk_read (size_t slot, void *kva);
+void swap_disk_write (size_t slot, const void *kva);
+void swap_release (struct thread *t);
+void swap_stats (size_t *total, size_t *used);
+#endif
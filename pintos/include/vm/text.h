@@ -0,0 +1,23 @@
+#ifndef VM_TEXT_H
+#define VM_TEXT_H
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/off_t.h"
+
+struct frame;
+struct inode;
+
+/* Cache of frames holding read-only executable pages, keyed by
+ * (inode, file offset, bytes read from the file).  Processes running
+ * the same program map the same frames instead of reading their own
+ * copies.  A frame stays in the cache while it is mapped by at least
+ * one page. */
+
+void text_init (void);
+struct frame *text_lookup (struct inode *inode, off_t ofs, size_t read_bytes);
+void text_insert (struct frame *frame, struct inode *inode, off_t ofs,
+		size_t read_bytes);
+void text_remove (struct frame *frame);
+void text_invalidate (struct inode *inode, off_t ofs, off_t size);
+size_t text_cached (void);
+#endif
@@ -0,0 +1,54 @@
+#ifndef VM_UFFD_H
+#define VM_UFFD_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <list.h>
+#include "threads/synch.h"
+
+struct thread;
+
+/* User-level fault handling.  uffd_register_range() marks a range of
+ * the caller's address space as managed by user code: the kernel never
+ * makes its pages.  A fault on a missing page of the range is queued on
+ * the process's context and the faulting process sleeps until the page
+ * is supplied.  Pintos processes have one thread each, so the handler
+ * is a process forked after registration, which inherits the context.
+ * It takes faults off the queue with uffd_next_fault() and answers with
+ * uffd_fill(), which fills frames in the handler and hands them over.
+ * The faulting process maps each frame whole, so a page never appears
+ * partly filled.  Pages may also be supplied before they are touched,
+ * but only inside a registered range, once each, and no more than
+ * mlock_limit copied pages at a time, since their frames stay pinned
+ * until the owner maps them.
+ * A process must not sleep on such a fault while holding filesys_lock,
+ * which a handler loading pages from a file needs, so read() and
+ * write() call uffd_prefault() on their buffers before taking it.
+ * Children do not inherit registrations: their copies of a registered
+ * range are ordinary zero-filled anonymous memory. */
+
+/* A fault context, shared by the process that registered ranges and
+ * the handlers it forked. */
+struct uffd {
+	struct lock lock;
+	struct condition fault_cond;   /* Signaled when a fault is queued or
+	                                  the owner exits. */
+	struct condition ready_cond;   /* Signaled when a page is supplied or
+	                                  a handler exits. */
+	struct list faults;            /* Faults not yet read, oldest first. */
+	struct list ready;             /* Pages supplied but not yet mapped. */
+	struct list ranges;            /* Registered ranges. */
+	size_t pinned;                 /* Frames pinned by pages in READY. */
+	struct thread *owner;          /* Registering process, NULL once it
+	                                  has exited. */
+	int ref_cnt;                   /* Owner and handlers. */
+};
+
+bool uffd_register_range (void *addr, size_t length);
+bool uffd_next_fault (void **addr, bool *write);
+bool uffd_fill (void *dst, const void *src, size_t length);
+bool uffd_handle_fault (void *addr, bool write);
+bool uffd_prefault (const void *buffer, size_t size, bool write);
+void uffd_fork (struct thread *child, struct thread *parent);
+void uffd_exit (struct thread *t);
+void uffd_get_stats (long long *copied, long long *zeroed);
+#endif
@@ -1,6 +1,7 @@
 #ifndef VM_VM_H
 #define VM_VM_H
 #include <stdbool.h>
+#include <vmstat.h>
 #include "threads/palloc.h"
 
 enum vm_type {
@@ -12,6 +13,8 @@ enum vm_type {
 	VM_FILE = 2,
 	/* page that hold the page cache, for project 4 */
 	VM_PAGE_CACHE = 3,
+	/* anonymous page shared between processes, see vm/shm.h */
+	VM_SHM = 4,
 
 	/* Bit flags to store state */
 
@@ -27,6 +30,15 @@ enum vm_type {
 #include "vm/uninit.h"
 #include "vm/anon.h"
 #include "vm/file.h"
+#include "vm/swap.h"
+#include "vm/zswap.h"
+#include "vm/text.h"
+#include "vm/ksm.h"
+#include "vm/shm.h"
+#include "vm/reap.h"
+#include "vm/uffd.h"
+#include "vm/vma.h"
+#include "vm/radix.h"
 #include "hash.h" 
 #ifdef EFILESYS
 #include "filesys/page_cache.h"
@@ -49,6 +61,13 @@ struct page {
 	/* Your implementation */
 	struct hash_elem hash_elem;
 	bool writable;
+	struct thread *owner;  /* Process whose address space maps this page */
+	struct list_elem share_elem;  /* Element in frame's PAGES list */
+	uint8_t advice;        /* MADV_NORMAL, MADV_RANDOM or MADV_SEQUENTIAL */
+	bool mlocked;          /* Locked by mlock(): its frame is not evicted */
+	bool lazyfree;         /* MADV_FREE: drop instead of swapping out
+	                          unless written since */
+	uint8_t idle;          /* Working-set samples since last referenced */
 
 	/* Per-type data are binded into the union.
 	 * Each function automatically detects the current union */
@@ -56,6 +75,7 @@ struct page {
 		struct uninit_page uninit;
 		struct anon_page anon;
 		struct file_page file;
+		struct shm_page shm;
 #ifdef EFILESYS
 		struct page_cache page_cache;
 #endif
@@ -67,7 +87,24 @@ struct frame {
 	void *kva;
 	struct page *page;
 	/* Project 3 */
-	struct list_elem frame_elem; 
+	struct list pages;     /* Reverse map: pages (owner's pml4, va) mapping
+	                          this frame, several after fork */
+	int ref_cnt;           /* Number of pages in PAGES */
+	int pin_cnt;           /* Not to be evicted while nonzero, e.g. while
+	                          being filled or copied */
+	int lock_cnt;          /* Pages in PAGES locked by mlock() */
+	bool reclaim;          /* Unmapped and being written out by kswapd */
+	bool young;            /* Referenced before the working-set sampler
+	                          cleared its accessed bits; the clock treats
+	                          it as accessed */
+	struct hash_elem cache_elem;  /* Element in the text cache */
+	struct inode *cache_inode;    /* Text cache key, NULL if not cached */
+	off_t cache_ofs;
+	size_t cache_bytes;    /* Bytes read from the file, rest zeroed */
+	struct hash_elem ksm_elem;    /* Element in the same-page merging table */
+	uint64_t ksm_sum;      /* Checksum seen by the last ksmd pass */
+	bool ksm_listed;       /* In the merging table under KSM_SUM? */
+	bool ksm_merged;       /* Other frames have been merged into this one */
 };
 
 /* The function table for page operations.
@@ -90,7 +127,21 @@ struct page_operations {
  * We don't want to force you to obey any specific design for this struct.
  * All designs up to you for this. */
 struct supplemental_page_table {
+	bool radix;            /* Pages are kept in TREE instead of PAGES */
 	struct hash pages;
+	struct radix tree;
+	struct vm_areas vmas;  /* Regions whose pages are made on first use */
+};
+
+/* Per-process memory usage, in pages. */
+struct vm_usage {
+	size_t rss;            /* Pages resident in frames */
+	size_t rss_peak;       /* Largest RSS so far */
+	size_t swap;           /* Pages in the swap disk */
+	size_t locked;         /* Pages locked by mlock() */
+	size_t wss;            /* Pages referenced in the last wss_window
+	                          samples, as of the last sample */
+	size_t wss_peak;       /* Largest WSS so far */
 };
 
 #include "threads/thread.h"
@@ -98,10 +149,53 @@ void supplemental_page_table_init (struct supplemental_page_table *spt);
 bool supplemental_page_table_copy (struct supplemental_page_table *dst,
 		struct supplemental_page_table *src);
 void supplemental_page_table_kill (struct supplemental_page_table *spt);
+void spt_unmap_shared (struct supplemental_page_table *spt);
+void spt_teardown (struct thread *t);
 struct page *spt_find_page (struct supplemental_page_table *spt,
 		void *va);
 bool spt_insert_page (struct supplemental_page_table *spt, struct page *page);
 void spt_remove_page (struct supplemental_page_table *spt, struct page *page);
+void spt_delete_page (struct supplemental_page_table *spt, struct page *page);
+size_t spt_size (struct supplemental_page_table *spt);
+bool spt_range_empty (struct supplemental_page_table *spt, void *start,
+		void *end);
+void spt_for_each_in_range (struct supplemental_page_table *spt, void *start,
+		void *end, void (*fn) (struct page *, void *), void *aux);
+
+/* Run the background reclaimer.  Set false by -no-kswapd. */
+extern bool kswapd_enabled;
+
+/* Keep new page tables in a radix tree.  Set by -spt=radix. */
+extern bool spt_radix;
+
+/* Most pages one process's stack may grow to, not counting the guard
+ * page below it.  Set by -stack-limit=N. */
+#define STACK_DEFAULT_LIMIT 256
+extern size_t stack_limit;
+
+/* Most pages a stack-growth fault maps below the faulting address in
+ * anticipation of further growth. */
+#define STACK_AHEAD_MAX 16
+
+/* Milliseconds between working-set samples, set by -wss-interval=MS.
+ * 0 disables the sampler and trimming. */
+#define WSS_DEFAULT_INTERVAL 100
+extern unsigned wss_interval_ms;
+
+/* Samples a page may go unreferenced and still count in its process's
+ * working set, set by -wss-window=N.  Older pages are cold. */
+#define WSS_DEFAULT_WINDOW 4
+extern unsigned wss_window;
+
+/* Reclaim cold pages of processes idle for WSS_IDLE_SAMPLES samples
+ * while less than a quarter of the user pool is free.  Cleared by
+ * -no-trim. */
+#define WSS_IDLE_SAMPLES 8
+extern bool wss_trim_enabled;
+
+/* Most pages one process may lock with mlock().  Set by -mlock-limit=N. */
+#define MLOCK_DEFAULT_LIMIT 64
+extern size_t mlock_limit;
 
 void vm_init (void);
 bool vm_try_handle_fault (struct intr_frame *f, void *addr, bool user,
@@ -113,6 +207,25 @@ bool vm_alloc_page_with_initializer (enum vm_type type, void *upage,
 		bool writable, vm_initializer *init, void *aux);
 void vm_dealloc_page (struct page *page);
 bool vm_claim_page (void *va);
+bool vm_stack_init (void);
+void vm_free_frame (struct page *page);
+struct frame *vm_pin_dirty_frame (struct page *page);
+struct frame *vm_pin_frame (struct page *page);
+struct frame *vm_pin_fill_frame (struct page *page);
+bool vm_read_cached (struct inode *inode, off_t ofs, void *kva);
+void vm_unpin_frame (struct frame *frame);
+struct frame *vm_fill_frame (const void *src);
+bool vm_install_frame (void *va, struct frame *frame, bool writable);
 enum vm_type page_get_type (struct page *page);
 
+void vm_usage_add (size_t *counter, int delta);
+void vm_event (enum vmstat_event ev, long long n);
+long long vm_event_cnt (enum vmstat_event ev, bool all);
+void vm_get_stats (struct vmstat *st, bool all);
+void vm_populate (void *start, void *end, bool force);
+bool vm_madvise (void *addr, size_t length, int advice);
+bool vm_mlock (const void *addr, size_t length);
+bool vm_munlock (const void *addr, size_t length);
+void vm_print_stats (void);
+
 #endif  /* VM_VM_H */
@@ -0,0 +1,54 @@
+#ifndef VM_VMA_H
+#define VM_VMA_H
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/off_t.h"
+
+struct file;
+struct shm;
+struct page;
+struct supplemental_page_table;
+
+/* A region of a process's address space that is backed the same way
+ * throughout, such as one mmap() or one PT_LOAD segment.  Pages of a
+ * region get their struct page only when first looked up. */
+struct vm_area {
+	void *start;                /* First page. */
+	void *end;                  /* One past the last page. */
+	int type;                   /* enum vm_type: VM_FILE, VM_SHM, or
+	                               VM_ANON for the stack and
+	                               user-handled ranges. */
+	bool writable;
+	bool shared;                /* Writes go back to FILE (mmap), or
+	                               are seen by other processes (SHM). */
+	bool text;                  /* Read-only executable segment. */
+	bool stack;                 /* The stack, lowest page a guard.  Its
+	                               pages are made by stack growth near
+	                               rsp, not on lookup. */
+	bool uffd;                  /* Pages are supplied by a user-level
+	                               handler, see vm/uffd.h. */
+	struct file *file;          /* Backing file, owned by the region. */
+	struct shm *shm;            /* VM_SHM: object, one reference held. */
+	off_t offset;               /* File offset of START. */
+	size_t file_bytes;          /* Bytes read from FILE, rest is zero. */
+	int advice;                 /* madvise() hint for new pages. */
+};
+
+/* Regions of an address space, sorted by address. */
+struct vm_areas {
+	struct vm_area *areas;
+	size_t cnt;
+	size_t cap;
+};
+
+void vma_init (struct vm_areas *);
+bool vma_insert (struct vm_areas *, const struct vm_area *);
+struct vm_area *vma_find (struct vm_areas *, const void *va);
+bool vma_overlaps (struct vm_areas *, const void *start, const void *end);
+void vma_advise (struct vm_areas *, const void *start, const void *end,
+		int advice);
+void vma_remove (struct vm_areas *, struct vm_area *);
+bool vma_copy (struct vm_areas *dst, struct vm_areas *src);
+void vma_destroy (struct vm_areas *);
+bool vma_fault_in (struct supplemental_page_table *, void *va);
+#endif
@@ -0,0 +1,34 @@
+#ifndef VM_ZSWAP_H
+#define VM_ZSWAP_H
+#include <stdbool.h>
+#include <stddef.h>
+
+/* A compressed cache of swap slots kept in kernel memory, in front of
+ * the swap disk.  swap_write() offers each page to it first; pages
+ * that compress well stay in memory and never reach the disk unless
+ * the pool fills and they are written back in LRU order.  Pages of
+ * zeros take no pool memory at all.  Entries are keyed by swap slot,
+ * so slot allocation, sharing and readahead work as before. */
+
+/* Pool limit in pages, set by -zswap=N.  0 disables the cache. */
+#define ZSWAP_DEFAULT_PAGES 256
+extern size_t zswap_max_pages;
+
+struct zswap_stats {
+	size_t stored;              /* Slots held in the pool. */
+	size_t zero;                /* Slots known to be all zeros. */
+	size_t pool_pages;          /* Pages used by the pool. */
+	long long stores;           /* Pages kept off the disk when written. */
+	long long loads;            /* Pages read back without the disk. */
+	long long writebacks;       /* Pages later written to the disk. */
+	long long rejects;          /* Pages that did not compress. */
+	long long orig_bytes;       /* Bytes of compressed pages stored, */
+	long long comp_bytes;       /* before and after compression. */
+};
+
+void zswap_init (size_t slot_cnt);
+bool zswap_store (size_t slot, const void *kva);
+bool zswap_load (size_t slot, void *kva);
+void zswap_invalidate (size_t slot);
+void zswap_get_stats (struct zswap_stats *);
+#endif
@@ -194,3 +194,53 @@ int
 umount (const char *path) {
 	return syscall1 (SYS_UMOUNT, path);
 }
+
+bool
+memstat (struct memstat *ms) {
+	return syscall1 (SYS_MEMSTAT, ms);
+}
+
+int
+madvise (void *addr, size_t length, int advice) {
+	return syscall3 (SYS_MADVISE, addr, length, advice);
+}
+
+int
+mlock (const void *addr, size_t length) {
+	return syscall2 (SYS_MLOCK, addr, length);
+}
+
+int
+munlock (const void *addr, size_t length) {
+	return syscall2 (SYS_MUNLOCK, addr, length);
+}
+
+int
+msync (void *addr, size_t length, int flags) {
+	return syscall3 (SYS_MSYNC, addr, length, flags);
+}
+
+bool
+vmstat (int who, struct vmstat *st) {
+	return syscall2 (SYS_VMSTAT, who, st);
+}
+
+int
+uffd_register (void *addr, size_t length) {
+	return syscall2 (SYS_UFFD_REGISTER, addr, length);
+}
+
+bool
+uffd_read (struct uffd_msg *msg) {
+	return syscall1 (SYS_UFFD_READ, msg);
+}
+
+int
+uffd_copy (void *dst, const void *src, size_t length) {
+	return syscall3 (SYS_UFFD_COPY, dst, src, length);
+}
+
+int
+uffd_zero (void *dst, size_t length) {
+	return syscall2 (SYS_UFFD_ZERO, dst, length);
+}
@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+# Like check_expected, but every number after the "(test) " prefix is
+# replaced by N first, since measurements differ from run to run.
+sub check_bench {
+    my ($expected) = @_;
+    our ($test);
+    my (@output) = read_text_file ("$test.output");
+
+    common_checks ("run", @output);
+    foreach (@output) {
+	1 while s/^(\([^)]*\) \D*)\d+/$1N/;
+    }
+    compare_output ("run", IGNORE_EXIT_CODES => 1, \@output, $expected);
+    pass;
+}
+
+1;
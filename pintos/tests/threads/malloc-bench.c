@@ -0,0 +1,69 @@
+/* Measures malloc() and free() with 1, 2, 4, and 8 threads
+   allocating and freeing concurrently.  Each thread keeps a
+   small window of live blocks of mixed sizes and replaces one of
+   them on every step, the way kernel loops such as do_mmap()
+   allocate.  Prints the average cost of a malloc/free pair. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define MAX_THREADS 8
+#define STEP_CNT 20000
+#define WINDOW 16
+
+static const size_t sizes[] = {16, 24, 64, 100, 256, 512, 1000};
+#define SIZE_CNT (sizeof sizes / sizeof *sizes)
+
+static struct semaphore done;
+
+static void
+bench_thread (void *aux UNUSED) 
+{
+  void *live[WINDOW] = {NULL};
+  int i;
+
+  for (i = 0; i < STEP_CNT; i++) 
+    {
+      int slot = i % WINDOW;
+
+      free (live[slot]);
+      live[slot] = malloc (sizes[i % SIZE_CNT]);
+      if (live[slot] == NULL)
+        fail ("malloc failed");
+    }
+  for (i = 0; i < WINDOW; i++)
+    free (live[i]);
+
+  sema_up (&done);
+}
+
+void
+test_malloc_bench (void) 
+{
+  int thread_cnt;
+
+  sema_init (&done, 0);
+  for (thread_cnt = 1; thread_cnt <= MAX_THREADS; thread_cnt *= 2) 
+    {
+      uint64_t start, cycles;
+      int i;
+
+      start = rdtsc ();
+      for (i = 0; i < thread_cnt; i++) 
+        {
+          char name[16];
+          snprintf (name, sizeof name, "malloc %d", i);
+          thread_create (name, PRI_DEFAULT, bench_thread, NULL);
+        }
+      for (i = 0; i < thread_cnt; i++)
+        sema_down (&done);
+      cycles = rdtsc () - start;
+
+      msg ("%d threads: %llu cycles per malloc/free pair", thread_cnt,
+           (unsigned long long) (cycles / (thread_cnt * STEP_CNT)));
+    }
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(malloc-bench) begin
+(malloc-bench) N threads: N cycles per malloc/free pair
+(malloc-bench) N threads: N cycles per malloc/free pair
+(malloc-bench) N threads: N cycles per malloc/free pair
+(malloc-bench) N threads: N cycles per malloc/free pair
+(malloc-bench) end
+EOF
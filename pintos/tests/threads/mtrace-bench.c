@@ -0,0 +1,71 @@
+/* Measures the overhead of allocation tracing (-mtrace) by timing
+   malloc()/free() and palloc_get_page()/palloc_free_page() pairs
+   with tracing off and then on.  Some blocks are kept live during
+   the run so that the trace table is not empty. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/malloc.h"
+#include "threads/mtrace.h"
+#include "threads/palloc.h"
+#include "intrinsic.h"
+
+#define PAIR_CNT 10000
+#define LIVE_CNT 256
+
+static uint64_t
+time_malloc (void) 
+{
+  uint64_t start = rdtsc ();
+  int i;
+
+  for (i = 0; i < PAIR_CNT; i++)
+    free (malloc (64));
+  return (rdtsc () - start) / PAIR_CNT;
+}
+
+static uint64_t
+time_palloc (void) 
+{
+  uint64_t start = rdtsc ();
+  int i;
+
+  for (i = 0; i < PAIR_CNT; i++)
+    palloc_free_page (palloc_get_page (0));
+  return (rdtsc () - start) / PAIR_CNT;
+}
+
+void
+test_mtrace_bench (void) 
+{
+  static void *live[LIVE_CNT];
+  bool was_enabled = mtrace_enabled;
+  uint64_t malloc_off, malloc_on, palloc_off, palloc_on;
+  int i;
+
+  /* Make sure the trace table exists. */
+  mtrace_enabled = true;
+  mtrace_init ();
+  if (!mtrace_enabled)
+    fail ("no memory for the trace table");
+
+  for (i = 0; i < LIVE_CNT; i++)
+    live[i] = malloc (32);
+
+  mtrace_enabled = false;
+  malloc_off = time_malloc ();
+  palloc_off = time_palloc ();
+
+  mtrace_enabled = true;
+  malloc_on = time_malloc ();
+  palloc_on = time_palloc ();
+
+  for (i = 0; i < LIVE_CNT; i++)
+    free (live[i]);
+  mtrace_enabled = was_enabled;
+
+  msg ("malloc/free: %llu cycles untraced, %llu cycles traced",
+       (unsigned long long) malloc_off, (unsigned long long) malloc_on);
+  msg ("palloc/free: %llu cycles untraced, %llu cycles traced",
+       (unsigned long long) palloc_off, (unsigned long long) palloc_on);
+}
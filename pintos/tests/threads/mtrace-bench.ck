@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(mtrace-bench) begin
+(mtrace-bench) malloc/free: N cycles untraced, N cycles traced
+(mtrace-bench) palloc/free: N cycles untraced, N cycles traced
+(mtrace-bench) end
+EOF
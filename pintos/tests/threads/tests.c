@@ -38,6 +38,11 @@ static const struct test tests[] =
     {"mlfqs-nice-2", test_mlfqs_nice_2},
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
+    {"malloc-bench", test_malloc_bench},
+    {"mtrace-bench", test_mtrace_bench},
+#ifdef VM
+    {"zswap-roundtrip", test_zswap_roundtrip},
+#endif
   };
 
 static const char *test_name;
@@ -0,0 +1,110 @@
+/* Round-trips pages through the compressor behind zswap and through
+   zswap itself: pages that compress come back unchanged, a page of
+   random bytes is turned away, and the kernel-pool shrinker writes
+   stored pages to their swap slots on disk and frees the pool.
+   Needs the VM kernel with a swap disk and zswap enabled. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+#ifdef VM
+#include "vm/lz.h"
+#include "vm/swap.h"
+#include "vm/zswap.h"
+
+enum kind { TEXT, RUNS, RANDOM, KIND_CNT };
+
+/* Fills PAGE with contents of the given KIND. */
+static void
+fill (uint8_t *page, enum kind kind) 
+{
+  static const char text[] = "the quick brown fox jumps over the lazy dog. ";
+  uint32_t seed = 12345;
+  size_t i;
+
+  for (i = 0; i < PGSIZE; i++)
+    switch (kind) 
+      {
+      case TEXT:
+        page[i] = text[i % (sizeof text - 1)];
+        break;
+      case RUNS:
+        page[i] = i / 37 % 5;
+        break;
+      default:
+        seed = seed * 1103515245 + 12345;
+        page[i] = seed >> 16;
+        break;
+      }
+}
+
+void
+test_zswap_roundtrip (void) 
+{
+  uint8_t *src = palloc_get_page (PAL_ASSERT);
+  uint8_t *out = palloc_get_page (PAL_ASSERT);
+  uint8_t *comp = palloc_get_multiple (PAL_ASSERT, 2);
+  void *work = palloc_get_page (PAL_ASSERT);
+  struct zswap_stats st;
+  size_t len;
+  int kind;
+
+  for (kind = TEXT; kind < RANDOM; kind++) 
+    {
+      fill (src, kind);
+      len = lz_compress (src, PGSIZE, comp, PGSIZE / 2, work);
+      if (len == 0)
+        fail ("page of kind %d did not compress", kind);
+      if (!lz_decompress (comp, len, out, PGSIZE) || memcmp (src, out, PGSIZE))
+        fail ("page of kind %d did not round-trip", kind);
+    }
+  msg ("lz round-trips compressible pages");
+
+  fill (src, RANDOM);
+  if (lz_compress (src, PGSIZE, comp, PGSIZE / 2, work) != 0)
+    fail ("random page compressed to half a page");
+  len = lz_compress (src, PGSIZE, comp, 2 * PGSIZE, work);
+  if (len == 0 || !lz_decompress (comp, len, out, PGSIZE)
+      || memcmp (src, out, PGSIZE))
+    fail ("random page did not round-trip");
+  msg ("lz round-trips incompressible pages");
+
+  fill (src, TEXT);
+  if (!zswap_store (0, src))
+    fail ("text page not stored");
+  memset (out, 0, PGSIZE);
+  if (!zswap_store (1, out))
+    fail ("zero page not stored");
+  fill (out, RANDOM);
+  if (zswap_store (2, out))
+    fail ("random page stored");
+  memset (out, 0xcc, PGSIZE);
+  if (!zswap_load (0, out) || memcmp (src, out, PGSIZE))
+    fail ("text page did not load back");
+  if (!zswap_load (1, out) || out[0] != 0 || memcmp (out, out + 1, PGSIZE - 1))
+    fail ("zero page did not load back");
+  if (zswap_load (2, out))
+    fail ("rejected page loaded");
+  msg ("zswap loads what it stored");
+
+  palloc_shrink (0, SIZE_MAX);
+  zswap_get_stats (&st);
+  if (st.pool_pages != 0 || zswap_load (0, out))
+    fail ("shrinker left %zu pool pages", st.pool_pages);
+  memset (out, 0xcc, PGSIZE);
+  swap_disk_read (0, out);
+  if (memcmp (src, out, PGSIZE))
+    fail ("text page lost by the shrinker");
+  msg ("shrinker writes stored pages to disk");
+
+  zswap_invalidate (0);
+  zswap_invalidate (1);
+  palloc_free_page (work);
+  palloc_free_multiple (comp, 2);
+  palloc_free_page (out);
+  palloc_free_page (src);
+}
+#endif /* VM */
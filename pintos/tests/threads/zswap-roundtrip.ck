@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(zswap-roundtrip) begin
+(zswap-roundtrip) lz round-trips compressible pages
+(zswap-roundtrip) lz round-trips incompressible pages
+(zswap-roundtrip) zswap loads what it stored
+(zswap-roundtrip) shrinker writes stored pages to disk
+(zswap-roundtrip) end
+EOF
+pass;
@@ -0,0 +1,52 @@
+/* Checks that the memory of an exited child goes back to the user
+   pool without waiting for the parent: the child touches many pages
+   and exits, and the parent sees them freed before calling wait(). */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 64
+
+/* Pages the parent may itself take after fork, copying on write. */
+#define SLACK 8
+
+#define POLL_MAX 1000000
+
+static char buf[PAGE_COUNT * PAGE_SIZE];
+
+void
+test_main (void)
+{
+	struct memstat before, now;
+	pid_t child;
+	size_t i;
+
+	CHECK (memstat (&before), "memstat");
+
+	child = fork ("child");
+	if (child == 0) {
+		struct memstat ms;
+
+		for (i = 0; i < PAGE_COUNT; i++)
+			buf[i * PAGE_SIZE] = i;
+		if (!memstat (&ms) || ms.user_free + PAGE_COUNT > before.user_free)
+			exit (1);
+		exit (0);
+	}
+	CHECK (child > 0, "fork");
+
+	for (i = 0; i < POLL_MAX; i++) {
+		if (!memstat (&now))
+			fail ("memstat failed");
+		if (now.user_free + SLACK >= before.user_free)
+			break;
+	}
+	if (i == POLL_MAX)
+		fail ("user pool has %zu free pages, %zu before fork",
+				now.user_free, before.user_free);
+	msg ("child's memory came back before wait");
+
+	CHECK (wait (child) == 0, "wait");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(exit-reap) begin
+(exit-reap) memstat
+(exit-reap) fork
+(exit-reap) child's memory came back before wait
+(exit-reap) wait
+(exit-reap) end
+EOF
+pass;
@@ -0,0 +1,81 @@
+/* Checks that ksmd merges identical anonymous pages of two processes
+   and that a write unshares them again.  After fork both processes
+   write the same contents to their own copies of BUF, then wait until
+   the merges they were charged add up to every page of BUF.  The
+   parent then writes one page and the child checks that its copy
+   still holds the old contents.  The two processes talk through a
+   shared anonymous page, which ksmd leaves alone. */
+
+#include <syscall.h>
+#include <vmstat.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 4
+#define MAX_ROUNDS (1 << 22)
+
+/* Shared between parent and child. */
+struct shared {
+	volatile int state;                 /* 0, then READY, then WRITTEN. */
+	volatile long long child_merges;    /* Child's VMSTAT_KSM_MERGE. */
+};
+
+#define READY 1
+#define WRITTEN 2
+
+static char buf[PAGE_COUNT * PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+/* Fills BUF with contents that differ from page to page, so pages of
+   one process do not merge with each other. */
+static void
+fill (void)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof buf; i++)
+		buf[i] = i / PAGE_SIZE * 7 + i % 251 + 1;
+}
+
+void
+test_main (void)
+{
+	struct shared *sh = (struct shared *) 0x10000000;
+	long long cow;
+	size_t round, i;
+	pid_t child;
+
+	CHECK (mmap (sh, PAGE_SIZE, 1 | MAP_ANONYMOUS, -1, 0) == sh,
+			"mmap shared page");
+	child = fork ("child");
+	if (child == 0) {
+		fill ();
+		sh->state = READY;
+		while (sh->state != WRITTEN)
+			sh->child_merges = get_vm_event_cnt (VMSTAT_KSM_MERGE, false);
+		for (i = 0; i < sizeof buf; i++)
+			if (buf[i] != (char) (i / PAGE_SIZE * 7 + i % 251 + 1))
+				exit (1);
+		exit (0);
+	}
+	CHECK (child > 0, "fork");
+	fill ();
+	while (sh->state != READY)
+		continue;
+
+	for (round = 0; round < MAX_ROUNDS; round++)
+		if (get_vm_event_cnt (VMSTAT_KSM_MERGE, false) + sh->child_merges
+				>= PAGE_COUNT)
+			break;
+	if (round == MAX_ROUNDS)
+		fail ("only %lld pages merged",
+				get_vm_event_cnt (VMSTAT_KSM_MERGE, false) + sh->child_merges);
+	msg ("identical pages merged");
+
+	cow = get_vm_event_cnt (VMSTAT_FAULT_COW, false);
+	buf[0] = 'x';
+	CHECK (get_vm_event_cnt (VMSTAT_FAULT_COW, false) > cow,
+			"write to a merged page copies it");
+	sh->state = WRITTEN;
+	CHECK (wait (child) == 0, "other copy unchanged");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(ksm-merge) begin
+(ksm-merge) mmap shared page
+(ksm-merge) fork
+(ksm-merge) identical pages merged
+(ksm-merge) write to a merged page copies it
+(ksm-merge) other copy unchanged
+(ksm-merge) end
+EOF
+pass;
@@ -0,0 +1,57 @@
+/* Checks madvise().  MADV_DONTNEED drops anonymous pages, which then
+   read as zeros, and writes back a shared file mapping before dropping
+   it, so the data comes back from the file.  MADV_FREE keeps a page's
+   contents as long as it is not reclaimed, and writes after it stick. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 16
+
+static char buf[(PAGE_COUNT + 1) * PAGE_SIZE];
+
+void
+test_main (void)
+{
+	char *pages = (char *) (((uintptr_t) buf + PAGE_SIZE - 1) & ~(uintptr_t) (PAGE_SIZE - 1));
+	char *map = (char *) 0x10000000;
+	struct memstat before, after;
+	size_t i;
+	int fd;
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		pages[i * PAGE_SIZE] = 'a';
+	CHECK (memstat (&before), "memstat");
+	CHECK (madvise (pages, PAGE_COUNT * PAGE_SIZE, MADV_DONTNEED) == 0,
+			"madvise MADV_DONTNEED");
+	CHECK (memstat (&after), "memstat");
+	CHECK (after.rss + PAGE_COUNT <= before.rss, "dropped pages left the RSS");
+	for (i = 0; i < PAGE_COUNT; i++)
+		if (pages[i * PAGE_SIZE] != 0)
+			fail ("page %zu was not zeroed", i);
+	msg ("dropped pages read as zeros");
+
+	CHECK (create ("dontneed", PAGE_SIZE), "create \"dontneed\"");
+	CHECK ((fd = open ("dontneed")) > 1, "open \"dontneed\"");
+	CHECK (mmap (map, PAGE_SIZE, 1, fd, 0) == map, "mmap \"dontneed\"");
+	map[0] = 'x';
+	CHECK (madvise (map, PAGE_SIZE, MADV_DONTNEED) == 0,
+			"madvise MADV_DONTNEED on the mapping");
+	CHECK (map[0] == 'x', "shared mapping kept its data");
+	munmap (map);
+	close (fd);
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		pages[i * PAGE_SIZE] = 'b';
+	CHECK (madvise (pages, PAGE_COUNT * PAGE_SIZE, MADV_FREE) == 0,
+			"madvise MADV_FREE");
+	pages[0] = 'c';
+	CHECK (pages[0] == 'c' && pages[PAGE_SIZE] == 'b', "freed pages keep their data");
+
+	CHECK (madvise (pages + 1, PAGE_SIZE, MADV_DONTNEED) == -1,
+			"misaligned madvise fails");
+	CHECK (madvise (pages, PAGE_SIZE, 99) == -1, "unknown advice fails");
+}
@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(madvise-dontneed) begin
+(madvise-dontneed) memstat
+(madvise-dontneed) madvise MADV_DONTNEED
+(madvise-dontneed) memstat
+(madvise-dontneed) dropped pages left the RSS
+(madvise-dontneed) dropped pages read as zeros
+(madvise-dontneed) create "dontneed"
+(madvise-dontneed) open "dontneed"
+(madvise-dontneed) mmap "dontneed"
+(madvise-dontneed) madvise MADV_DONTNEED on the mapping
+(madvise-dontneed) shared mapping kept its data
+(madvise-dontneed) madvise MADV_FREE
+(madvise-dontneed) freed pages keep their data
+(madvise-dontneed) misaligned madvise fails
+(madvise-dontneed) unknown advice fails
+(madvise-dontneed) end
+EOF
+pass;
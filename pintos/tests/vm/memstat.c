@@ -0,0 +1,34 @@
+/* Checks that memstat() accounts for the pages a process touches. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 16
+
+static char buf[PAGE_COUNT * PAGE_SIZE];
+
+void
+test_main (void)
+{
+	struct memstat before, after;
+	size_t i;
+
+	CHECK (memstat (&before), "memstat");
+	CHECK (before.rss > 0, "some pages are resident");
+	CHECK (before.pgtable >= 4, "page tables are counted");
+	CHECK (before.user_free <= before.user_total, "user pool is consistent");
+	CHECK (before.wmark_min < before.wmark_low
+			&& before.wmark_low < before.wmark_high, "watermarks are ordered");
+	CHECK (before.kernel_free <= before.kernel_total,
+			"kernel pool is consistent");
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		buf[i * PAGE_SIZE] = i;
+
+	CHECK (memstat (&after), "memstat");
+	CHECK (after.rss >= before.rss + PAGE_COUNT, "touched pages are resident");
+	CHECK (after.rss_peak >= after.rss, "peak covers current");
+	CHECK (after.user_free < before.user_free, "user pool shrank");
+}
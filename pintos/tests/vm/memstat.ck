@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(memstat) begin
+(memstat) memstat
+(memstat) some pages are resident
+(memstat) page tables are counted
+(memstat) user pool is consistent
+(memstat) watermarks are ordered
+(memstat) kernel pool is consistent
+(memstat) memstat
+(memstat) touched pages are resident
+(memstat) peak covers current
+(memstat) user pool shrank
+(memstat) end
+EOF
+pass;
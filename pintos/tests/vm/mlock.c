@@ -0,0 +1,49 @@
+/* Checks mlock() and munlock().  Locked pages are counted against
+   the per-process limit, locking past the limit or over an unmapped
+   page fails, and locked pages cannot be dropped with
+   MADV_DONTNEED until they are unlocked.  Runs with the limit set to
+   PAGE_COUNT. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 8
+
+static char buf[(PAGE_COUNT + 2) * PAGE_SIZE];
+
+void
+test_main (void)
+{
+	char *pages = (char *) (((uintptr_t) buf + PAGE_SIZE - 1) & ~(uintptr_t) (PAGE_SIZE - 1));
+	struct memstat ms;
+	size_t i;
+
+	CHECK (mlock (pages, PAGE_COUNT * PAGE_SIZE) == 0, "mlock");
+	CHECK (memstat (&ms), "memstat");
+	CHECK (ms.locked == PAGE_COUNT, "locked pages are counted");
+	CHECK (ms.locked_limit == PAGE_COUNT, "limit is reported");
+	CHECK (mlock (pages, PAGE_COUNT * PAGE_SIZE) == 0, "mlock again");
+	CHECK (memstat (&ms) && ms.locked == PAGE_COUNT,
+			"locking twice counts once");
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		pages[i * PAGE_SIZE] = i;
+	CHECK (madvise (pages, PAGE_COUNT * PAGE_SIZE, MADV_DONTNEED) == -1,
+			"locked pages cannot be dropped");
+	for (i = 0; i < PAGE_COUNT; i++)
+		if (pages[i * PAGE_SIZE] != (char) i)
+			fail ("locked page %zu lost its data", i);
+
+	CHECK (mlock ((void *) 0x10000000, PAGE_SIZE) == -1,
+			"locking an unmapped page fails");
+	CHECK (mlock (pages, (PAGE_COUNT + 1) * PAGE_SIZE) == -1,
+			"locking past the limit fails");
+
+	CHECK (munlock (pages, PAGE_COUNT * PAGE_SIZE) == 0, "munlock");
+	CHECK (memstat (&ms) && ms.locked == 0, "no pages are locked");
+	CHECK (madvise (pages, PAGE_COUNT * PAGE_SIZE, MADV_DONTNEED) == 0,
+			"unlocked pages can be dropped");
+}
@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mlock) begin
+(mlock) mlock
+(mlock) memstat
+(mlock) locked pages are counted
+(mlock) limit is reported
+(mlock) mlock again
+(mlock) locking twice counts once
+(mlock) locked pages cannot be dropped
+(mlock) locking an unmapped page fails
+(mlock) locking past the limit fails
+(mlock) munlock
+(mlock) no pages are locked
+(mlock) unlocked pages can be dropped
+(mlock) end
+EOF
+pass;
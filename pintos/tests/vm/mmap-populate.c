@@ -0,0 +1,60 @@
+/* Checks that mmap() with MAP_POPULATE and madvise() with
+   MADV_WILLNEED read a file mapping in ahead of use: the pages are
+   resident before they are touched, and hold the file's data. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 16
+
+static char page[PAGE_SIZE];
+
+/* Checks that PAGE_COUNT pages at MAP hold what test_main() wrote. */
+static void
+check_data (const char *map)
+{
+	size_t i;
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		if (map[i * PAGE_SIZE] != (char) ('a' + i))
+			fail ("page %zu of the mapping has the wrong data", i);
+}
+
+void
+test_main (void)
+{
+	char *map = (char *) 0x10000000;
+	struct memstat before, after;
+	size_t i;
+	int fd;
+
+	CHECK (create ("populate", 0), "create \"populate\"");
+	CHECK ((fd = open ("populate")) > 1, "open \"populate\"");
+	for (i = 0; i < PAGE_COUNT; i++) {
+		page[0] = 'a' + i;
+		if (write (fd, page, PAGE_SIZE) != PAGE_SIZE)
+			fail ("write page %zu failed", i);
+	}
+
+	CHECK (memstat (&before), "memstat");
+	CHECK (mmap (map, PAGE_COUNT * PAGE_SIZE, 1 | MAP_POPULATE, fd, 0) == map,
+			"mmap with MAP_POPULATE");
+	CHECK (memstat (&after), "memstat");
+	CHECK (after.rss >= before.rss + PAGE_COUNT, "pages are resident before use");
+	check_data (map);
+	msg ("populated pages hold the file's data");
+	munmap (map);
+
+	CHECK (mmap (map, PAGE_COUNT * PAGE_SIZE, 0, fd, 0) == map, "mmap");
+	CHECK (memstat (&before), "memstat");
+	CHECK (madvise (map, PAGE_COUNT * PAGE_SIZE, MADV_WILLNEED) == 0,
+			"madvise MADV_WILLNEED");
+	CHECK (memstat (&after), "memstat");
+	CHECK (after.rss >= before.rss + PAGE_COUNT, "pages are resident before use");
+	check_data (map);
+	msg ("pages read ahead hold the file's data");
+	munmap (map);
+	close (fd);
+}
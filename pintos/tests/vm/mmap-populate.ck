@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-populate) begin
+(mmap-populate) create "populate"
+(mmap-populate) open "populate"
+(mmap-populate) memstat
+(mmap-populate) mmap with MAP_POPULATE
+(mmap-populate) memstat
+(mmap-populate) pages are resident before use
+(mmap-populate) populated pages hold the file's data
+(mmap-populate) mmap
+(mmap-populate) memstat
+(mmap-populate) madvise MADV_WILLNEED
+(mmap-populate) memstat
+(mmap-populate) pages are resident before use
+(mmap-populate) pages read ahead hold the file's data
+(mmap-populate) end
+EOF
+pass;
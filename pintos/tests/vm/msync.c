@@ -0,0 +1,66 @@
+/* Checks that msync() writes a shared mapping's dirty pages back to
+   the file without unmapping it, that later writes are written again
+   by munmap(), and that bad arguments are rejected. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 8
+
+static char page[PAGE_SIZE];
+
+/* Reads the file FD and checks that the first byte of each page is
+   'a' + the page number for pages in WRITTEN, '\0' otherwise. */
+static void
+check_contents (int fd, unsigned written)
+{
+	size_t i;
+
+	seek (fd, 0);
+	for (i = 0; i < PAGE_COUNT; i++) {
+		char expected = written & (1u << i) ? 'a' + i : 0;
+
+		if (read (fd, page, PAGE_SIZE) != PAGE_SIZE)
+			fail ("read page %zu failed", i);
+		if (page[0] != expected)
+			fail ("page %zu of the file has %02hhx, not %02hhx",
+					i, page[0], expected);
+	}
+}
+
+void
+test_main (void)
+{
+	char *map = (char *) 0x10000000;
+	size_t i;
+	int fd;
+
+	CHECK (create ("msync", PAGE_COUNT * PAGE_SIZE), "create \"msync\"");
+	CHECK ((fd = open ("msync")) > 1, "open \"msync\"");
+	CHECK (mmap (map, PAGE_COUNT * PAGE_SIZE, 1, fd, 0) == map, "mmap \"msync\"");
+
+	for (i = 0; i < PAGE_COUNT; i += 2)
+		map[i * PAGE_SIZE] = 'a' + i;
+	CHECK (msync (map, PAGE_COUNT * PAGE_SIZE, MS_SYNC) == 0, "msync");
+	check_contents (fd, 0x55);
+	msg ("file holds the written pages");
+
+	map[PAGE_SIZE] = 'b';
+	CHECK (msync (map + PAGE_SIZE, PAGE_SIZE, MS_ASYNC) == 0, "msync one page");
+	check_contents (fd, 0x57);
+	msg ("file holds the page written since");
+
+	CHECK (msync (map + 1, PAGE_SIZE, MS_SYNC) == -1, "misaligned msync fails");
+	CHECK (msync (map, PAGE_SIZE, MS_SYNC | MS_ASYNC) == -1,
+			"msync with MS_SYNC and MS_ASYNC fails");
+	CHECK (msync (map, (PAGE_COUNT + 1) * PAGE_SIZE, MS_SYNC) == -1,
+			"msync past the mapping fails");
+
+	map[3 * PAGE_SIZE] = 'd';
+	munmap (map);
+	check_contents (fd, 0x5f);
+	msg ("munmap wrote the last page");
+	close (fd);
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(msync) begin
+(msync) create "msync"
+(msync) open "msync"
+(msync) mmap "msync"
+(msync) msync
+(msync) file holds the written pages
+(msync) msync one page
+(msync) file holds the page written since
+(msync) misaligned msync fails
+(msync) msync with MS_SYNC and MS_ASYNC fails
+(msync) msync past the mapping fails
+(msync) munmap wrote the last page
+(msync) end
+EOF
+pass;
@@ -0,0 +1,14 @@
+#ifndef TESTS_VM_PERF_BENCH_H
+#define TESTS_VM_PERF_BENCH_H
+
+#include <stdint.h>
+
+/* Returns the CPU's time-stamp counter. */
+static inline uint64_t
+rdtsc (void) {
+	uint32_t lo, hi;
+	asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((uint64_t) hi << 32) | lo;
+}
+
+#endif /* tests/vm/perf/bench.h */
@@ -0,0 +1,85 @@
+/* Measures how long it takes to start a program.  Executables are
+   loaded lazily, so most of the time goes into the page faults that
+   bring in their text and data.  With fault-around a fault maps
+   the following pages of the executable as well, so fewer faults
+   and file reads are needed.
+
+   exec-main reports the time from exec() to its main() through
+   its exit status.  For child-simple from tests/userprog, which
+   prints a line and exits, the time from fork() to its exit is
+   measured instead. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/vm/perf/bench.h"
+
+#define EXEC_CNT 5
+
+/* Runs exec-main EXEC_CNT times and reports its exec-to-main time. */
+static void
+exec_to_main (void) {
+	uint64_t min = UINT64_MAX, total = 0;
+	int i;
+
+	for (i = 0; i < EXEC_CNT; i++) {
+		pid_t pid = fork ("exec-main");
+		uint64_t kcycles;
+
+		if (pid == 0) {
+			char cmd[64];
+
+			snprintf (cmd, sizeof cmd, "exec-main %llu", rdtsc ());
+			exec (cmd);
+			exit (-1);
+		}
+		if (pid < 0)
+			fail ("fork failed");
+		kcycles = wait (pid);
+		if (kcycles == (uint64_t) -1)
+			fail ("exec-main failed");
+
+		total += kcycles;
+		if (kcycles < min)
+			min = kcycles;
+	}
+	msg ("exec-main: min %llu, mean %llu kcycles from exec to main",
+	     min, total / EXEC_CNT);
+}
+
+/* Runs FILE EXEC_CNT times and reports the time from fork() to
+   its exit, fork-latency's cost included. */
+static void
+exec_to_exit (const char *file) {
+	uint64_t min = UINT64_MAX, total = 0;
+	int i;
+
+	for (i = 0; i < EXEC_CNT; i++) {
+		uint64_t start = rdtsc ();
+		pid_t pid = fork (file);
+		uint64_t kcycles;
+
+		if (pid == 0) {
+			exec (file);
+			exit (-1);
+		}
+		if (pid < 0)
+			fail ("fork failed");
+		wait (pid);
+		kcycles = (rdtsc () - start) >> 10;
+
+		total += kcycles;
+		if (kcycles < min)
+			min = kcycles;
+	}
+	msg ("%s: min %llu, mean %llu kcycles from fork to exit", file,
+	     min, total / EXEC_CNT);
+}
+
+void
+test_main (void) {
+	exec_to_main ();
+	exec_to_exit ("child-simple");
+}
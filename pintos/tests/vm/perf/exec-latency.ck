@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(exec-latency) begin
+(exec-latency) exec-main: min N, mean N kcycles from exec to main
+(child-simple) run
+(child-simple) run
+(child-simple) run
+(child-simple) run
+(child-simple) run
+(exec-latency) child-simple: min N, mean N kcycles from fork to exit
+(exec-latency) end
+EOF
@@ -0,0 +1,19 @@
+/* Child process run by exec-latency.  ARGV[1] is the time-stamp
+   counter read just before exec(); exits with the number of
+   kilocycles (1024 cycles) it took to reach main(). */
+
+#include <stdint.h>
+#include "tests/vm/perf/bench.h"
+
+int
+main (int argc, char *argv[]) {
+	uint64_t now = rdtsc ();
+	uint64_t start = 0;
+	const char *p;
+
+	if (argc != 2)
+		return -1;
+	for (p = argv[1]; *p >= '0' && *p <= '9'; p++)
+		start = start * 10 + (*p - '0');
+	return (now - start) >> 10;
+}
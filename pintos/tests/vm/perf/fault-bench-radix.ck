@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(fault-bench-radix) begin
+(fault-bench-radix) first touch: N cycles per fault
+(fault-bench-radix) lookup: min N, mean N cycles per N bytes
+(fault-bench-radix) end
+EOF
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(fault-bench) begin
+(fault-bench) first touch: N cycles per fault
+(fault-bench) lookup: min N, mean N cycles per N bytes
+(fault-bench) end
+EOF
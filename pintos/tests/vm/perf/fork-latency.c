@@ -0,0 +1,53 @@
+/* Measures how long fork() takes as the parent's resident set
+   grows.  The child exits at once, the way a fork followed by exec
+   would, so the time is spent duplicating the address space.  With
+   copy-on-write fork the cost should grow only slowly with the
+   number of resident pages, since no page contents are copied.
+   Reports cycles per fork for each size. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/vm/perf/bench.h"
+
+#define MAX_PAGES 1024
+#define FORK_CNT 10
+
+static char buf[MAX_PAGES * 4096];
+
+static const int sizes[] = { 0, 16, 64, 256, MAX_PAGES };
+
+void
+test_main (void) {
+	size_t i;
+	int p = 0;
+
+	for (i = 0; i < sizeof sizes / sizeof *sizes; i++) {
+		uint64_t min = UINT64_MAX, total = 0;
+		int j;
+
+		/* Make the first SIZES[I] pages of BUF resident and dirty. */
+		for (; p < sizes[i]; p++)
+			buf[p * 4096] = p;
+
+		for (j = 0; j < FORK_CNT; j++) {
+			uint64_t start = rdtsc ();
+			pid_t pid = fork ("child");
+			uint64_t cycles;
+
+			if (pid == 0)
+				exit (0);
+			cycles = rdtsc () - start;
+			if (pid < 0)
+				fail ("fork failed");
+			wait (pid);
+
+			total += cycles;
+			if (cycles < min)
+				min = cycles;
+		}
+		msg ("%d pages: min %llu, mean %llu cycles per fork", sizes[i],
+		     min, total / FORK_CNT);
+	}
+}
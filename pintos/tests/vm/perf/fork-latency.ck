@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(fork-latency) begin
+(fork-latency) N pages: min N, mean N cycles per fork
+(fork-latency) N pages: min N, mean N cycles per fork
+(fork-latency) N pages: min N, mean N cycles per fork
+(fork-latency) N pages: min N, mean N cycles per fork
+(fork-latency) N pages: min N, mean N cycles per fork
+(fork-latency) end
+EOF
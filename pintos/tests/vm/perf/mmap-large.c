@@ -0,0 +1,65 @@
+/* Measures mmap() and munmap() of mappings from 16 pages up to
+   256 MiB.  The file itself is only FILE_PAGES long; the rest of
+   each mapping reads as zeros.  A mapping is recorded as one region
+   and its pages are only set up when touched, so both calls should
+   cost about the same at every size.  TOUCH_CNT pages spread over
+   each mapping are touched in between.  Reports cycles per call. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/vm/perf/bench.h"
+
+#define FILE_PAGES 16
+#define TOUCH_CNT 16
+#define REPEAT 5
+
+static char *const base = (char *) 0x10000000;
+
+static const size_t sizes[] = { 16, 256, 4096, 65536 };
+
+void
+test_main (void) {
+	size_t i;
+	int fd;
+
+	if (!create ("large", FILE_PAGES * 4096))
+		fail ("create \"large\" failed");
+	fd = open ("large");
+	if (fd < 2)
+		fail ("open \"large\" failed");
+
+	for (i = 0; i < sizeof sizes / sizeof *sizes; i++) {
+		size_t length = sizes[i] * 4096;
+		uint64_t map_min = UINT64_MAX, map_total = 0;
+		uint64_t unmap_min = UINT64_MAX, unmap_total = 0;
+		int j, t;
+
+		for (j = 0; j < REPEAT; j++) {
+			uint64_t start = rdtsc ();
+			void *map = mmap (base, length, 1, fd, 0);
+			uint64_t cycles = rdtsc () - start;
+
+			if (map != base)
+				fail ("mmap of %zu pages failed", sizes[i]);
+			map_total += cycles;
+			if (cycles < map_min)
+				map_min = cycles;
+
+			for (t = 0; t < TOUCH_CNT; t++)
+				base[t * (length / TOUCH_CNT)]++;
+
+			start = rdtsc ();
+			munmap (map);
+			cycles = rdtsc () - start;
+			unmap_total += cycles;
+			if (cycles < unmap_min)
+				unmap_min = cycles;
+		}
+		msg ("%zu pages: mmap min %llu, mean %llu; munmap min %llu, "
+		     "mean %llu cycles", sizes[i], map_min, map_total / REPEAT,
+		     unmap_min, unmap_total / REPEAT);
+	}
+	close (fd);
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(mmap-large) begin
+(mmap-large) N pages: mmap min N, mean N; munmap min N, mean N cycles
+(mmap-large) N pages: mmap min N, mean N; munmap min N, mean N cycles
+(mmap-large) N pages: mmap min N, mean N; munmap min N, mean N cycles
+(mmap-large) N pages: mmap min N, mean N; munmap min N, mean N cycles
+(mmap-large) end
+EOF
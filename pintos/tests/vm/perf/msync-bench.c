@@ -0,0 +1,69 @@
+/* Measures msync() on a FILE_PAGES mapping after dirtying DIRTY_CNT
+   random pages, and, for comparison, after dirtying a run of DIRTY_CNT
+   pages in order.  msync() sorts the dirty pages by file offset and
+   writes runs of neighbours together, so the random case should cost
+   little more than the sequential one.  Reports cycles per flush and
+   per dirty page. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/vm/perf/bench.h"
+
+#define FILE_PAGES 128
+#define DIRTY_CNT 64
+#define REPEAT 4
+
+static char *const base = (char *) 0x10000000;
+
+/* Dirties DIRTY_CNT pages of the mapping, RANDOM or in order, then
+   times msync().  Reports as NAME. */
+static void
+measure (const char *name, bool random)
+{
+	uint64_t min = UINT64_MAX, total = 0;
+	uint32_t seed = 12345;
+	int i, j;
+
+	for (i = 0; i < REPEAT; i++) {
+		uint64_t start, cycles;
+
+		for (j = 0; j < DIRTY_CNT; j++) {
+			size_t p = j;
+
+			if (random) {
+				seed = seed * 1103515245 + 12345;
+				p = (seed >> 16) % FILE_PAGES;
+			}
+			base[p * 4096 + i]++;
+		}
+		start = rdtsc ();
+		if (msync (base, FILE_PAGES * 4096, MS_SYNC) != 0)
+			fail ("msync failed");
+		cycles = rdtsc () - start;
+		total += cycles;
+		if (cycles < min)
+			min = cycles;
+	}
+	msg ("%s: msync min %llu, mean %llu cycles, %llu per dirty page",
+	     name, min, total / REPEAT, min / DIRTY_CNT);
+}
+
+void
+test_main (void) {
+	int fd;
+
+	if (!create ("dirty", FILE_PAGES * 4096))
+		fail ("create \"dirty\" failed");
+	fd = open ("dirty");
+	if (fd < 2)
+		fail ("open \"dirty\" failed");
+	if (mmap (base, FILE_PAGES * 4096, 1, fd, 0) != base)
+		fail ("mmap failed");
+
+	measure ("random", true);
+	measure ("sequential", false);
+	munmap (base);
+	close (fd);
+}
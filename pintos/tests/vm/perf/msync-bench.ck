@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(msync-bench) begin
+(msync-bench) random: msync min N, mean N cycles, N per dirty page
+(msync-bench) sequential: msync min N, mean N cycles, N per dirty page
+(msync-bench) end
+EOF
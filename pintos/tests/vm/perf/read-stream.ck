@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(read-stream) begin
+(read-stream) create "stream"
+(read-stream) open "stream"
+(read-stream) aligned: first pass N, later passes min N cycles per page
+(read-stream) unaligned: first pass N, later passes min N cycles per page
+(read-stream) end
+EOF
@@ -0,0 +1,134 @@
+/* Measures handing ITEMS words from a parent to a forked child two
+   ways: through a ring buffer in memory mapped with MAP_ANONYMOUS,
+   which both processes map directly, and through a file the parent
+   writes and the child reads back.  The child adds up what it got and
+   exits with the low bits of the sum so the parent can check it.
+   Pintos runs one process at a time, so the ring's cost includes the
+   time each side spins until it is preempted.  Reports cycles per
+   item for each. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/vm/perf/bench.h"
+
+#define ITEMS 65536
+#define RING_PAGES 4
+#define RING_SLOTS ((RING_PAGES * 4096 - 64) / sizeof (uint32_t))
+
+/* Lives at the start of the shared mapping. */
+struct ring {
+	volatile uint32_t head;         /* Next slot the producer fills. */
+	volatile uint32_t tail;         /* Next slot the consumer reads. */
+	uint32_t pad[14];
+	volatile uint32_t slots[RING_SLOTS];
+};
+
+static struct ring *const ring = (struct ring *) 0x10000000;
+static uint32_t buf[1024];
+
+static uint32_t
+item (uint32_t i) {
+	return i * 2654435761u;
+}
+
+/* Exit code the child uses to report SUM. */
+static int
+sum_code (uint32_t sum) {
+	return sum & 0x7f;
+}
+
+/* Reports CYCLES for NAME, per item. */
+static void
+report (const char *name, uint64_t cycles) {
+	msg ("%s: %llu cycles, %llu per item", name, cycles, cycles / ITEMS);
+}
+
+/* Hands the items through the ring. */
+static uint64_t
+measure_ring (uint32_t sum) {
+	uint64_t start = rdtsc ();
+	pid_t pid;
+	uint32_t i;
+
+	ring->head = ring->tail = 0;
+	pid = fork ("consumer");
+	if (pid == 0) {
+		uint32_t got = 0;
+
+		for (i = 0; i < ITEMS; i++) {
+			while (ring->tail == ring->head)
+				continue;
+			got += ring->slots[ring->tail % RING_SLOTS];
+			ring->tail++;
+		}
+		exit (sum_code (got));
+	}
+	if (pid < 0)
+		fail ("fork failed");
+	for (i = 0; i < ITEMS; i++) {
+		while (ring->head - ring->tail == RING_SLOTS)
+			continue;
+		ring->slots[ring->head % RING_SLOTS] = item (i);
+		ring->head++;
+	}
+	if (wait (pid) != sum_code (sum))
+		fail ("consumer got the wrong items through the ring");
+	return rdtsc () - start;
+}
+
+/* Hands the items through a file. */
+static uint64_t
+measure_file (uint32_t sum) {
+	uint64_t start = rdtsc ();
+	pid_t pid;
+	uint32_t i, j;
+	int fd;
+
+	if (!create ("items", 0))
+		fail ("create \"items\" failed");
+	fd = open ("items");
+	if (fd < 2)
+		fail ("open \"items\" failed");
+	for (i = 0; i < ITEMS; i += 1024) {
+		for (j = 0; j < 1024; j++)
+			buf[j] = item (i + j);
+		if (write (fd, buf, sizeof buf) != sizeof buf)
+			fail ("write failed");
+	}
+	close (fd);
+
+	pid = fork ("consumer");
+	if (pid == 0) {
+		uint32_t got = 0;
+
+		fd = open ("items");
+		for (i = 0; i < ITEMS; i += 1024) {
+			if (read (fd, buf, sizeof buf) != sizeof buf)
+				exit (-1);
+			for (j = 0; j < 1024; j++)
+				got += buf[j];
+		}
+		exit (sum_code (got));
+	}
+	if (pid < 0)
+		fail ("fork failed");
+	if (wait (pid) != sum_code (sum))
+		fail ("consumer got the wrong items through the file");
+	return rdtsc () - start;
+}
+
+void
+test_main (void) {
+	uint32_t sum = 0, i;
+
+	for (i = 0; i < ITEMS; i++)
+		sum += item (i);
+	if (mmap (ring, RING_PAGES * 4096, 1 | MAP_ANONYMOUS, -1, 0) != ring)
+		fail ("mmap failed");
+
+	report ("shared ring", measure_ring (sum));
+	report ("file", measure_file (sum));
+	munmap (ring);
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(shm-ring) begin
+(shm-ring) shared ring: N cycles, N per item
+(shm-ring) file: N cycles, N per item
+(shm-ring) end
+EOF
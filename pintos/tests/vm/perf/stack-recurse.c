@@ -0,0 +1,58 @@
+/* Counts stack-growth faults.  First allocates a 64 kB object on the
+   stack, which one fault should map whole, then recurses FRAMES deep
+   with FRAME_BYTES of locals per call, which maps pages ahead of the
+   stack pointer as the recursion keeps going.  Compare the fault
+   counts against the number of stack pages touched. */
+
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/vm/perf/bench.h"
+
+#define OBJ_BYTES 65536
+#define FRAME_BYTES 512
+#define FRAMES 1024
+
+static int __attribute__ ((noinline))
+big_object (void)
+{
+	volatile char obj[OBJ_BYTES];
+
+	memset ((char *) obj, 1, sizeof obj);
+	return obj[0];
+}
+
+static int __attribute__ ((noinline))
+recurse (int depth)
+{
+	volatile char pad[FRAME_BYTES];
+
+	pad[0] = depth;
+	if (depth == 0)
+		return 0;
+	return recurse (depth - 1) + pad[0];
+}
+
+void
+test_main (void) {
+	long long faults;
+	uint64_t start, cycles;
+
+	faults = get_vm_event_cnt (VMSTAT_FAULT_STACK, false);
+	start = rdtsc ();
+	big_object ();
+	cycles = rdtsc () - start;
+	msg ("stack object: %lld faults for %d pages, %llu cycles",
+	     get_vm_event_cnt (VMSTAT_FAULT_STACK, false) - faults,
+	     OBJ_BYTES / 4096, cycles);
+
+	faults = get_vm_event_cnt (VMSTAT_FAULT_STACK, false);
+	start = rdtsc ();
+	recurse (FRAMES);
+	cycles = rdtsc () - start;
+	msg ("recursion: %lld faults for %d pages, %llu cycles",
+	     get_vm_event_cnt (VMSTAT_FAULT_STACK, false) - faults,
+	     FRAMES * FRAME_BYTES / 4096, cycles);
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(stack-recurse) begin
+(stack-recurse) stack object: N faults for N pages, N cycles
+(stack-recurse) recursion: N faults for N pages, N cycles
+(stack-recurse) end
+EOF
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(string-bench) begin
+(string-bench) N bytes: memcpy N, memset N, memcmp N, strlen N bytes per kilocycle
+(string-bench) N bytes: memcpy N, memset N, memcmp N, strlen N bytes per kilocycle
+(string-bench) N bytes: memcpy N, memset N, memcmp N, strlen N bytes per kilocycle
+(string-bench) N bytes: memcpy N, memset N, memcmp N, strlen N bytes per kilocycle
+(string-bench) N bytes: memcpy N, memset N, memcmp N, strlen N bytes per kilocycle
+(string-bench) N bytes: memcpy N, memset N, memcmp N, strlen N bytes per kilocycle
+(string-bench) N bytes: memcpy N, memset N, memcmp N, strlen N bytes per kilocycle
+(string-bench) end
+EOF
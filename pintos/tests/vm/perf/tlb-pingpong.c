@@ -0,0 +1,121 @@
+/* Forks a child, then parent and child hand control back and forth
+   ROUND_CNT times, each side sweeping the same 64-page working set,
+   one byte per page, right after it is switched in.  Pintos has no
+   pipes or user semaphores, so the hand-off is a user-handled fault:
+   the parent touches the next page of a registered range and sleeps,
+   and the child, blocked in uffd_read(), wakes, sweeps, supplies the
+   page and blocks again, which switches back to the parent.  With
+   PCID-tagged TLBs the sweep after a switch should cost little more
+   than a warm one; without tagging each switch refills the TLB.
+   Reports cycles per sweep after a switch for both processes and
+   cycles per round trip for the parent. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/vm/perf/bench.h"
+
+#define PAGE_CNT 64
+#define ROUND_CNT 512
+#define REGION ((volatile char *) 0x10000000)
+
+static volatile char buf[PAGE_CNT * 4096];
+
+struct result {
+	uint64_t min, total, max;
+};
+
+static void
+result_init (struct result *r) {
+	r->min = UINT64_MAX;
+	r->total = r->max = 0;
+}
+
+static void
+result_add (struct result *r, uint64_t cycles) {
+	r->total += cycles;
+	if (cycles < r->min)
+		r->min = cycles;
+	if (cycles > r->max)
+		r->max = cycles;
+}
+
+/* Sweeps the working set once and adds its cost to R. */
+static void
+sweep (struct result *r) {
+	uint64_t start = rdtsc ();
+	int p;
+
+	for (p = 0; p < PAGE_CNT; p++)
+		buf[p * 4096]++;
+	result_add (r, rdtsc () - start);
+}
+
+/* Fault everything in first, so later sweeps only miss in the TLB. */
+static void
+warm (void) {
+	int p;
+
+	for (p = 0; p < PAGE_CNT; p++)
+		buf[p * 4096] = 0;
+}
+
+static void
+report (const char *who, const struct result *r) {
+	msg ("%s: min %llu, mean %llu, max %llu cycles per sweep after a switch",
+			who, (unsigned long long) r->min,
+			(unsigned long long) (r->total / ROUND_CNT),
+			(unsigned long long) r->max);
+}
+
+/* Runs in the child: each fault the parent takes wakes it up. */
+static void
+handle (void) {
+	struct uffd_msg m;
+	struct result r;
+	int i;
+
+	warm ();
+	result_init (&r);
+	for (i = 0; i < ROUND_CNT; i++) {
+		if (!uffd_read (&m))
+			fail ("uffd_read failed");
+		sweep (&r);
+		if (uffd_zero (m.addr, 4096) != 0)
+			fail ("uffd_zero failed");
+	}
+	report ("child", &r);
+}
+
+void
+test_main (void) {
+	struct result r, trip;
+	pid_t child;
+	int i;
+
+	CHECK (uffd_register ((void *) REGION, ROUND_CNT * 4096) == 0, "register");
+	child = fork ("child");
+	if (child == 0) {
+		handle ();
+		exit (0);
+	}
+	CHECK (child > 0, "fork");
+
+	warm ();
+	result_init (&r);
+	result_init (&trip);
+	for (i = 0; i < ROUND_CNT; i++) {
+		uint64_t start = rdtsc ();
+
+		REGION[i * 4096];
+		result_add (&trip, rdtsc () - start);
+		sweep (&r);
+	}
+
+	/* Report after the child has, to keep the output in order. */
+	wait (child);
+	report ("parent", &r);
+	msg ("parent: %llu cycles per round trip",
+			(unsigned long long) (trip.total / ROUND_CNT));
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(tlb-pingpong) begin
+(tlb-pingpong) register
+(tlb-pingpong) fork
+(tlb-pingpong) child: min N, mean N, max N cycles per sweep after a switch
+(tlb-pingpong) parent: min N, mean N, max N cycles per sweep after a switch
+(tlb-pingpong) parent: N cycles per round trip
+(tlb-pingpong) end
+EOF
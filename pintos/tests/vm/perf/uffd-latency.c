@@ -0,0 +1,77 @@
+/* Measures the round trip of a fault handled in user space: the
+   parent touches each page of a registered range, and a forked
+   handler reads the fault and supplies the page with uffd_copy() or
+   uffd_zero().  Each touch costs a fault, a switch to the handler,
+   its two system calls and a switch back.  For comparison, also
+   times first touches of ordinary anonymous memory. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/vm/perf/bench.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 256
+#define COPY_REGION ((char *) 0x10000000)
+#define ZERO_REGION ((char *) 0x20000000)
+
+static char src[PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+static char anon[PAGES * PAGE_SIZE];
+
+/* Answers PAGES faults in each region, by copying in the first and
+   zeroing in the second. */
+static void
+handle (void)
+{
+	struct uffd_msg msg;
+	int i;
+
+	src[0] = 1;
+	for (i = 0; i < 2 * PAGES; i++) {
+		if (!uffd_read (&msg))
+			fail ("uffd_read failed");
+		if ((char *) msg.addr < ZERO_REGION
+				? uffd_copy (msg.addr, src, PAGE_SIZE) != 0
+				: uffd_zero (msg.addr, PAGE_SIZE) != 0)
+			fail ("could not supply %p", msg.addr);
+	}
+}
+
+/* Touches every page of REGION and reports the cycles per touch as
+   NAME. */
+static void
+measure (const char *name, char *region)
+{
+	uint64_t min = UINT64_MAX, total = 0;
+	int i;
+
+	for (i = 0; i < PAGES; i++) {
+		uint64_t start = rdtsc (), cycles;
+
+		((volatile char *) region)[i * PAGE_SIZE];
+		cycles = rdtsc () - start;
+		total += cycles;
+		if (cycles < min)
+			min = cycles;
+	}
+	msg ("%s: min %llu, mean %llu cycles per fault", name, min, total / PAGES);
+}
+
+void
+test_main (void) {
+	pid_t child;
+
+	CHECK (uffd_register (COPY_REGION, PAGES * PAGE_SIZE) == 0
+			&& uffd_register (ZERO_REGION, PAGES * PAGE_SIZE) == 0, "register");
+	child = fork ("handler");
+	if (child == 0) {
+		handle ();
+		exit (0);
+	}
+	CHECK (child > 0, "fork handler");
+	measure ("copy", COPY_REGION);
+	measure ("zero", ZERO_REGION);
+	measure ("anonymous", anon);
+	wait (child);
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(uffd-latency) begin
+(uffd-latency) register
+(uffd-latency) fork handler
+(uffd-latency) copy: min N, mean N cycles per fault
+(uffd-latency) zero: min N, mean N cycles per fault
+(uffd-latency) anonymous: min N, mean N cycles per fault
+(uffd-latency) end
+EOF
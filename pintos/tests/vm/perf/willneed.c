@@ -0,0 +1,71 @@
+/* Measures how much of a file mapping's first-touch cost MADV_WILLNEED
+   and MAP_POPULATE take off the access path.  Maps a FILE_PAGES file
+   three ways and reads one byte of every page: cold, where each page
+   faults (with fault-around); after madvise(MADV_WILLNEED); and with
+   MAP_POPULATE.  Reports cycles for the setup call and for the sweep,
+   per page. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/vm/perf/bench.h"
+
+#define FILE_PAGES 128
+#define REPEAT 4
+
+static char *const base = (char *) 0x10000000;
+static char page[4096];
+
+/* Maps the file FD with WRITABLE, calls madvise(ADVICE) unless ADVICE
+   is negative, then touches every page.  Reports as NAME. */
+static void
+measure (const char *name, int fd, int writable, int advice)
+{
+	uint64_t setup_min = UINT64_MAX, sweep_min = UINT64_MAX;
+	int i, sum = 0;
+	size_t p;
+
+	for (i = 0; i < REPEAT; i++) {
+		uint64_t start = rdtsc (), mid, end;
+
+		if (mmap (base, FILE_PAGES * 4096, writable, fd, 0) != base)
+			fail ("mmap failed");
+		if (advice >= 0 && madvise (base, FILE_PAGES * 4096, advice) != 0)
+			fail ("madvise failed");
+		mid = rdtsc ();
+		for (p = 0; p < FILE_PAGES; p++)
+			sum += base[p * 4096];
+		end = rdtsc ();
+		if (mid - start < setup_min)
+			setup_min = mid - start;
+		if (end - mid < sweep_min)
+			sweep_min = end - mid;
+		munmap (base);
+	}
+	if (sum != REPEAT * FILE_PAGES)
+		fail ("%s: read wrong data", name);
+	msg ("%s: setup %llu, sweep %llu cycles per page", name,
+	     setup_min / FILE_PAGES, sweep_min / FILE_PAGES);
+}
+
+void
+test_main (void) {
+	size_t p;
+	int fd;
+
+	if (!create ("willneed", 0))
+		fail ("create \"willneed\" failed");
+	fd = open ("willneed");
+	if (fd < 2)
+		fail ("open \"willneed\" failed");
+	page[0] = 1;
+	for (p = 0; p < FILE_PAGES; p++)
+		if (write (fd, page, sizeof page) != sizeof page)
+			fail ("write failed");
+
+	measure ("cold", fd, 0, -1);
+	measure ("willneed", fd, 0, MADV_WILLNEED);
+	measure ("populate", fd, MAP_POPULATE, -1);
+	close (fd);
+}
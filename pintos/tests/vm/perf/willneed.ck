@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::bench;
+check_bench ([<<'EOF']);
+(willneed) begin
+(willneed) cold: setup N, sweep N cycles per page
+(willneed) willneed: setup N, sweep N cycles per page
+(willneed) populate: setup N, sweep N cycles per page
+(willneed) end
+EOF
@@ -0,0 +1,76 @@
+/* Checks read() and write() with page-aligned buffers and lengths,
+   which move whole pages between the file and the buffer's frames.
+   Data written from one buffer reads back into untouched memory, the
+   file position advances, a short read at the end of the file keeps
+   the rest of the page, and a child reading into memory it shares
+   with its parent copy-on-write leaves the parent's copy alone. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 4
+
+static char out[PAGE_COUNT * PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+static char in[PAGE_COUNT * PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+static char tail[PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+static void
+check_pages (const char *buf, size_t cnt)
+{
+	size_t i;
+
+	for (i = 0; i < cnt * PAGE_SIZE; i++)
+		if (buf[i] != (char) (i * 7 + i / PAGE_SIZE))
+			fail ("byte %zu is %02hhx", i, buf[i]);
+}
+
+void
+test_main (void)
+{
+	pid_t child;
+	size_t i;
+	int fd;
+
+	for (i = 0; i < sizeof out; i++)
+		out[i] = i * 7 + i / PAGE_SIZE;
+
+	/* Half a page longer than what is written, which reads as zeros. */
+	CHECK (create ("direct", sizeof out + PAGE_SIZE / 2), "create \"direct\"");
+	CHECK ((fd = open ("direct")) > 1, "open \"direct\"");
+	CHECK (write (fd, out, sizeof out) == (int) sizeof out, "write %zu bytes",
+			sizeof out);
+	CHECK (tell (fd) == sizeof out, "position after write");
+
+	seek (fd, 0);
+	CHECK (read (fd, in, sizeof in) == (int) sizeof in, "read %zu bytes",
+			sizeof in);
+	check_pages (in, PAGE_COUNT);
+	CHECK (tell (fd) == sizeof in, "position after read");
+
+	/* The file ends half way into this read. */
+	memset (tail, 'x', sizeof tail);
+	CHECK (read (fd, tail, PAGE_SIZE) == PAGE_SIZE / 2, "short read at end of file");
+	for (i = 0; i < PAGE_SIZE; i++)
+		if (tail[i] != (i < PAGE_SIZE / 2 ? 0 : 'x'))
+			fail ("byte %zu of the short read is %02hhx", i, tail[i]);
+
+	memset (in, 0, sizeof in);
+	child = fork ("child");
+	if (child == 0) {
+		seek (fd, 0);
+		if (read (fd, in, sizeof in) != (int) sizeof in)
+			exit (1);
+		check_pages (in, PAGE_COUNT);
+		exit (0);
+	}
+	CHECK (child > 0, "fork");
+	CHECK (wait (child) == 0, "child read into its copy");
+	for (i = 0; i < sizeof in; i++)
+		if (in[i] != 0)
+			fail ("child's read changed the parent's byte %zu", i);
+	msg ("parent's copy is unchanged");
+	close (fd);
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(read-direct) begin
+(read-direct) create "direct"
+(read-direct) open "direct"
+(read-direct) write 16384 bytes
+(read-direct) position after write
+(read-direct) read 16384 bytes
+(read-direct) position after read
+(read-direct) short read at end of file
+(read-direct) fork
+(read-direct) child read into its copy
+(read-direct) parent's copy is unchanged
+(read-direct) end
+EOF
+pass;
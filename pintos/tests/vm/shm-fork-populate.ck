@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(shm-fork-populate) begin
+(shm-fork-populate) mmap with MAP_ANONYMOUS | MAP_POPULATE
+(shm-fork-populate) populated mapping reads as zeros
+(shm-fork-populate) fork
+(shm-fork-populate) child saw the parent's writes
+(shm-fork-populate) parent sees the child's writes
+(shm-fork-populate) end
+EOF
+pass;
@@ -0,0 +1,49 @@
+/* Checks that memory mapped with MAP_ANONYMOUS is zero-filled and
+   shared with a child forked later: the child sees what the parent
+   wrote, and the parent sees what the child wrote, including on a
+   page neither touched before the fork, after the child has exited. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 4
+
+void
+test_main (void)
+{
+	char *map = (char *) 0x10000000;
+	pid_t child;
+	size_t i;
+
+	CHECK (mmap (map, PAGE_COUNT * PAGE_SIZE, 1 | MAP_ANONYMOUS, -1, 0) == map,
+			"mmap with MAP_ANONYMOUS");
+	for (i = 0; i < PAGE_COUNT * PAGE_SIZE; i++)
+		if (map[i] != 0)
+			fail ("byte %zu of the mapping is not zero", i);
+	msg ("new mapping reads as zeros");
+
+	/* Page 2 is left for the child to touch first. */
+	for (i = 0; i < PAGE_COUNT; i++)
+		if (i != 2)
+			map[i * PAGE_SIZE] = 'p' + i;
+
+	child = fork ("child");
+	if (child == 0) {
+		for (i = 0; i < PAGE_COUNT; i++)
+			if (i != 2 && map[i * PAGE_SIZE] != (char) ('p' + i))
+				exit (1);
+		for (i = 0; i < PAGE_COUNT; i++)
+			map[i * PAGE_SIZE + 1] = 'c' + i;
+		exit (0);
+	}
+	CHECK (child > 0, "fork");
+	CHECK (wait (child) == 0, "child saw the parent's writes");
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		if (map[i * PAGE_SIZE + 1] != (char) ('c' + i))
+			fail ("page %zu does not hold the child's write", i);
+	msg ("parent sees the child's writes");
+	munmap (map);
+}
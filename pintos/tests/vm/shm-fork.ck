@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(shm-fork) begin
+(shm-fork) mmap with MAP_ANONYMOUS
+(shm-fork) new mapping reads as zeros
+(shm-fork) fork
+(shm-fork) child saw the parent's writes
+(shm-fork) parent sees the child's writes
+(shm-fork) end
+EOF
+pass;
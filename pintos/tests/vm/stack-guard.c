@@ -0,0 +1,32 @@
+/* Recurses without bound in a child process.  The stack stops growing
+   at its limit: the child is killed with exit code -1 when it reaches
+   the guard page below the stack, and the parent is unaffected. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int
+recurse (int depth)
+{
+	volatile char pad[1024];
+
+	pad[0] = depth;
+	if (depth < 0)
+		return 0;
+	return recurse (depth + 1) + pad[0];
+}
+
+void
+test_main (void)
+{
+	pid_t child;
+
+	child = fork ("child");
+	if (child == 0) {
+		recurse (0);
+		exit (0);
+	}
+	CHECK (child > 0, "fork");
+	CHECK (wait (child) == -1, "child killed at the stack limit");
+}
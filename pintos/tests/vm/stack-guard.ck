@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(stack-guard) begin
+(stack-guard) fork
+(stack-guard) child killed at the stack limit
+(stack-guard) end
+EOF
+pass;
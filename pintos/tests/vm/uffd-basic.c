@@ -0,0 +1,103 @@
+/* Resolves faults in a user-handled range from a forked handler.
+   The parent registers REGION_PAGES pages and forks a child that
+   answers each fault, even pages with a copy of a pattern and odd
+   pages with zeros.  On the first fault the handler also supplies the
+   last page ahead of use, so that page never faults, and checks that
+   it cannot supply that page twice or a page outside the range.
+   Until the parent's own fault is answered it maps nothing, so the
+   last page is still pending at that point.  The parent
+   checks the contents it reads, that the pages are writable, and
+   that every other page went through the handler. */
+
+#include <string.h>
+#include <syscall.h>
+#include <vmstat.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define REGION_PAGES 8
+#define REGION ((char *) 0x10000000)
+
+static char pattern[PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+/* Fills PATTERN with the contents page IDX should have. */
+static void
+make_pattern (size_t idx)
+{
+	size_t i;
+
+	for (i = 0; i < PAGE_SIZE; i++)
+		pattern[i] = i * 3 + idx;
+}
+
+/* Supplies page IDX of the region. */
+static void
+supply (size_t idx)
+{
+	char *dst = REGION + idx * PAGE_SIZE;
+
+	if (idx % 2 == 0) {
+		make_pattern (idx);
+		if (uffd_copy (dst, pattern, PAGE_SIZE) != 0)
+			fail ("uffd_copy failed");
+	} else if (uffd_zero (dst, PAGE_SIZE) != 0)
+		fail ("uffd_zero failed");
+}
+
+/* Handles the faults the parent takes on all pages but the last. */
+static void
+handle (void)
+{
+	struct uffd_msg msg;
+	size_t i;
+
+	for (i = 0; i < REGION_PAGES - 1; i++) {
+		if (!uffd_read (&msg))
+			fail ("uffd_read failed");
+		if (i == 0) {
+			supply (REGION_PAGES - 1);
+			if (uffd_zero (REGION + (REGION_PAGES - 1) * PAGE_SIZE, PAGE_SIZE) != -1)
+				fail ("pending page supplied twice");
+			if (uffd_zero (REGION + REGION_PAGES * PAGE_SIZE, PAGE_SIZE) != -1)
+				fail ("page outside the range supplied");
+		}
+		supply ((size_t) ((char *) msg.addr - REGION) / PAGE_SIZE);
+	}
+}
+
+void
+test_main (void)
+{
+	long long faults = get_vm_event_cnt (VMSTAT_FAULT_USER, false);
+	size_t i, j;
+	pid_t child;
+
+	CHECK (uffd_register (REGION, REGION_PAGES * PAGE_SIZE) == 0, "register");
+	CHECK (uffd_register (REGION + PAGE_SIZE, PAGE_SIZE) == -1,
+			"register overlapping range rejected");
+
+	child = fork ("handler");
+	if (child == 0) {
+		handle ();
+		exit (0);
+	}
+	CHECK (child > 0, "fork handler");
+
+	for (i = 0; i < REGION_PAGES; i++) {
+		char *page = REGION + i * PAGE_SIZE;
+
+		for (j = 0; j < PAGE_SIZE; j++)
+			if (page[j] != (i % 2 == 0 ? (char) (j * 3 + i) : 0))
+				fail ("byte %zu of page %zu is %02hhx", j, i, page[j]);
+	}
+	msg ("pages read back as supplied");
+
+	for (i = 0; i < REGION_PAGES; i++)
+		REGION[i * PAGE_SIZE] = 'x';
+	msg ("supplied pages are writable");
+
+	CHECK (get_vm_event_cnt (VMSTAT_FAULT_USER, false) - faults
+			== REGION_PAGES - 1, "faults went to the handler");
+	CHECK (wait (child) == 0, "wait for handler");
+}
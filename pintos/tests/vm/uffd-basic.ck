@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(uffd-basic) begin
+(uffd-basic) register
+(uffd-basic) register overlapping range rejected
+(uffd-basic) fork handler
+(uffd-basic) pages read back as supplied
+(uffd-basic) supplied pages are writable
+(uffd-basic) faults went to the handler
+(uffd-basic) wait for handler
+(uffd-basic) end
+EOF
+pass;
@@ -0,0 +1,67 @@
+/* Checks the VM event counters reported by vmstat() and by
+   get_vm_event_cnt(): reading untouched memory counts minor faults
+   served with the zero page, reading a file mapping counts major faults
+   and file reads, and the whole-system counts are never behind the
+   process's own. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 8
+
+/* One page more than is read, since the first may share a page with
+   initialized data. */
+static char zeros[(PAGE_COUNT + 1) * PAGE_SIZE];
+static char page[PAGE_SIZE];
+
+void
+test_main (void)
+{
+	char *map = (char *) 0x10000000;
+	struct vmstat before, after, all;
+	volatile char sum = 0;
+	size_t i;
+	int fd;
+
+	CHECK (vmstat (VMSTAT_SELF, &before), "vmstat");
+	for (i = 1; i <= PAGE_COUNT; i++)
+		sum += zeros[i * PAGE_SIZE];
+	CHECK (vmstat (VMSTAT_SELF, &after), "vmstat");
+	CHECK (after.events[VMSTAT_FAULT_ZERO] >= before.events[VMSTAT_FAULT_ZERO] + PAGE_COUNT,
+			"reads of untouched pages counted as zero-page faults");
+	CHECK (after.events[VMSTAT_FAULT_MINOR] >= before.events[VMSTAT_FAULT_MINOR] + PAGE_COUNT,
+			"and as minor faults");
+
+	CHECK (create ("counted", 0), "create \"counted\"");
+	CHECK ((fd = open ("counted")) > 1, "open \"counted\"");
+	for (i = 0; i < PAGE_COUNT; i++)
+		if (write (fd, page, PAGE_SIZE) != PAGE_SIZE)
+			fail ("write page %zu failed", i);
+	CHECK (mmap (map, PAGE_COUNT * PAGE_SIZE, 0, fd, 0) == map, "mmap");
+	CHECK (vmstat (VMSTAT_SELF, &before), "vmstat");
+	for (i = 0; i < PAGE_COUNT; i++)
+		sum += map[i * PAGE_SIZE];
+	CHECK (vmstat (VMSTAT_SELF, &after), "vmstat");
+	CHECK (after.events[VMSTAT_FAULT_MAJOR] > before.events[VMSTAT_FAULT_MAJOR],
+			"reads of a file mapping counted as major faults");
+	CHECK (after.events[VMSTAT_FILE_IN] >= before.events[VMSTAT_FILE_IN] + PAGE_COUNT,
+			"and as file reads");
+	munmap (map);
+	close (fd);
+
+	CHECK (after.events[VMSTAT_FAULT] >= after.events[VMSTAT_FAULT_MAJOR]
+			+ after.events[VMSTAT_FAULT_MINOR], "faults add up");
+	CHECK (vmstat (VMSTAT_ALL, &all), "vmstat for the whole system");
+	for (i = 0; i < VMSTAT_EVENT_CNT; i++)
+		if (all.events[i] < after.events[i])
+			fail ("system count of event %zu is behind the process's", i);
+	CHECK (get_vm_event_cnt (VMSTAT_FAULT, false) >= after.events[VMSTAT_FAULT],
+			"get_vm_event_cnt for the process");
+	CHECK (get_vm_event_cnt (VMSTAT_FAULT, true) >= all.events[VMSTAT_FAULT],
+			"get_vm_event_cnt for the whole system");
+	CHECK (get_vm_event_cnt (VMSTAT_EVENT_CNT, false) == -1,
+			"get_vm_event_cnt rejects a bad event");
+	CHECK (!vmstat (2, &all), "vmstat rejects a bad argument");
+}
@@ -0,0 +1,26 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(vmstat) begin
+(vmstat) vmstat
+(vmstat) vmstat
+(vmstat) reads of untouched pages counted as zero-page faults
+(vmstat) and as minor faults
+(vmstat) create "counted"
+(vmstat) open "counted"
+(vmstat) mmap
+(vmstat) vmstat
+(vmstat) vmstat
+(vmstat) reads of a file mapping counted as major faults
+(vmstat) and as file reads
+(vmstat) faults add up
+(vmstat) vmstat for the whole system
+(vmstat) get_vm_event_cnt for the process
+(vmstat) get_vm_event_cnt for the whole system
+(vmstat) get_vm_event_cnt rejects a bad event
+(vmstat) vmstat rejects a bad argument
+(vmstat) end
+EOF
+pass;
@@ -0,0 +1,48 @@
+/* Checks the working-set estimate reported by memstat().  While the
+   process keeps touching BIG_PAGES pages its working set covers them;
+   once it touches only one of them, the others leave the working set
+   after a few samples but stay resident. */
+
+#include <stdbool.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define BIG_PAGES 64
+#define MAX_ROUNDS (1 << 22)
+
+static char buf[BIG_PAGES * PAGE_SIZE];
+
+/* Touches the first CNT pages of BUF over and over until the working
+   set in *MS is at least BIG_PAGES if GROW, or below it if not. */
+static void
+touch_until (size_t cnt, bool grow, struct memstat *ms)
+{
+	size_t round, i;
+
+	for (round = 0; round < MAX_ROUNDS; round++) {
+		for (i = 0; i < cnt; i++)
+			((volatile char *) buf)[i * PAGE_SIZE]++;
+		if (!memstat (ms))
+			fail ("memstat failed");
+		if (grow ? ms->wss >= BIG_PAGES : ms->wss < BIG_PAGES)
+			return;
+	}
+	fail ("working set stayed at %zu pages", ms->wss);
+}
+
+void
+test_main (void)
+{
+	struct memstat ms;
+
+	touch_until (BIG_PAGES, true, &ms);
+	msg ("working set covers touched pages");
+	CHECK (ms.wss_peak >= ms.wss, "peak covers working set");
+	CHECK (ms.idle_samples == 0, "not idle while touching pages");
+
+	touch_until (1, false, &ms);
+	msg ("untouched pages leave the working set");
+	CHECK (ms.rss >= BIG_PAGES, "untouched pages stay resident");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(wss-sample) begin
+(wss-sample) working set covers touched pages
+(wss-sample) peak covers working set
+(wss-sample) not idle while touching pages
+(wss-sample) untouched pages leave the working set
+(wss-sample) untouched pages stay resident
+(wss-sample) end
+EOF
+pass;
@@ -0,0 +1,36 @@
+/* Reads every page of a large untouched array, which must not take
+   a frame per page, then writes some of the pages and checks that
+   only those change. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 256
+#define SLACK 16
+
+static char buf[PAGE_COUNT * PAGE_SIZE];
+
+void
+test_main (void)
+{
+	struct memstat before, after;
+	size_t i;
+	int sum = 0;
+
+	CHECK (memstat (&before), "memstat");
+	for (i = 0; i < PAGE_COUNT; i++)
+		sum += buf[i * PAGE_SIZE] + buf[i * PAGE_SIZE + PAGE_SIZE - 1];
+	CHECK (sum == 0, "untouched pages read as zeros");
+	CHECK (memstat (&after), "memstat");
+	CHECK (after.user_free + SLACK >= before.user_free,
+			"reading untouched pages takes no frames");
+
+	for (i = 0; i < PAGE_COUNT; i += 8)
+		buf[i * PAGE_SIZE + 1] = 1;
+	for (i = 0; i < PAGE_COUNT; i++)
+		if (buf[i * PAGE_SIZE + 1] != (i % 8 == 0))
+			fail ("page %zu has the wrong contents", i);
+	msg ("written pages are private");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(zero-read) begin
+(zero-read) memstat
+(zero-read) untouched pages read as zeros
+(zero-read) memstat
+(zero-read) reading untouched pages takes no frames
+(zero-read) written pages are private
+(zero-read) end
+EOF
+pass;
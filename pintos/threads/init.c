@@ -18,6 +18,7 @@
 #include "threads/loader.h"
 #include "threads/malloc.h"
 #include "threads/mmu.h"
+#include "threads/mtrace.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
 #include "threads/thread.h"
@@ -84,6 +85,7 @@ main (void) {
 
 	/* Initialize memory system. */
 	mem_end = palloc_init ();
+	mtrace_init ();
 	malloc_init ();
 	paging_init (mem_end);
 
@@ -155,7 +157,7 @@ paging_init (uint64_t mem_end) {
 	for (uint64_t pa = 0; pa < mem_end; pa += PGSIZE) {
 		uint64_t va = (uint64_t) ptov(pa);
 
-		perm = PTE_P | PTE_W;
+		perm = PTE_P | PTE_W | PTE_G;
 		if ((uint64_t) &start <= va && va < (uint64_t) &_end_kernel_text)
 			perm &= ~PTE_W;
 
@@ -165,6 +167,7 @@ paging_init (uint64_t mem_end) {
 
 	// reload cr3
 	pml4_activate(0);
+	tlb_init ();
 }
 
 /* Breaks the kernel command line into words and returns them as
@@ -221,11 +224,52 @@ parse_options (char **argv) {
 			random_init (atoi (value));
 		else if (!strcmp (name, "-mlfqs"))
 			thread_mlfqs = true;
+		else if (!strcmp (name, "-mtrace"))
+			mtrace_enabled = true;
 #ifdef USERPROG
 		else if (!strcmp (name, "-ul"))
 			user_page_limit = atoi (value);
 		else if (!strcmp (name, "-threads-tests"))
 			thread_tests = true;
+#endif
+#ifdef VM
+		else if (!strcmp (name, "-no-kswapd"))
+			kswapd_enabled = false;
+		else if (!strcmp (name, "-no-reaper"))
+			reap_enabled = false;
+		else if (!strcmp (name, "-fault-around")) {
+			fault_around_pages = atoi (value);
+			if (fault_around_pages < 1 || fault_around_pages > FAULT_AROUND_MAX)
+				PANIC ("-fault-around must be between 1 and %d", FAULT_AROUND_MAX);
+		}
+		else if (!strcmp (name, "-spt")) {
+			if (value != NULL && !strcmp (value, "radix"))
+				spt_radix = true;
+			else if (value == NULL || strcmp (value, "hash"))
+				PANIC ("-spt must be hash or radix");
+		}
+		else if (!strcmp (name, "-zswap"))
+			zswap_max_pages = atoi (value);
+		else if (!strcmp (name, "-ksm"))
+			ksm_pages_to_scan = atoi (value);
+		else if (!strcmp (name, "-ksm-sleep"))
+			ksm_sleep_ms = atoi (value);
+		else if (!strcmp (name, "-wss-interval"))
+			wss_interval_ms = atoi (value);
+		else if (!strcmp (name, "-wss-window")) {
+			wss_window = atoi (value);
+			if (wss_window < 1 || wss_window > UINT8_MAX)
+				PANIC ("-wss-window must be between 1 and %d", UINT8_MAX);
+		}
+		else if (!strcmp (name, "-no-trim"))
+			wss_trim_enabled = false;
+		else if (!strcmp (name, "-mlock-limit"))
+			mlock_limit = atoi (value);
+		else if (!strcmp (name, "-stack-limit")) {
+			stack_limit = atoi (value);
+			if (stack_limit < 1 || stack_limit >= USER_STACK / PGSIZE)
+				PANIC ("-stack-limit must be between 1 and %d", (int) (USER_STACK / PGSIZE) - 1);
+		}
 #endif
 		else
 			PANIC ("unknown option `%s' (use -h for help)", name);
@@ -245,6 +289,10 @@ run_task (char **argv) {
 		run_test (task);
 	} else {
 		process_wait (process_create_initd (task));
+#ifdef VM
+		/* 통계와 누수 보고가 정리를 마친 뒤의 메모리를 보도록 */
+		reap_drain ();
+#endif
 	}
 #else
 	run_test (task);
@@ -326,8 +374,23 @@ usage (void) {
 			"  -f                 Format file system disk during startup.\n"
 			"  -rs=SEED           Set random number seed to SEED.\n"
 			"  -mlfqs             Use multi-level feedback queue scheduler.\n"
+			"  -mtrace            Trace allocations, report leaks at power off.\n"
 #ifdef USERPROG
 			"  -ul=COUNT          Limit user memory to COUNT pages.\n"
+#endif
+#ifdef VM
+			"  -no-kswapd         Evict pages only from the fault path.\n"
+			"  -no-reaper         Free an exiting process's memory before wait() returns.\n"
+			"  -fault-around=N    Map up to N file pages per fault (1 disables).\n"
+			"  -spt=hash|radix    Keep page tables in a hash (default) or radix tree.\n"
+			"  -zswap=N           Keep up to N pages of compressed swap in memory (0 disables).\n"
+			"  -ksm=N             Scan N frames per pass for identical pages (0 disables).\n"
+			"  -ksm-sleep=MS      Wait MS milliseconds between same-page scans.\n"
+			"  -wss-interval=MS   Sample working sets every MS milliseconds (0 disables).\n"
+			"  -wss-window=N      Count pages referenced in the last N samples as working set.\n"
+			"  -no-trim           Do not swap out cold pages of idle processes early.\n"
+			"  -mlock-limit=N     Let each process lock at most N pages with mlock().\n"
+			"  -stack-limit=N     Let each process's stack grow to at most N pages.\n"
 #endif
 			);
 	power_off ();
@@ -359,7 +422,13 @@ print_stats (void) {
 #endif
 	console_print_stats ();
 	kbd_print_stats ();
+	tlb_print_stats ();
+	palloc_print_stats ();
 #ifdef USERPROG
 	exception_print_stats ();
 #endif
+#ifdef VM
+	vm_print_stats ();
+#endif
+	mtrace_dump ();
 }
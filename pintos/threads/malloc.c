@@ -5,6 +5,8 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/interrupt.h"
+#include "threads/mtrace.h"
 #include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -32,7 +34,27 @@
    because they're too big to fit in a single page with a
    descriptor.  We handle those by allocating contiguous pages
    with the page allocator and sticking the allocation size at
-   the beginning of the allocated block's arena header. */
+   the beginning of the allocated block's arena header.
+
+   In front of each descriptor's free list sits a "magazine", a
+   small stack of free blocks that malloc() and free() use
+   without taking the descriptor's lock.  An empty magazine is
+   refilled with a batch of blocks from the free list, and a full
+   one is flushed back a batch at a time, so the lock is taken
+   once per batch instead of once per call.  Blocks in a magazine
+   count as in use in their arenas.  Pintos runs on a single CPU,
+   so the per-CPU magazine only needs interrupts turned off. */
+
+/* Largest magazine capacity. */
+#define MAG_SIZE 32
+
+/* Magazine. */
+struct magazine {
+	size_t cnt;                 /* Number of blocks in ROUNDS. */
+	size_t size;                /* Capacity, at most MAG_SIZE. */
+	size_t batch;               /* Blocks moved per refill or flush. */
+	struct block *rounds[MAG_SIZE];
+};
 
 /* Descriptor. */
 struct desc {
@@ -40,6 +62,7 @@ struct desc {
 	size_t blocks_per_arena;    /* Number of blocks in an arena. */
 	struct list free_list;      /* List of free blocks. */
 	struct lock lock;           /* Lock. */
+	struct magazine mag;        /* Per-CPU cache of free blocks. */
 };
 
 /* Magic number for detecting arena corruption. */
@@ -63,6 +86,15 @@ static size_t desc_cnt;         /* Number of descriptors. */
 
 static struct arena *block_to_arena (struct block *);
 static struct block *arena_to_block (struct arena *, size_t idx);
+static void *do_malloc (size_t);
+static bool release_block (struct desc *, struct block *);
+static size_t malloc_shrink (size_t target);
+
+/* Gives cached arenas back to the kernel pool under pressure. */
+static struct shrinker malloc_shrinker = {
+	.name = "malloc",
+	.shrink = malloc_shrink,
+};
 
 /* Initializes the malloc() descriptors. */
 void
@@ -76,16 +108,34 @@ malloc_init (void) {
 		d->blocks_per_arena = (PGSIZE - sizeof (struct arena)) / block_size;
 		list_init (&d->free_list);
 		lock_init (&d->lock);
+
+		/* Don't let a magazine pin down much more than an arena's
+		   worth of blocks. */
+		d->mag.cnt = 0;
+		d->mag.size = d->blocks_per_arena < MAG_SIZE
+			? d->blocks_per_arena : MAG_SIZE;
+		d->mag.batch = DIV_ROUND_UP (d->mag.size, 2);
 	}
+
+	palloc_register_shrinker (0, &malloc_shrinker);
 }
 
 /* Obtains and returns a new block of at least SIZE bytes.
    Returns a null pointer if memory is not available. */
 void *
 malloc (size_t size) {
+	void *p = do_malloc (size);
+	mtrace_alloc (p, size, __builtin_return_address (0));
+	return p;
+}
+
+/* Does the work of malloc(), without tracing. */
+static void *
+do_malloc (size_t size) {
 	struct desc *d;
 	struct block *b;
 	struct arena *a;
+	enum intr_level old_level;
 
 	/* A null pointer satisfies a request for 0 bytes. */
 	if (size == 0)
@@ -100,7 +150,7 @@ malloc (size_t size) {
 		/* SIZE is too big for any descriptor.
 		   Allocate enough pages to hold SIZE plus an arena. */
 		size_t page_cnt = DIV_ROUND_UP (size + sizeof *a, PGSIZE);
-		a = palloc_get_multiple (0, page_cnt);
+		a = palloc_get_multiple (PAL_NOTRACE, page_cnt);
 		if (a == NULL)
 			return NULL;
 
@@ -112,6 +162,15 @@ malloc (size_t size) {
 		return a + 1;
 	}
 
+	/* Try the magazine first. */
+	old_level = intr_disable ();
+	if (d->mag.cnt > 0) {
+		b = d->mag.rounds[--d->mag.cnt];
+		intr_set_level (old_level);
+		return b;
+	}
+	intr_set_level (old_level);
+
 	lock_acquire (&d->lock);
 
 	/* If the free list is empty, create a new arena. */
@@ -119,7 +178,7 @@ malloc (size_t size) {
 		size_t i;
 
 		/* Allocate a page. */
-		a = palloc_get_page (0);
+		a = palloc_get_page (PAL_NOTRACE);
 		if (a == NULL) {
 			lock_release (&d->lock);
 			return NULL;
@@ -139,6 +198,17 @@ malloc (size_t size) {
 	b = list_entry (list_pop_front (&d->free_list), struct block, free_elem);
 	a = block_to_arena (b);
 	a->free_cnt--;
+
+	/* Refill the magazine while we hold the lock. */
+	old_level = intr_disable ();
+	while (d->mag.cnt < d->mag.batch && !list_empty (&d->free_list)) {
+		struct block *extra = list_entry (list_pop_front (&d->free_list),
+				struct block, free_elem);
+		block_to_arena (extra)->free_cnt--;
+		d->mag.rounds[d->mag.cnt++] = extra;
+	}
+	intr_set_level (old_level);
+
 	lock_release (&d->lock);
 	return b;
 }
@@ -156,9 +226,10 @@ calloc (size_t a, size_t b) {
 		return NULL;
 
 	/* Allocate and zero memory. */
-	p = malloc (size);
+	p = do_malloc (size);
 	if (p != NULL)
 		memset (p, 0, size);
+	mtrace_alloc (p, size, __builtin_return_address (0));
 
 	return p;
 }
@@ -185,7 +256,8 @@ realloc (void *old_block, size_t new_size) {
 		free (old_block);
 		return NULL;
 	} else {
-		void *new_block = malloc (new_size);
+		void *new_block = do_malloc (new_size);
+		mtrace_alloc (new_block, new_size, __builtin_return_address (0));
 		if (old_block != NULL && new_block != NULL) {
 			size_t old_size = block_size (old_block);
 			size_t min_size = new_size < old_size ? new_size : old_size;
@@ -200,6 +272,7 @@ realloc (void *old_block, size_t new_size) {
    malloc(), calloc(), or realloc(). */
 void
 free (void *p) {
+	mtrace_free (p);
 	if (p != NULL) {
 		struct block *b = p;
 		struct arena *a = block_to_arena (b);
@@ -213,23 +286,30 @@ free (void *p) {
 			memset (b, 0xcc, d->block_size);
 #endif
 
-			lock_acquire (&d->lock);
-
-			/* Add block to free list. */
-			list_push_front (&d->free_list, &b->free_elem);
+			struct block *batch[DIV_ROUND_UP (MAG_SIZE, 2)];
+			enum intr_level old_level;
+			size_t i, batch_cnt;
 
-			/* If the arena is now entirely unused, free it. */
-			if (++a->free_cnt >= d->blocks_per_arena) {
-				size_t i;
-
-				ASSERT (a->free_cnt == d->blocks_per_arena);
-				for (i = 0; i < d->blocks_per_arena; i++) {
-					struct block *b = arena_to_block (a, i);
-					list_remove (&b->free_elem);
-				}
-				palloc_free_page (a);
+			/* Put the block in the magazine if there is room. */
+			old_level = intr_disable ();
+			if (d->mag.cnt < d->mag.size) {
+				d->mag.rounds[d->mag.cnt++] = b;
+				intr_set_level (old_level);
+				return;
 			}
 
+			/* Otherwise take a batch out of the magazine and return
+			   it, along with B, to the free list. */
+			batch_cnt = d->mag.batch;
+			d->mag.cnt -= batch_cnt;
+			memcpy (batch, d->mag.rounds + d->mag.cnt,
+					batch_cnt * sizeof *batch);
+			intr_set_level (old_level);
+
+			lock_acquire (&d->lock);
+			release_block (d, b);
+			for (i = 0; i < batch_cnt; i++)
+				release_block (d, batch[i]);
 			lock_release (&d->lock);
 		} else {
 			/* It's a big block.  Free its pages. */
@@ -239,6 +319,63 @@ free (void *p) {
 	}
 }
 
+/* Adds block B to D's free list, freeing its arena if that
+   leaves the arena entirely unused.  Returns true if the arena
+   was freed.  D's lock must be held. */
+static bool
+release_block (struct desc *d, struct block *b) {
+	struct arena *a = block_to_arena (b);
+
+	ASSERT (lock_held_by_current_thread (&d->lock));
+
+	/* Add block to free list. */
+	list_push_front (&d->free_list, &b->free_elem);
+
+	/* If the arena is now entirely unused, free it. */
+	if (++a->free_cnt >= d->blocks_per_arena) {
+		size_t i;
+
+		ASSERT (a->free_cnt == d->blocks_per_arena);
+		for (i = 0; i < d->blocks_per_arena; i++) {
+			struct block *b = arena_to_block (a, i);
+			list_remove (&b->free_elem);
+		}
+		palloc_free_page (a);
+		return true;
+	}
+	return false;
+}
+
+/* Shrinker callback.  Empties every magazine whose descriptor
+   lock is free, so that arenas kept alive only by cached blocks
+   go back to the page allocator.  Descriptors whose lock is busy
+   are skipped; the caller may be the one holding it.  Returns the
+   number of pages freed. */
+static size_t
+malloc_shrink (size_t target UNUSED) {
+	struct desc *d;
+	size_t freed = 0;
+
+	for (d = descs; d < descs + desc_cnt; d++) {
+		if (lock_held_by_current_thread (&d->lock)
+				|| !lock_try_acquire (&d->lock))
+			continue;
+
+		for (;;) {
+			enum intr_level old_level = intr_disable ();
+			struct block *b = d->mag.cnt > 0 ? d->mag.rounds[--d->mag.cnt] : NULL;
+			intr_set_level (old_level);
+
+			if (b == NULL)
+				break;
+			if (release_block (d, b))
+				freed++;
+		}
+		lock_release (&d->lock);
+	}
+	return freed;
+}
+
 /* Returns the arena that block B is inside. */
 static struct arena *
 block_to_arena (struct block *b) {
@@ -1,7 +1,9 @@
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
@@ -155,9 +157,10 @@ pml4_for_each (uint64_t *pml4, pte_for_each_func *func, void *aux) {
 	return true;
 }
 
+/* Frees page table PT and, if FREE_PAGES, the pages it maps. */
 static void
-pt_destroy (uint64_t *pt) {
-	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
+pt_destroy (uint64_t *pt, bool free_pages) {
+	for (unsigned i = 0; free_pages && i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pte = ptov((uint64_t *) pt[i]);
 		if (((uint64_t) pte) & PTE_P)
 			palloc_free_page ((void *) PTE_ADDR (pte));
@@ -166,28 +169,27 @@ pt_destroy (uint64_t *pt) {
 }
 
 static void
-pgdir_destroy (uint64_t *pdp) {
+pgdir_destroy (uint64_t *pdp, bool free_pages) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pte = ptov((uint64_t *) pdp[i]);
 		if (((uint64_t) pte) & PTE_P)
-			pt_destroy (PTE_ADDR (pte));
+			pt_destroy (PTE_ADDR (pte), free_pages);
 	}
 	palloc_free_page ((void *) pdp);
 }
 
 static void
-pdpe_destroy (uint64_t *pdpe) {
+pdpe_destroy (uint64_t *pdpe, bool free_pages) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pde = ptov((uint64_t *) pdpe[i]);
 		if (((uint64_t) pde) & PTE_P)
-			pgdir_destroy ((void *) PTE_ADDR (pde));
+			pgdir_destroy ((void *) PTE_ADDR (pde), free_pages);
 	}
 	palloc_free_page ((void *) pdpe);
 }
 
-/* Destroys pml4e, freeing all the pages it references. */
-void
-pml4_destroy (uint64_t *pml4) {
+static void
+destroy_tables (uint64_t *pml4, bool free_pages) {
 	if (pml4 == NULL)
 		return;
 	ASSERT (pml4 != base_pml4);
@@ -195,15 +197,192 @@ pml4_destroy (uint64_t *pml4) {
 	/* if PML4 (vaddr) >= 1, it's kernel space by define. */
 	uint64_t *pdpe = ptov ((uint64_t *) pml4[0]);
 	if (((uint64_t) pdpe) & PTE_P)
-		pdpe_destroy ((void *) PTE_ADDR (pdpe));
+		pdpe_destroy ((void *) PTE_ADDR (pdpe), free_pages);
 	palloc_free_page ((void *) pml4);
 }
 
+/* Destroys pml4e, freeing all the pages it references. */
+void
+pml4_destroy (uint64_t *pml4) {
+	destroy_tables (pml4, true);
+}
+
+/* Destroys pml4e, freeing only its page tables.  For an address
+ * space whose mapped pages have already been given back by their
+ * owner, e.g. the frames of the VM system. */
+void
+pml4_destroy_tables (uint64_t *pml4) {
+	destroy_tables (pml4, false);
+}
+
+/* Returns the number of pages that PML4 uses for page tables,
+ * counting PML4 itself but not the kernel's shared tables. */
+size_t
+pml4_table_cnt (uint64_t *pml4) {
+	size_t cnt = 1;
+
+	if (pml4 == NULL)
+		return 0;
+
+	uint64_t *pdpe = ptov ((uint64_t *) pml4[0]);
+	if (!(((uint64_t) pdpe) & PTE_P))
+		return cnt;
+	pdpe = (uint64_t *) PTE_ADDR (pdpe);
+	cnt++;
+
+	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
+		uint64_t *pde = ptov ((uint64_t *) pdpe[i]);
+		if (!(((uint64_t) pde) & PTE_P))
+			continue;
+		pde = (uint64_t *) PTE_ADDR (pde);
+		cnt++;
+
+		for (unsigned j = 0; j < PGSIZE / sizeof(uint64_t *); j++)
+			if (pde[j] & PTE_P)
+				cnt++;
+	}
+	return cnt;
+}
+
+/* TLB tagging.
+ *
+ * When the CPU supports PCIDs, each user pml4 is tagged with a 12-bit
+ * process-context ID, so loading its CR3 keeps the TLB entries of the
+ * address spaces that ran before it.  IDs are handed out from a
+ * counter; when the counter runs out a new generation starts and every
+ * pml4 picks up a fresh ID on its next activation.  An ID is flushed
+ * at the moment it is handed out, so entries left behind by its
+ * previous owner can never be hit.
+ *
+ * The tag of a pml4 lives in slot PML4_TAG_IDX of the pml4 page
+ * itself.  That slot maps nothing in the kernel and its present bit is
+ * always clear, so the MMU ignores it.  A zero tag means "no ID".  PCID
+ * 0 is reserved for base_pml4, which never holds user mappings.
+ *
+ * Independently of PCIDs, kernel mappings are marked global (PTE_G) by
+ * paging_init() so they survive every CR3 load. */
+
+#define CR4_PGE (1 << 7)            /* Enable global pages. */
+#define CR4_PCIDE (1 << 17)         /* Enable process-context IDs. */
+#define CR3_NOFLUSH (1ULL << 63)    /* Keep TLB entries of the new PCID. */
+
+#define CPUID_1_ECX_PCID (1 << 17)
+#define CPUID_1_EDX_PGE (1 << 13)
+#define CPUID_7_EBX_INVPCID (1 << 10)
+
+#define PCID_BITS 12
+#define PCID_CNT (1 << PCID_BITS)
+#define PML4_TAG_IDX 511
+
+#define tag_pcid(TAG) ((TAG) & (PCID_CNT - 1))
+#define tag_gen(TAG) ((TAG) >> PCID_BITS)
+
+static bool pcid_enabled;           /* CR4.PCIDE set? */
+static bool invpcid_enabled;        /* INVPCID available? */
+static uint64_t pcid_gen = 1;       /* Current generation. */
+static uint64_t pcid_next = 1;      /* Next free PCID in this generation. */
+
+/* Statistics. */
+static long long tlb_keep_cnt;      /* # of activations that kept the TLB. */
+static long long tlb_flush_cnt;     /* # of activations that flushed. */
+
+static inline uint64_t
+pml4_get_tag (uint64_t *pml4) {
+	return pml4[PML4_TAG_IDX] >> 1;
+}
+
+static inline void
+pml4_set_tag (uint64_t *pml4, uint64_t tag) {
+	pml4[PML4_TAG_IDX] = tag << 1;
+}
+
+/* Returns true if PML4 is the page table the CPU is using. */
+static inline bool
+pml4_is_active (uint64_t *pml4) {
+	return PTE_ADDR (rcr3 ()) == vtop (pml4);
+}
+
+/* Enables global pages and, if the CPU has them, PCIDs.
+ * Must be called with base_pml4 active, i.e. with PCID 0. */
+void
+tlb_init (void) {
+	uint32_t regs[4];
+
+	ASSERT (pml4_is_active (base_pml4));
+	ASSERT (base_pml4[PML4_TAG_IDX] == 0);
+
+	cpuid (1, 0, regs);
+	if (regs[3] & CPUID_1_EDX_PGE)
+		lcr4 (rcr4 () | CR4_PGE);
+	if (regs[2] & CPUID_1_ECX_PCID) {
+		lcr4 (rcr4 () | CR4_PCIDE);
+		pcid_enabled = true;
+
+		cpuid (0, 0, regs);
+		if (regs[0] >= 7) {
+			cpuid (7, 0, regs);
+			invpcid_enabled = (regs[1] & CPUID_7_EBX_INVPCID) != 0;
+		}
+	}
+}
+
+/* Prints TLB statistics. */
+void
+tlb_print_stats (void) {
+	printf ("TLB: %s, %lld tagged switches, %lld flushing switches\n",
+			pcid_enabled ? "pcid" : "no pcid", tlb_keep_cnt, tlb_flush_cnt);
+}
+
+/* Drops the TLB entry for VA in PML4, which need not be active. */
+static void
+tlb_invalidate (uint64_t *pml4, const void *va) {
+	enum intr_level old_level = intr_disable ();
+
+	if (pml4_is_active (pml4))
+		invlpg ((uint64_t) va);
+	else if (pcid_enabled) {
+		/* Entries of an inactive pml4 may still be cached under
+		 * its PCID.  Without INVPCID, forget the PCID instead, so
+		 * that the next activation flushes a fresh one. */
+		uint64_t tag = pml4_get_tag (pml4);
+		if (tag_gen (tag) == pcid_gen) {
+			if (invpcid_enabled)
+				invpcid (tag_pcid (tag), (uint64_t) va);
+			else
+				pml4_set_tag (pml4, 0);
+		}
+	}
+
+	intr_set_level (old_level);
+}
+
 /* Loads page directory PD into the CPU's page directory base
- * register. */
+ * register.  With PCIDs, entries cached for PML4 by an earlier
+ * activation are kept. */
 void
 pml4_activate (uint64_t *pml4) {
-	lcr3 (vtop (pml4 ? pml4 : base_pml4));
+	if (pml4 == NULL || !pcid_enabled) {
+		lcr3 (vtop (pml4 ? pml4 : base_pml4));
+		tlb_flush_cnt += pml4 != NULL;
+		return;
+	}
+
+	enum intr_level old_level = intr_disable ();
+	uint64_t tag = pml4_get_tag (pml4);
+	if (tag_gen (tag) == pcid_gen) {
+		lcr3 (vtop (pml4) | tag_pcid (tag) | CR3_NOFLUSH);
+		tlb_keep_cnt++;
+	} else {
+		if (pcid_next == PCID_CNT) {
+			pcid_gen++;
+			pcid_next = 1;
+		}
+		tag = (pcid_gen << PCID_BITS) | pcid_next++;
+		pml4_set_tag (pml4, tag);
+		lcr3 (vtop (pml4) | tag_pcid (tag));
+		tlb_flush_cnt++;
+	}
+	intr_set_level (old_level);
 }
 
 /* Looks up the physical address that corresponds to user virtual
@@ -238,8 +417,12 @@ pml4_set_page (uint64_t *pml4, void *upage, void *kpage, bool rw) {
 
 	uint64_t *pte = pml4e_walk (pml4, (uint64_t) upage, 1);
 
-	if (pte)
+	if (pte) {
+		bool was_present = (*pte & PTE_P) != 0;
 		*pte = vtop (kpage) | PTE_P | (rw ? PTE_W : 0) | PTE_U;
+		if (was_present)
+			tlb_invalidate (pml4, upage);
+	}
 	return pte != NULL;
 }
 
@@ -257,8 +440,7 @@ pml4_clear_page (uint64_t *pml4, void *upage) {
 
 	if (pte != NULL && (*pte & PTE_P) != 0) {
 		*pte &= ~PTE_P;
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) upage);
+		tlb_invalidate (pml4, upage);
 	}
 }
 
@@ -281,10 +463,52 @@ pml4_set_dirty (uint64_t *pml4, const void *vpage, bool dirty) {
 		if (dirty)
 			*pte |= PTE_D;
 		else
-			*pte &= ~(uint32_t) PTE_D;
+			*pte &= ~(uint64_t) PTE_D;
+
+		tlb_invalidate (pml4, vpage);
+	}
+}
+
+/* Clears the dirty bit in the PTE for virtual page VPAGE in PML4
+ * and returns whether it was set.  Unlike pml4_set_dirty(), leaves
+ * the TLB alone, so that a caller clearing many pages can flush once
+ * with pml4_flush_tlb().  Until then a write through a cached entry
+ * may not set the bit again. */
+bool
+pml4_test_clear_dirty (uint64_t *pml4, const void *vpage) {
+	uint64_t *pte = pml4e_walk (pml4, (uint64_t) vpage, false);
+
+	if (pte == NULL || (*pte & PTE_D) == 0)
+		return false;
+	*pte &= ~(uint64_t) PTE_D;
+	return true;
+}
+
+/* Drops every TLB entry for the user mappings of PML4, which need
+ * not be active. */
+void
+pml4_flush_tlb (uint64_t *pml4) {
+	enum intr_level old_level = intr_disable ();
+
+	if (pml4_is_active (pml4))
+		lcr3 (vtop (pml4) | (pcid_enabled ? tag_pcid (pml4_get_tag (pml4)) : 0));
+	else if (pcid_enabled)
+		pml4_set_tag (pml4, 0);
+	intr_set_level (old_level);
+}
+
+/* Sets the writable bit to WRITABLE in the PTE for virtual page
+ * VPAGE in PML4, keeping the mapping and its other bits. */
+void
+pml4_set_writable (uint64_t *pml4, const void *vpage, bool writable) {
+	uint64_t *pte = pml4e_walk (pml4, (uint64_t) vpage, false);
+	if (pte) {
+		if (writable)
+			*pte |= PTE_W;
+		else
+			*pte &= ~(uint64_t) PTE_W;
 
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) vpage);
+		tlb_invalidate (pml4, vpage);
 	}
 }
 
@@ -307,9 +531,8 @@ pml4_set_accessed (uint64_t *pml4, const void *vpage, bool accessed) {
 		if (accessed)
 			*pte |= PTE_A;
 		else
-			*pte &= ~(uint32_t) PTE_A;
+			*pte &= ~(uint64_t) PTE_A;
 
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) vpage);
+		tlb_invalidate (pml4, vpage);
 	}
 }
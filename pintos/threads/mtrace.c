@@ -0,0 +1,181 @@
+#include "threads/mtrace.h"
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* Allocation tracing.
+
+   With -mtrace on the kernel command line, every block handed out
+   by malloc() and every page run handed out by palloc is recorded
+   along with the address it was requested from, its size, and the
+   thread that requested it.  Freeing it drops the record.  At
+   power off, whatever is left is printed grouped by call site,
+   largest first, so that leaks stand out; the addresses can be fed
+   to utils/backtrace to turn them into function names.
+
+   Records live in a fixed open-addressing hash table keyed by
+   block address, with linear probing and backward-shift deletion,
+   so tracing costs one short probe per allocation and per free
+   and never allocates memory itself.  When the table is 3/4 full,
+   new allocations are counted but not recorded. */
+
+/* One outstanding allocation. */
+struct record {
+	void *ptr;                  /* Block address, null if slot empty. */
+	void *site;                 /* Return address of the allocator call. */
+	uint32_t size;              /* Size in bytes. */
+	tid_t tid;                  /* Requesting thread. */
+};
+
+#define SLOT_BITS 12
+#define SLOT_CNT (1 << SLOT_BITS)
+#define SLOT_MASK (SLOT_CNT - 1)
+#define TABLE_PAGES DIV_ROUND_UP (SLOT_CNT * sizeof (struct record), PGSIZE)
+
+bool mtrace_enabled;
+
+static struct record *table;    /* SLOT_CNT records. */
+static size_t record_cnt;       /* Slots in use. */
+static long long dropped_cnt;   /* Allocations not recorded. */
+
+/* Allocates the record table.  Does nothing unless tracing was
+   requested, or if the table already exists. */
+void
+mtrace_init (void) {
+	if (!mtrace_enabled || table != NULL)
+		return;
+
+	table = palloc_get_multiple (PAL_ZERO | PAL_NOTRACE, TABLE_PAGES);
+	if (table == NULL) {
+		printf ("mtrace: no memory for the record table, tracing disabled\n");
+		mtrace_enabled = false;
+	}
+}
+
+/* Returns the home slot of PTR. */
+static size_t
+home_slot (const void *ptr) {
+	return ((uint64_t) ptr >> 4) * 0x9e3779b97f4a7c15ULL >> (64 - SLOT_BITS);
+}
+
+/* Records that SIZE bytes at PTR were allocated from SITE. */
+void
+mtrace_alloc (void *ptr, size_t size, void *site) {
+	enum intr_level old_level;
+	size_t i;
+
+	if (!mtrace_enabled || table == NULL || ptr == NULL)
+		return;
+
+	old_level = intr_disable ();
+	if (record_cnt >= SLOT_CNT / 4 * 3)
+		dropped_cnt++;
+	else {
+		for (i = home_slot (ptr); table[i].ptr != NULL; i = (i + 1) & SLOT_MASK)
+			continue;
+		table[i].ptr = ptr;
+		table[i].site = site;
+		table[i].size = size;
+		table[i].tid = thread_current ()->tid;
+		record_cnt++;
+	}
+	intr_set_level (old_level);
+}
+
+/* Drops the record for PTR, if any. */
+void
+mtrace_free (void *ptr) {
+	enum intr_level old_level;
+	size_t i, j;
+
+	if (!mtrace_enabled || table == NULL || ptr == NULL)
+		return;
+
+	old_level = intr_disable ();
+	for (i = home_slot (ptr); table[i].ptr != NULL; i = (i + 1) & SLOT_MASK)
+		if (table[i].ptr == ptr)
+			break;
+
+	if (table[i].ptr != NULL) {
+		/* Shift later members of the probe run back into the hole,
+		   unless their home slot lies after the hole. */
+		for (j = (i + 1) & SLOT_MASK; table[j].ptr != NULL;
+				j = (j + 1) & SLOT_MASK) {
+			size_t k = home_slot (table[j].ptr);
+			if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+				continue;
+			table[i] = table[j];
+			i = j;
+		}
+		table[i].ptr = NULL;
+		record_cnt--;
+	}
+	intr_set_level (old_level);
+}
+
+/* Outstanding allocations from one call site. */
+struct site {
+	void *site;
+	size_t cnt;                 /* Number of blocks. */
+	size_t bytes;               /* Total size. */
+	tid_t tid;                  /* Thread of one of the blocks. */
+};
+
+#define MAX_SITES 128
+
+/* Prints the outstanding allocations, grouped by call site. */
+void
+mtrace_dump (void) {
+	static struct site sites[MAX_SITES];
+	size_t site_cnt = 0, other_cnt = 0, total_bytes = 0;
+	enum intr_level old_level;
+	size_t i, j;
+
+	if (!mtrace_enabled || table == NULL)
+		return;
+
+	old_level = intr_disable ();
+	for (i = 0; i < SLOT_CNT; i++) {
+		struct record *r = &table[i];
+		if (r->ptr == NULL)
+			continue;
+
+		total_bytes += r->size;
+		for (j = 0; j < site_cnt; j++)
+			if (sites[j].site == r->site)
+				break;
+		if (j == site_cnt) {
+			if (site_cnt == MAX_SITES) {
+				other_cnt++;
+				continue;
+			}
+			sites[site_cnt++] = (struct site) { r->site, 0, 0, r->tid };
+		}
+		sites[j].cnt++;
+		sites[j].bytes += r->size;
+	}
+	intr_set_level (old_level);
+
+	/* Largest first. */
+	for (i = 1; i < site_cnt; i++) {
+		struct site s = sites[i];
+		for (j = i; j > 0 && sites[j - 1].bytes < s.bytes; j--)
+			sites[j] = sites[j - 1];
+		sites[j] = s;
+	}
+
+	printf ("mtrace: %zu allocations outstanding, %zu bytes, "
+			"%lld not recorded\n", record_cnt, total_bytes, dropped_cnt);
+	for (i = 0; i < site_cnt; i++)
+		printf ("mtrace: %p: %zu blocks, %zu bytes (e.g. thread %d)\n",
+				sites[i].site, sites[i].cnt, sites[i].bytes, sites[i].tid);
+	if (other_cnt > 0)
+		printf ("mtrace: %zu blocks from further sites\n", other_cnt);
+	if (site_cnt > 0)
+		printf ("mtrace: pass these lines to `backtrace' to see the sites.\n");
+}
@@ -8,7 +8,9 @@
 #include <stdio.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
+#include "threads/mtrace.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
 
@@ -24,13 +26,34 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   Each pool counts its free pages and has three watermarks.  When
+   the free count drops below the low watermark, callers that can
+   reclaim (e.g. vm_get_frame()) should run the pool's shrinkers
+   with palloc_shrink() to bring it back up to the high watermark
+   before they resort to eviction.  Falling below the min
+   watermark means reclaim is not keeping up.  Shrinkers are
+   callbacks registered by caches that hold on to pages they could
+   give back, such as malloc's arenas. */
 
 /* A memory pool. */
 struct pool {
 	struct lock lock;               /* Mutual exclusion. */
 	struct bitmap *used_map;        /* Bitmap of free pages. */
 	uint8_t *base;                  /* Base of pool. */
+
+	size_t free_cnt;                /* Number of free pages. */
+	size_t wmark_min;               /* Watermarks, in free pages. */
+	size_t wmark_low;
+	size_t wmark_high;
+	struct list shrinkers;          /* Registered shrinkers. */
+
+	/* Statistics. */
+	long long low_cnt;              /* # of times below wmark_low. */
+	long long min_cnt;              /* # of times below wmark_min. */
+	long long fail_cnt;             /* # of failed allocations. */
+	long long shrunk_cnt;           /* # of pages freed by shrinkers. */
 };
 
 /* Two pools: one for kernel data, one for user pages. */
@@ -42,6 +65,7 @@ static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end);
 
 static bool page_from_pool (const struct pool *, void *page);
+static void init_wmarks (struct pool *);
 
 /* multiboot info */
 struct multiboot_info {
@@ -250,23 +274,45 @@ palloc_init (void) {
 	printf ("\text_mem: 0x%llx ~ 0x%llx (Usable: %'llu kB)\n",
 		  ext_mem.start, ext_mem.end, ext_mem.size / 1024);
 	populate_pools (&base_mem, &ext_mem);
+	init_wmarks (&kernel_pool);
+	init_wmarks (&user_pool);
 	return ext_mem.end;
 }
 
-/* Obtains and returns a group of PAGE_CNT contiguous free pages.
-   If PAL_USER is set, the pages are obtained from the user pool,
-   otherwise from the kernel pool.  If PAL_ZERO is set in FLAGS,
-   then the pages are filled with zeros.  If too few pages are
-   available, returns a null pointer, unless PAL_ASSERT is set in
-   FLAGS, in which case the kernel panics. */
-void *
-palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
+/* Allocates PAGE_CNT pages on behalf of the call at SITE.
+   See palloc_get_multiple(). */
+static void *
+alloc_pages (enum palloc_flags flags, size_t page_cnt, void *site) {
 	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+	enum intr_level old_level;
+	bool shrunk = false;
+	size_t page_idx;
+	void *pages;
 
+retry:
 	lock_acquire (&pool->lock);
-	size_t page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
+	old_level = intr_disable ();
+	page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
+	if (page_idx != BITMAP_ERROR) {
+		size_t old_free = pool->free_cnt;
+		pool->free_cnt -= page_cnt;
+		if (old_free >= pool->wmark_low && pool->free_cnt < pool->wmark_low)
+			pool->low_cnt++;
+		if (old_free >= pool->wmark_min && pool->free_cnt < pool->wmark_min)
+			pool->min_cnt++;
+	} else
+		pool->fail_cnt++;
+	intr_set_level (old_level);
 	lock_release (&pool->lock);
-	void *pages;
+
+	/* Kernel pages have no other source, so let the shrinkers
+	   try to make room once.  User pages are reclaimed by the
+	   caller, which may also evict. */
+	if (page_idx == BITMAP_ERROR && !(flags & PAL_USER) && !shrunk) {
+		shrunk = true;
+		if (palloc_shrink (flags, page_cnt) > 0)
+			goto retry;
+	}
 
 	if (page_idx != BITMAP_ERROR)
 		pages = pool->base + PGSIZE * page_idx;
@@ -275,7 +321,10 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 
 	if (pages) {
 		if (flags & PAL_ZERO)
-			memset (pages, 0, PGSIZE * page_cnt);
+			for (size_t i = 0; i < page_cnt; i++)
+				clear_page (pages + PGSIZE * i);
+		if (!(flags & PAL_NOTRACE))
+			mtrace_alloc (pages, PGSIZE * page_cnt, site);
 	} else {
 		if (flags & PAL_ASSERT)
 			PANIC ("palloc_get: out of pages");
@@ -284,6 +333,17 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 	return pages;
 }
 
+/* Obtains and returns a group of PAGE_CNT contiguous free pages.
+   If PAL_USER is set, the pages are obtained from the user pool,
+   otherwise from the kernel pool.  If PAL_ZERO is set in FLAGS,
+   then the pages are filled with zeros.  If too few pages are
+   available, returns a null pointer, unless PAL_ASSERT is set in
+   FLAGS, in which case the kernel panics. */
+void *
+palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
+	return alloc_pages (flags, page_cnt, __builtin_return_address (0));
+}
+
 /* Obtains a single free page and returns its kernel virtual
    address.
    If PAL_USER is set, the page is obtained from the user pool,
@@ -293,7 +353,7 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
    FLAGS, in which case the kernel panics. */
 void *
 palloc_get_page (enum palloc_flags flags) {
-	return palloc_get_multiple (flags, 1);
+	return alloc_pages (flags, 1, __builtin_return_address (0));
 }
 
 /* Frees the PAGE_CNT pages starting at PAGES. */
@@ -301,6 +361,7 @@ void
 palloc_free_multiple (void *pages, size_t page_cnt) {
 	struct pool *pool;
 	size_t page_idx;
+	enum intr_level old_level;
 
 	ASSERT (pg_ofs (pages) == 0);
 	if (pages == NULL || page_cnt == 0)
@@ -314,12 +375,19 @@ palloc_free_multiple (void *pages, size_t page_cnt) {
 		NOT_REACHED ();
 
 	page_idx = pg_no (pages) - pg_no (pool->base);
+	mtrace_free (pages);
 
 #ifndef NDEBUG
 	memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
+	/* This may run inside the scheduler, so it must not sleep on
+	   the pool lock.  Turning interrupts off keeps the bitmap and
+	   the free count consistent with palloc_get_multiple(). */
+	old_level = intr_disable ();
 	ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
 	bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+	pool->free_cnt += page_cnt;
+	intr_set_level (old_level);
 }
 
 /* Frees the page at PAGE. */
@@ -328,6 +396,137 @@ palloc_free_page (void *page) {
 	palloc_free_multiple (page, 1);
 }
 
+/* Frees the CNT single pages listed in PAGES, which need not be
+   contiguous or even in the same pool.  Interrupts are turned off
+   once for the whole batch instead of once per page, which matters
+   when a whole address space is torn down at once. */
+void
+palloc_free_pages (void **pages, size_t cnt) {
+	enum intr_level old_level;
+	size_t i;
+
+	for (i = 0; i < cnt; i++) {
+		ASSERT (pages[i] != NULL && pg_ofs (pages[i]) == 0);
+		mtrace_free (pages[i]);
+#ifndef NDEBUG
+		memset (pages[i], 0xcc, PGSIZE);
+#endif
+	}
+
+	old_level = intr_disable ();
+	for (i = 0; i < cnt; i++) {
+		struct pool *pool;
+		size_t page_idx;
+
+		if (page_from_pool (&user_pool, pages[i]))
+			pool = &user_pool;
+		else if (page_from_pool (&kernel_pool, pages[i]))
+			pool = &kernel_pool;
+		else
+			NOT_REACHED ();
+
+		page_idx = pg_no (pages[i]) - pg_no (pool->base);
+		ASSERT (bitmap_test (pool->used_map, page_idx));
+		bitmap_reset (pool->used_map, page_idx);
+		pool->free_cnt++;
+	}
+	intr_set_level (old_level);
+}
+
+/* Registers shrinker S with the pool that FLAGS selects. */
+void
+palloc_register_shrinker (enum palloc_flags flags, struct shrinker *s) {
+	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+
+	ASSERT (s != NULL && s->shrink != NULL);
+	list_push_back (&pool->shrinkers, &s->elem);
+}
+
+/* Asks the shrinkers of the pool that FLAGS selects to free up
+   to TARGET pages, in registration order, and returns the number
+   of pages they freed.  Must not be called with a pool lock held. */
+size_t
+palloc_shrink (enum palloc_flags flags, size_t target) {
+	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+	size_t freed = 0;
+	struct list_elem *e;
+	enum intr_level old_level;
+
+	for (e = list_begin (&pool->shrinkers);
+			e != list_end (&pool->shrinkers) && freed < target;
+			e = list_next (e)) {
+		struct shrinker *s = list_entry (e, struct shrinker, elem);
+		size_t cnt = s->shrink (target - freed);
+		s->freed_cnt += cnt;
+		freed += cnt;
+	}
+
+	old_level = intr_disable ();
+	pool->shrunk_cnt += freed;
+	intr_set_level (old_level);
+	return freed;
+}
+
+/* Fills in ST with the page counts of the pool that FLAGS
+   selects. */
+void
+palloc_get_stats (enum palloc_flags flags, struct palloc_stats *st) {
+	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+
+	st->base = pool->base;
+	st->total = bitmap_size (pool->used_map);
+	st->free = pool->free_cnt;
+	st->wmark_min = pool->wmark_min;
+	st->wmark_low = pool->wmark_low;
+	st->wmark_high = pool->wmark_high;
+}
+
+/* Returns the number of free pages in the pool that FLAGS
+   selects.  The answer may be stale by the time it is used. */
+size_t
+palloc_free_cnt (enum palloc_flags flags) {
+	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+	return pool->free_cnt;
+}
+
+/* Prints statistics about one pool. */
+static void
+print_pool_stats (const char *name, struct pool *pool) {
+	struct shrinker *s;
+	struct list_elem *e;
+
+	printf ("%s pool: %zu of %zu pages free, watermarks %zu/%zu/%zu, "
+			"%lld times below low, %lld below min, %lld failures\n",
+			name, pool->free_cnt, bitmap_size (pool->used_map),
+			pool->wmark_min, pool->wmark_low, pool->wmark_high,
+			pool->low_cnt, pool->min_cnt, pool->fail_cnt);
+	for (e = list_begin (&pool->shrinkers); e != list_end (&pool->shrinkers);
+			e = list_next (e)) {
+		s = list_entry (e, struct shrinker, elem);
+		printf ("  shrinker %s: %zu pages freed\n", s->name, s->freed_cnt);
+	}
+}
+
+/* Prints page allocator statistics. */
+void
+palloc_print_stats (void) {
+	print_pool_stats ("Kernel", &kernel_pool);
+	print_pool_stats ("User", &user_pool);
+}
+
+/* Counts the free pages of POOL and sets its watermarks.
+   The min watermark is 1/64 of the pool; low and high are two and
+   three times that, as in other kernels' zone allocators. */
+static void
+init_wmarks (struct pool *p) {
+	size_t page_cnt = bitmap_size (p->used_map);
+
+	p->free_cnt = bitmap_count (p->used_map, 0, page_cnt, false);
+	p->wmark_min = page_cnt / 64 > 2 ? page_cnt / 64 : 2;
+	p->wmark_low = p->wmark_min * 2;
+	p->wmark_high = p->wmark_min * 3;
+}
+
 /* Initializes pool P as starting at START and ending at END */
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
@@ -338,6 +537,7 @@ init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
 	size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (pgcnt), PGSIZE) * PGSIZE;
 
 	lock_init(&p->lock);
+	list_init (&p->shrinkers);
 	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_pages);
 	p->base = (void *) start;
 
@@ -689,6 +689,9 @@ init_thread (struct thread *t, const char *name, int priority) {
 	sema_init(&t->wait_sema, 0);		// 부모 대기
 	sema_init(&t->exit_sema, 0);		// 자식 대기
 	sema_init(&t->fork_sema, 0);
+#ifdef VM
+	sema_init(&t->reap_sema, 0);		// reaper가 주소 공간을 다 정리함
+#endif
 
 
 	list_push_back(&all_list, &t->all_elem);
@@ -900,4 +903,18 @@ get_thread_tid(tid_t tid){
 	}
 	intr_set_level(old_level);
 	return found;
-}
\ No newline at end of file
+}
+
+/* Invoke function 'func' on all threads, passing along 'aux'.
+   This function must be called with interrupts off. */
+void
+thread_foreach (thread_action_func *func, void *aux) {
+	struct list_elem *e;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (e = list_begin (&all_list); e != list_end (&all_list); e = list_next (e)) {
+		struct thread *t = list_entry (e, struct thread, all_elem);
+		func (t, aux);
+	}
+}
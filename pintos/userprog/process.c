@@ -133,7 +133,7 @@ duplicate_pte (uint64_t *pte, void *va, void *aux) {
 	/* 4. TODO: Duplicate parent's page to the new page and
 	 *    TODO: check whether parent's page is writable or not (set WRITABLE
 	 *    TODO: according to the result). */
-	memcpy(newpage, parent_page, PGSIZE);
+	copy_page(newpage, parent_page);
 	writable = is_writable(pte);
 
 	/* 5. Add new page to child's page table at address VA with WRITABLE
@@ -173,6 +173,10 @@ __do_fork (void *aux) {
 	supplemental_page_table_init (&current->spt);
 	if (!supplemental_page_table_copy (&current->spt, &parent->spt))
 		goto error;
+	current->stack_bottom = parent->stack_bottom;
+	current->stack_ahead = parent->stack_ahead;
+	/* 부모가 등록한 구간의 fault를 자식이 처리할 수 있도록 */
+	uffd_fork (current, parent);
 #else
 	if (!pml4_for_each (parent->pml4, duplicate_pte, parent))
 		goto error;
@@ -227,6 +231,11 @@ process_exec (void *f_name) {
 	_if.cs = SEL_UCSEG;
 	_if.eflags = FLAG_IF | FLAG_MBS;
 
+#ifdef VM
+	/* 새 이미지는 이전 이미지의 userfaultfd 문맥을 이어받지 않음.
+	 * 처리 프로세스면 주인의 fault를 더는 다루지 않고, 주인이면 처리 프로세스들에게 끝났음을 알림 */
+	uffd_exit (thread_current ());
+#endif
 	/* We first kill the current context */
 	process_cleanup ();
 
@@ -311,6 +320,18 @@ process_exit (void) {
     palloc_free_multiple(cur->fdt, 3);
 
 	file_close(cur->running);
+
+#ifdef VM
+	/* mmap 구간은 부모가 종료 상태를 받기 전에 파일에 써 둠.
+	 * 나머지 주소 공간은 reaper 스레드가 정리하므로 wait()이 그만큼 빨리 돌아감 */
+	bool reaping = false;
+	/* 이 프로세스를 기다리는 fault나 처리 프로세스를 먼저 깨움 */
+	uffd_exit(cur);
+	if (cur->pml4 != NULL) {
+		spt_unmap_shared(&cur->spt);
+		reaping = reap_submit(cur);
+	}
+#endif
     
     /* 부모 프로세스와의 동기화 */
     if (cur->parent != NULL) {
@@ -318,6 +339,11 @@ process_exit (void) {
         sema_down(&cur->exit_sema);
     }
 
+#ifdef VM
+	/* 페이지의 owner가 이 스레드이므로 reaper가 끝날 때까지 스레드를 남겨 둠 */
+	if (reaping)
+		sema_down(&cur->reap_sema);
+#endif
 	process_cleanup ();
 
     // thread_exit(); // 스레드 종료
@@ -329,7 +355,7 @@ process_cleanup (void) {
 	struct thread *curr = thread_current ();
 
 #ifdef VM
-	 if(!hash_empty(&curr->spt.pages))
+	 if(spt_size(&curr->spt) > 0 || curr->spt.vmas.cnt > 0)
 	{
         supplemental_page_table_kill(&curr->spt);
     }
@@ -349,7 +375,12 @@ process_cleanup (void) {
 		 * that's been freed (and cleared). */
 		curr->pml4 = NULL;
 		pml4_activate (NULL);
+#ifdef VM
+		/* 사용자 페이지는 supplemental_page_table_kill()이 이미 돌려줌 */
+		pml4_destroy_tables (pml4);
+#else
 		pml4_destroy (pml4);
+#endif
 	}
 }
 
@@ -735,22 +766,6 @@ install_page (void *upage, void *kpage, bool writable) {
 /* 여기서부터의 코드는 Project 3 이후에 사용됩니다.
  * 만약 Project 2에만 해당하는 기능을 구현하려면, 위쪽 블록에 작성하세요. */
 
-static bool
-lazy_load_segment (struct page *page, void *aux) {
-    struct container *c = (struct container *)aux;
-    struct file *file = c->file;
-    off_t offsetof = c->offset;
-    size_t page_read_bytes = c->page_read_bytes;
-    size_t page_zero_bytes = PGSIZE - page_read_bytes;
-
-    file_seek(file, offsetof);
-    if (file_read(file, page->frame->kva, page_read_bytes) != (int)page_read_bytes) {
-        return false;
-    }
-    memset(page->frame->kva + page_read_bytes, 0, page_zero_bytes);
-    return true;
-}
-
 /* 파일 FILE의 OFS 오프셋에서 시작하는 세그먼트를
  * UPAGE 주소에 로드합니다.
  * 총 READ_BYTES + ZERO_BYTES 크기의 가상 메모리를 다음과 같이 초기화합니다:
@@ -771,26 +786,26 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
     ASSERT (pg_ofs (upage) == 0);
     ASSERT (ofs % PGSIZE == 0);
 
-    while (read_bytes > 0 || zero_bytes > 0) {
-        size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
-        size_t page_zero_bytes = PGSIZE - page_read_bytes;
-
-        /* lazy_load_segment에 전달할 aux 설정 */
-        struct container *container = (struct container *)malloc(sizeof(struct container));
-        container->file = file;
-        container->page_read_bytes = page_read_bytes;
-        container->offset = ofs;
-
-        /* **중요**: VM_FILE 로 등록해야 file-backed 페이지가 됨 */
-        if (!vm_alloc_page_with_initializer (VM_FILE, upage,
-                    writable, lazy_load_segment, container))
-            return false;
-
-        /* 다음 페이지로 이동 */
-        read_bytes -= page_read_bytes;
-        zero_bytes -= page_zero_bytes;
-        upage += PGSIZE;
-        ofs += page_read_bytes;
+    /* 페이지마다 struct page를 만들지 않고 세그먼트를 구간(VMA) 하나로 등록합니다.
+     * 페이지는 처음 fault가 날 때 만들어지고 파일에서 읽힙니다.
+     * 읽기 전용 세그먼트는 text 캐시로 다른 프로세스와 프레임을 공유합니다. */
+    struct vm_area area = {
+        .start = upage,
+        .end = upage + read_bytes + zero_bytes,
+        .type = VM_FILE,
+        .writable = writable,
+        .shared = false,
+        .text = !writable,
+        .file = file_reopen (file),
+        .offset = ofs,
+        .file_bytes = read_bytes,
+    };
+
+    if (area.file == NULL)
+        return false;
+    if (!vma_insert (&thread_current ()->spt.vmas, &area)) {
+        file_close (area.file);
+        return false;
     }
     return true;
 }
@@ -801,21 +816,15 @@ static bool
 setup_stack(struct intr_frame *if_)
 {
 	bool success = false;
-	void *stack_bottom = (void *)(((uint8_t *)USER_STACK) - PGSIZE);
 
 	/* TODO: stack_bottom에 스택을 매핑하고 즉시 페이지를 할당합니다.
 	 * TODO: 성공 시, rsp를 적절하게 설정합니다.
 	 * TODO: 해당 페이지가 스택임을 표시해야 합니다. */
 	/* TODO: 여기에 코드를 작성하세요. */
-	if (vm_alloc_page(VM_ANON | VM_MARKER_0, stack_bottom, 1))
-	{
-		success = vm_claim_page(stack_bottom);
-		if (success)
-		{
-			if_->rsp = USER_STACK;
-			thread_current()->stack_bottom = stack_bottom;
-		}
-	}
+	/* 스택 구간을 만들고 첫 페이지를 올림. 이후 페이지는 fault 때 vm_stack_growth()가 만듦 */
+	success = vm_stack_init();
+	if (success)
+		if_->rsp = USER_STACK;
 
 	return success;
 }
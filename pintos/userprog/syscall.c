@@ -14,6 +14,7 @@
 #include "filesys/filesys.h"
 #include "filesys/file.h"
 #include "threads/palloc.h"
+#include "threads/mmu.h"
 
 
 void syscall_entry (void);
@@ -189,6 +190,47 @@ syscall_handler (struct intr_frame *f) {
 	case SYS_UMOUNT:
 		/* code */
 		break;
+
+	/* Extra for Project 3 */
+	case SYS_MEMSTAT:
+		f->R.rax = memstat((struct memstat *) f->R.rdi);
+		break;
+
+	case SYS_MADVISE:
+		f->R.rax = vm_madvise((void *) f->R.rdi, f->R.rsi, f->R.rdx) ? 0 : -1;
+		break;
+
+	case SYS_MLOCK:
+		f->R.rax = vm_mlock((const void *) f->R.rdi, f->R.rsi) ? 0 : -1;
+		break;
+
+	case SYS_MUNLOCK:
+		f->R.rax = vm_munlock((const void *) f->R.rdi, f->R.rsi) ? 0 : -1;
+		break;
+
+	case SYS_MSYNC:
+		f->R.rax = do_msync((void *) f->R.rdi, f->R.rsi, f->R.rdx) ? 0 : -1;
+		break;
+
+	case SYS_VMSTAT:
+		f->R.rax = vmstat(f->R.rdi, (struct vmstat *) f->R.rsi);
+		break;
+
+	case SYS_UFFD_REGISTER:
+		f->R.rax = uffd_register_range((void *) f->R.rdi, f->R.rsi) ? 0 : -1;
+		break;
+
+	case SYS_UFFD_READ:
+		f->R.rax = uffd_read((struct uffd_msg *) f->R.rdi);
+		break;
+
+	case SYS_UFFD_COPY:
+		f->R.rax = uffd_fill((void *) f->R.rdi, (const void *) f->R.rsi, f->R.rdx) ? 0 : -1;
+		break;
+
+	case SYS_UFFD_ZERO:
+		f->R.rax = uffd_fill((void *) f->R.rdi, NULL, f->R.rsi) ? 0 : -1;
+		break;
 	
 	default:
 		thread_exit ();
@@ -287,7 +329,18 @@ int write (int fd, const void *buffer, unsigned length) {
 		}
 	}
 	else{
+#ifdef VM
+		// 처리 프로세스가 채울 페이지는 filesys_lock을 잡기 전에 받아 둠
+		if (!uffd_prefault(buffer, length, false))
+			exit(-1);
+#endif
 		lock_acquire(&filesys_lock);
+#ifdef VM
+		// 페이지 단위로 맞으면 사용자 주소를 거치지 않고 프레임에서 바로 씀
+		if (file_pages_aligned(file, buffer, length))
+			written = file_write_direct(file, buffer, length);
+		else
+#endif
 		written = file_write(file, buffer, length);
 		lock_release(&filesys_lock);
 	}
@@ -394,7 +447,18 @@ int read (int fd, void *buffer, unsigned length){
 		}
 	}
 	else{
+#ifdef VM
+		// 처리 프로세스가 채울 페이지는 filesys_lock을 잡기 전에 받아 둠
+		if (!uffd_prefault(buffer, length, true))
+			exit(-1);
+#endif
 		lock_acquire(&filesys_lock);
+#ifdef VM
+		// 페이지 단위로 맞으면 사용자 프레임을 바로 채움
+		if (file_pages_aligned(file, buffer, length))
+			bytes_read = file_read_direct(file, buffer, length);
+		else
+#endif
 		bytes_read = file_read(file, buffer, length);
 		lock_release(&filesys_lock);
 	}
@@ -495,12 +559,24 @@ int dup2(int oldfd, int newfd){
 }
 
 void *mmap(void *addr, size_t length, int writable, int fd, off_t offset){
+    // MAP_POPULATE, MAP_ANONYMOUS는 writable 인자에 함께 실려 옴
+    bool populate = (writable & MAP_POPULATE) != 0;
+    bool anonymous = (writable & MAP_ANONYMOUS) != 0;
+    writable &= ~(MAP_POPULATE | MAP_ANONYMOUS);
+
     // offset이 정렬 x
     if (offset % PGSIZE != 0){
         return NULL;
     }
     if(pg_round_down(addr) != addr || is_kernel_vaddr(addr) || addr == NULL || (long long)length <=0)
         return NULL;
+    // 파일 없는 공유 메모리: fd와 offset은 쓰지 않음
+    if (anonymous) {
+        void *ret = shm_mmap(addr, length, writable);
+        if (ret != NULL && populate)
+            vm_populate(ret, pg_round_up(ret + length), true);
+        return ret;
+    }
     // console input, output은 mapping x
     if(fd == 0 || fd == 1)
         exit(-1);
@@ -514,9 +590,55 @@ void *mmap(void *addr, size_t length, int writable, int fd, off_t offset){
 
     void *ret = do_mmap(addr, length, writable, target, offset);
 
+    // 모든 페이지를 지금 읽어 두어 첫 접근에서 fault가 나지 않게 함
+    if (ret != NULL && populate)
+        vm_populate(ret, pg_round_up(ret + length), true);
     return ret;
 }
 
 void munmap(void *addr){
     do_munmap(addr);
-}
\ No newline at end of file
+}
+
+/* Extra for Project 3 */
+bool memstat(struct memstat *ms){
+	struct thread *cur = thread_current();
+	struct palloc_stats user, kernel;
+
+	check_valid_buffer(ms, sizeof *ms, NULL, 1);
+
+	palloc_get_stats(PAL_USER, &user);
+	palloc_get_stats(0, &kernel);
+
+	ms->rss = cur->vm_usage.rss;
+	ms->rss_peak = cur->vm_usage.rss_peak;
+	ms->swap = cur->vm_usage.swap;
+	ms->pgtable = pml4_table_cnt(cur->pml4);
+	ms->user_total = user.total;
+	ms->user_free = user.free;
+	ms->wmark_min = user.wmark_min;
+	ms->wmark_low = user.wmark_low;
+	ms->wmark_high = user.wmark_high;
+	ms->kernel_total = kernel.total;
+	ms->kernel_free = kernel.free;
+	swap_stats(&ms->swap_total, &ms->swap_used);
+	ms->locked = cur->vm_usage.locked;
+	ms->locked_limit = mlock_limit;
+	ms->wss = cur->vm_usage.wss;
+	ms->wss_peak = cur->vm_usage.wss_peak;
+	ms->idle_samples = cur->wss_idle;
+	return true;
+}
+
+bool vmstat(int who, struct vmstat *st){
+	if (who != VMSTAT_SELF && who != VMSTAT_ALL)
+		return false;
+	check_valid_buffer(st, sizeof *st, NULL, 1);
+	vm_get_stats(st, who == VMSTAT_ALL);
+	return true;
+}
+
+bool uffd_read(struct uffd_msg *msg){
+	check_valid_buffer(msg, sizeof *msg, NULL, 1);
+	return uffd_next_fault(&msg->addr, &msg->write);
+}
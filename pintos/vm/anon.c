@@ -1,12 +1,12 @@
 /* anon.c: 디스크 이미지가 아닌 페이지(즉, anonymous page)를 위한 구현. */
 
 #include "vm/vm.h"
-#include "devices/disk.h"
+#include "vm/swap.h"
 #include "threads/vaddr.h"
-#include "kernel/bitmap.h"
+#include "threads/mmu.h"
+#include <string.h>
 
 /* 아래 줄은 수정하지 마세요 */
-static struct disk *swap_disk;
 static bool anon_swap_in (struct page *page, void *kva);
 static bool anon_swap_out (struct page *page);
 static void anon_destroy (struct page *page);
@@ -19,16 +19,21 @@ static const struct page_operations anon_ops = {
 	.type = VM_ANON,
 };
 
-struct bitmap *swap_table;
-const size_t SECTORS_PER_PAGE = PGSIZE / DISK_SECTOR_SIZE;
-
 /* Anonymous 페이지를 위한 데이터를 초기화합니다 */
 void
 vm_anon_init (void) {
 	/* TODO: swap_disk를 설정하세요. */
-	swap_disk = disk_get(1,1);
-    size_t swap_size = disk_size(swap_disk) / SECTORS_PER_PAGE;
-    swap_table = bitmap_create(swap_size);
+	swap_init ();
+}
+
+/* PAGE가 가리키던 swap slot의 참조를 하나 내려놓습니다. 마지막 참조였다면 slot이 비워집니다. */
+static void
+swap_slot_put (struct page *page) {
+    struct anon_page *anon_page = &page->anon;
+
+    swap_free(anon_page->swap_index);
+    anon_page->swap_index = -1;
+    vm_usage_add (&page->owner->vm_usage.swap, -1);
 }
 
 /* 파일 매핑을 초기화합니다 */
@@ -40,6 +45,10 @@ anon_initializer (struct page *page, enum vm_type type, void *kva) {
     /* 익명 페이지 메타 초기화 */
     struct anon_page *anon_page = &page->anon;
     anon_page->swap_index = -1;
+
+    /* 새 익명 페이지는 0으로 시작. KVA가 NULL이면 zero 프레임에 매핑하는 경우라 채울 필요 없음 */
+    if (kva != NULL)
+        memset (kva, 0, PGSIZE);
     return true;
 }
 
@@ -51,46 +60,115 @@ anon_swap_in (struct page *page, void *kva) {
     // anon_page 구조체 안에 저장되어 있다.
     int page_no = anon_page->swap_index;
 
-    if(bitmap_test(swap_table, page_no) == false){
+    // slot이 없으면 zero 프레임만 읽었을 뿐 한 번도 쓴 적 없는 페이지
+    if(page_no == -1){
+        memset(kva, 0, PGSIZE);
+        return true;
+    }
+    if(!swap_in_use(page_no)){
         return false;
     }
     // 해당 swap 영역의 data를 가상 주소공간 kva에 써준다.
-    for(int i=0; i< SECTORS_PER_PAGE; ++i){
-        disk_read(swap_disk, page_no * SECTORS_PER_PAGE + i, kva + DISK_SECTOR_SIZE * i);
-    }
-    // 해당 swap slot false로 만들어줌(다음번에 쓸 수 있게)
-    bitmap_set(swap_table, page_no, false);
+    swap_read(page_no, kva);
+    // 해당 swap slot 참조를 내려놓음. 공유하던 다른 페이지가 없으면 다음번에 쓸 수 있게 비워짐
+    swap_slot_put (page);
 
     return true;
 }
 
-/* 페이지의 내용을 swap 디스크에 써서 swap out 합니다. */
+/* FRAME이 익명 페이지 프레임이고, 매핑한 모든 페이지가 MADV_FREE 이후 쓰이지 않았으면 true.
+ * 이런 프레임은 swap에 쓰지 않고 버려도 됩니다. frame_lock을 잡고 호출해야 합니다. */
+bool
+anon_discardable (struct frame *frame) {
+    struct list_elem *e;
+
+    if (frame->page == NULL || frame->page->operations != &anon_ops)
+        return false;
+    for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e)) {
+        struct page *p = list_entry (e, struct page, share_elem);
+
+        if (!p->lazyfree || pml4_is_dirty (p->owner->pml4, p->va))
+            return false;
+    }
+    return true;
+}
+
+/* 페이지의 내용을 swap 디스크에 써서 swap out 합니다.
+ * 프레임을 fork로 공유하는 페이지가 여럿이면 한 번만 쓰고 모든 페이지가 같은 slot을 가리키게 합니다.
+ * MADV_FREE 이후 쓰이지 않은 프레임은 쓰지 않고 버립니다. 다음 접근 때 0으로 시작합니다. */
 static bool
 anon_swap_out (struct page *page) {
-    struct anon_page *anon_page = &page->anon;
+    struct frame *frame = page->frame;
+    struct list_elem *e;
+
+    if (anon_discardable (frame)) {
+        for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e)) {
+            struct page *p = list_entry (e, struct page, share_elem);
+
+            pml4_clear_page(p->owner->pml4, p->va);
+            p->lazyfree = false;
+            p->frame = NULL;
+        }
+        return true;
+    }
 
-    int page_no = bitmap_scan(swap_table, 0, 1, false);
-    if (page_no == BITMAP_ERROR) {
+    size_t page_no = swap_alloc(page);
+    if (page_no == SWAP_ERROR) {
         return false;
     }
 
+    /* 쓰는 도중 내용이 바뀌지 않도록 모든 매핑을 먼저 끊음 */
+    for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e)) {
+        struct page *p = list_entry (e, struct page, share_elem);
+        pml4_clear_page(p->owner->pml4, p->va);
+    }
+
     /* 반드시 프레임 KVA로부터 디스크에 써야 함 */
-    for (int i = 0; i < SECTORS_PER_PAGE; ++i) {
-        disk_write(swap_disk, page_no * SECTORS_PER_PAGE + i,
-                   page->frame->kva + DISK_SECTOR_SIZE * i);
+    swap_write(page_no, frame->kva);
+    anon_swap_commit(frame, page_no);
+    return true;
+}
+
+/* SLOT에 써 둔 FRAME을 이제 swap으로 넘깁니다. FRAME을 매핑한 모든 페이지가 SLOT을 가리키게 하고
+ * 프레임과의 연결을 끊습니다. SLOT은 swap_alloc()이 준 참조 하나를 가지고 있어야 하며,
+ * 매핑은 이미 끊겨 있어야 합니다. frame_lock을 잡고 호출해야 합니다. */
+void
+anon_swap_commit (struct frame *frame, size_t slot) {
+    struct list_elem *e;
+
+    for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e)) {
+        struct page *p = list_entry (e, struct page, share_elem);
+
+        if (e != list_begin (&frame->pages))
+            swap_dup(slot);
+        p->anon.swap_index = slot;
+        vm_usage_add (&p->owner->vm_usage.swap, 1);
+
+        /* 프레임과의 연결은 끊어줌 (evict 경로에서 재사용) */
+        p->frame = NULL;
     }
+}
 
-    bitmap_set(swap_table, page_no, true);
-    pml4_clear_page(thread_current()->pml4, page->va);
-    anon_page->swap_index = page_no;
+/* fork로 복사된 자식 페이지 PAGE가 부모와 같은 swap slot을 공유하게 합니다. */
+void
+anon_swap_fork (struct page *page) {
+    if (page->anon.swap_index == -1)
+        return;
+    swap_dup(page->anon.swap_index);
+    vm_usage_add (&page->owner->vm_usage.swap, 1);
+}
 
-    /* 프레임과의 연결은 끊어줌 (evict 경로에서 재사용) */
-    page->frame = NULL;
-    return true;
+/* 익명 PAGE의 내용을 버립니다. 프레임에 있으면 프레임을, swap에 있으면 swap slot을 돌려주고,
+ * 다음 접근 때 0으로 시작합니다(MADV_DONTNEED). */
+void
+anon_discard (struct page *page) {
+	vm_free_frame (page);
+	if (page->anon.swap_index != -1)
+		swap_slot_put (page);
 }
 
 /* anonymous 페이지를 파괴합니다. PAGE는 호출자가 해제합니다. */
 static void
 anon_destroy (struct page *page) {
-	struct anon_page *anon_page = &page->anon;
+	anon_discard (page);
 }
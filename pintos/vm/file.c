@@ -1,7 +1,14 @@
 /* file.c: 메모리에 매핑된 파일 객체(mmaped object)를 위한 구현입니다. */
 
+#include <mman.h>
+#include <stdlib.h>
+#include <string.h>
 #include "vm/vm.h"
+#include "filesys/inode.h"
 #include "threads/vaddr.h"
+#include "threads/mmu.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
 #include "userprog/process.h"
 
 static bool file_backed_swap_in (struct page *page, void *kva);
@@ -16,6 +23,29 @@ static const struct page_operations file_ops = {
 	.type = VM_FILE,
 };
 
+int fault_around_pages = 16;
+long long writeback_pages;
+long long writeback_writes;
+long long zero_copy_disk;
+long long zero_copy_cached;
+long long zero_copy_writes;
+
+/* writeback: 한 번의 file_write_at()으로 쓰는 최대 페이지 수 */
+#define WB_RUN_MAX 32
+
+/* 쓰기를 기다리는 dirty 페이지 하나. 프레임은 쓸 때까지 고정되어 있음 */
+struct wb_entry {
+    off_t offset;
+    size_t bytes;
+    struct frame *frame;
+};
+
+/* 한 구간에서 모은 dirty 페이지들 */
+struct wb_batch {
+    struct wb_entry *entries;
+    size_t cnt, cap;
+};
+
 /* 파일 기반 가상 메모리 초기화 함수 */
 void
 vm_file_init (void) {
@@ -57,34 +87,229 @@ file_backed_swap_in (struct page *page, void *kva) {
     }
 
     memset(kva + page_read_bytes, 0, page_zero_bytes);
+    vm_event(VMSTAT_FILE_IN, 1);
 
     return true;
 }
 
-/* 페이지의 내용을 파일에 writeback 하여 swap out 합니다. */
+/* 페이지의 내용을 파일에 writeback 하여 swap out 합니다.
+ * 프레임을 fork로 공유하는 페이지가 여럿이면 모두의 매핑을 끊고, 그중 하나라도 dirty면 한 번만 씁니다. */
 static bool
 file_backed_swap_out (struct page *page) {
     if (page == NULL) return false;
 
     struct container *aux = (struct container *)page->uninit.aux;
+    void *kva = page->frame->kva;
+    struct list *pages = &page->frame->pages;
+    struct list_elem *e;
+    bool dirty = false;
+
+    for (e = list_begin (pages); e != list_end (pages); e = list_next (e)) {
+        struct page *p = list_entry (e, struct page, share_elem);
+
+        if (pml4_is_dirty(p->owner->pml4, p->va)) {
+            dirty = true;
+            pml4_set_dirty(p->owner->pml4, p->va, 0);
+        }
+        /* 매핑 해제 */
+        pml4_clear_page(p->owner->pml4, p->va);
+        /* 프레임은 evict 호출자가 재사용하므로 여기서 NULL 처리만 */
+        p->frame = NULL;
+    }
 
     /* dirty면 파일에 반영 (프레임 KVA에서 써야 함) */
-    if (pml4_is_dirty(thread_current()->pml4, page->va)) {
-        file_write_at(aux->file, page->frame->kva, aux->page_read_bytes, aux->offset);
-        pml4_set_dirty(thread_current()->pml4, page->va, 0);
+    if (dirty)
+        file_write_at(aux->file, kva, aux->page_read_bytes, aux->offset);
+    return true;
+}
+
+/* fork로 복사된 자식 페이지 PAGE에 container 복사본을 달아 줍니다.
+ * container는 munmap이나 destroy가 해제하므로 부모와 같은 것을 가리키면 안 됩니다.
+ * 복사하지 못하면 부모 것을 해제하지 않도록 container를 비워 두고 false를 반환합니다.
+ * 로드된 mmap 페이지는 file.aux도 같은 container를 가리키므로 함께 바꿉니다. */
+bool
+file_backed_fork (struct page *page) {
+    struct container *aux = (struct container *)page->uninit.aux;
+    struct container *copy;
+    struct vm_area *area;
+
+    if (aux == NULL)
+        return true;
+    copy = (struct container *)malloc(sizeof *copy);
+    if (page->file.aux == aux)
+        page->file.aux = copy;
+    page->uninit.aux = copy;
+    if (copy == NULL)
+        return false;
+    *copy = *aux;
+    /* 파일은 vma_copy()가 자식 몫으로 다시 연 것을 씀 */
+    area = vma_find (&page->owner->spt.vmas, page->va);
+    if (area != NULL)
+        copy->file = area->file;
+    return true;
+}
+
+/* PAGE의 container. 로드 전에는 uninit.aux에 있고, 로드 후에도 file.aux가
+ * uninit.init 자리를 덮을 뿐이라 uninit.aux는 그대로 남아 있습니다. */
+static struct container *
+page_container (struct page *page) {
+    return (struct container *)page->uninit.aux;
+}
+
+/* PAGE의 매핑에 대해 이번 fault에서 함께 매핑할 페이지 수를 정합니다.
+ * 지난 fault에서 함께 매핑한 페이지 중 절반 이상이 그동안 쓰였거나(accessed),
+ * 이번 fault가 그 묶음 바로 뒤에서 났으면 순차 접근으로 보고 창을 두 배로 늘리고,
+ * 아니면 읽기만 하고 버려지는 것으로 보고 반으로 줄입니다. */
+static size_t
+around_window (struct page *page, struct file_ra *ra) {
+    uint64_t *pml4 = page->owner->pml4;
+    int used = 0, i;
+
+    if (ra->window == 0 || ra->window > fault_around_pages)
+        ra->window = fault_around_pages;
+    else if (ra->cnt > 0) {
+        for (i = 1; i < ra->cnt; i++)
+            if (pml4_is_accessed (pml4, ra->start + i * PGSIZE))
+                used++;
+        if (page->va == ra->start + ra->cnt * PGSIZE
+                || (ra->cnt > 1 && used * 2 >= ra->cnt - 1))
+            ra->window = ra->window * 2 < fault_around_pages
+                ? ra->window * 2 : fault_around_pages;
+        else if (ra->window > 1)
+            ra->window /= 2;
+    }
+    return ra->window > 1 ? ra->window : 1;
+}
+
+/* 파일 기반 페이지 PAGE와, 같은 매핑에서 바로 뒤따르는 아직 올라오지 않은
+ * 페이지들을 최대 MAX개까지 PAGES에 모으고 그 수를 반환합니다. PAGES[0]은 PAGE입니다.
+ * 파일에서 빈틈없이 이어지는 페이지만 모으므로 한 번의 읽기로 채울 수 있습니다. */
+size_t
+file_backed_run (struct page *page, struct page **pages, size_t max) {
+    struct container *first = page_container (page);
+    struct container *prev = first;
+    size_t cnt = 1;
+
+    pages[0] = page;
+    if (first == NULL)
+        return 1;
+
+    while (cnt < max && prev->page_read_bytes == PGSIZE) {
+        struct page *next = spt_find_page (&page->owner->spt,
+                page->va + cnt * PGSIZE);
+        struct container *c;
+
+        if (next == NULL || next->frame != NULL
+                || page_get_type (next) != VM_FILE
+                || (next->operations->type != VM_UNINIT
+                    && next->operations != &file_ops))
+            break;
+        c = page_container (next);
+        if (c == NULL || c->file != first->file
+                || c->offset != prev->offset + PGSIZE)
+            break;
+        pages[cnt++] = next;
+        prev = c;
+    }
+    return cnt;
+}
+
+/* fault가 난 파일 기반 페이지 PAGE와 함께 매핑할 이웃 페이지들을 최대 MAX개까지 PAGES에 모읍니다.
+ * 몇 개를 모을지는 매핑의 fault-around 상태에 따라 정하고, 이번 결과를 상태에 기록합니다.
+ * MADV_RANDOM이면 이웃을 모으지 않고, MADV_SEQUENTIAL이면 창을 늘려 가지 않고 처음부터 MAX개를 모읍니다. */
+size_t
+file_backed_around (struct page *page, struct page **pages, size_t max) {
+    struct container *first = page_container (page);
+    struct file_ra *ra;
+    size_t window, cnt;
+
+    pages[0] = page;
+    if (first == NULL || fault_around_pages <= 1 || page->advice == MADV_RANDOM)
+        return 1;
+    ra = file_get_ra (first->file);
+    window = page->advice == MADV_SEQUENTIAL ? max : around_window (page, ra);
+    if (window > max)
+        window = max;
+
+    cnt = file_backed_run (page, pages, window);
+    ra->start = page->va;
+    ra->cnt = cnt;
+    return cnt;
+}
+
+/* file_backed_around()가 모은 CNT개의 페이지를 파일에서 한 번에 읽어 각자의 프레임에 채우고
+ * 파일 기반 페이지로 초기화합니다. 각 페이지의 frame은 호출자가 미리 달아 두어야 합니다.
+ * 읽기용 커널 버퍼를 얻지 못하면 페이지마다 따로 읽습니다.
+ * 읽기에 실패하면 어떤 페이지도 초기화하지 않고 false를 반환합니다. */
+bool
+file_backed_read_around (struct page **pages, size_t cnt) {
+    struct container *first = page_container (pages[0]);
+    struct container *last = page_container (pages[cnt - 1]);
+    size_t bytes = (cnt - 1) * PGSIZE + last->page_read_bytes;
+    uint8_t *buf = palloc_get_multiple (0, cnt);
+    size_t i;
+
+    if (buf != NULL) {
+        bool ok = file_read_at (first->file, buf, bytes, first->offset) == (off_t) bytes;
+
+        for (i = 0; ok && i < cnt; i++) {
+            size_t read_bytes = page_container (pages[i])->page_read_bytes;
+
+            memcpy (pages[i]->frame->kva, buf + i * PGSIZE, read_bytes);
+            memset (pages[i]->frame->kva + read_bytes, 0, PGSIZE - read_bytes);
+        }
+        palloc_free_multiple (buf, cnt);
+        if (!ok)
+            return false;
+    } else {
+        for (i = 0; i < cnt; i++) {
+            struct container *c = page_container (pages[i]);
+
+            if (file_read_at (c->file, pages[i]->frame->kva, c->page_read_bytes,
+                        c->offset) != (off_t) c->page_read_bytes)
+                return false;
+            memset (pages[i]->frame->kva + c->page_read_bytes, 0,
+                    PGSIZE - c->page_read_bytes);
+        }
     }
 
-    /* 매핑 해제 */
-    pml4_clear_page(thread_current()->pml4, page->va);
-    /* 프레임은 evict 호출자가 재사용하므로 여기서 NULL 처리만 */
-    page->frame = NULL;
+    for (i = 0; i < cnt; i++)
+        file_backed_loaded (pages[i], pages[i]->frame->kva);
+    vm_event (VMSTAT_FILE_IN, cnt);
     return true;
 }
 
-/* 파일 기반 페이지를 제거합니다. PAGE는 호출자가 해제합니다. */
+/* 내용이 이미 KVA에 채워진 PAGE가 아직 uninit이면 파일 기반 페이지로 바꿉니다.
+ * 파일에서 읽는 init은 부르지 않습니다. */
+void
+file_backed_loaded (struct page *page, void *kva) {
+    if (page->operations->type == VM_UNINIT) {
+        struct container *c = page_container (page);
+
+        page->uninit.page_initializer (page, page->uninit.type, kva);
+        page->file.aux = c;
+    }
+}
+
+/* PAGE가 실행 파일의 읽기 전용 세그먼트 페이지면 그 container를, 아니면 NULL을 반환합니다.
+ * 이런 페이지는 text 캐시로 프로세스끼리 프레임을 공유합니다. */
+struct container *
+file_backed_text (struct page *page) {
+    struct container *c;
+
+    if (page_get_type (page) != VM_FILE
+            || (page->operations->type != VM_UNINIT && page->operations != &file_ops))
+        return NULL;
+    c = page_container (page);
+    return c != NULL && c->text ? c : NULL;
+}
+
+/* 파일 기반 페이지를 제거하고 container를 해제합니다. PAGE는 호출자가 해제합니다. */
 static void
 file_backed_destroy (struct page *page) {
 	struct file_page *file_page UNUSED = &page->file;
+	vm_free_frame (page);
+	free (page_container (page));
 }
 
 // static bool lazy_load_file(struct page *page, void *aux) {
@@ -173,7 +398,7 @@ static bool lazy_load_file(struct page *page, void *aux) {
     // 파일 크기 체크
     if (offset >= file_length(file)) {
         // 파일 끝을 넘어선 경우 - 0으로 채움
-        memset(page->frame->kva, 0, PGSIZE);
+        clear_page(page->frame->kva);
         // aux를 file.aux로 이동
         page->file.aux = aux;
         return true;
@@ -195,148 +420,346 @@ static bool lazy_load_file(struct page *page, void *aux) {
     return true;
 }
 
+/* 구간 AREA 안의 VA에 파일 기반 페이지를 만들어 SPT에 넣습니다. 내용은 첫 fault에서 읽습니다. */
+bool
+file_backed_fault_in (struct vm_area *area, void *va) {
+    size_t page_ofs = va - area->start;
+    struct container *container;
+
+    /* 실행 파일의 bss처럼 파일 내용이 없는 사적인 페이지는 0으로 시작하는 익명 페이지.
+     * 읽기만 하면 zero 프레임을 매핑하고, evict 될 때 파일이 아닌 swap으로 감 */
+    if (!area->shared && area->file_bytes <= page_ofs)
+        return vm_alloc_page(VM_ANON, va, area->writable);
+
+    container = (struct container *)malloc(sizeof(struct container));
+
+    if (container == NULL)
+        return false;
+    container->file = area->file;
+    container->offset = area->offset + page_ofs;
+    container->page_read_bytes = area->file_bytes > page_ofs ? area->file_bytes - page_ofs : 0;
+    if (container->page_read_bytes > PGSIZE)
+        container->page_read_bytes = PGSIZE;
+    container->text = area->text;
+
+    if (!vm_alloc_page_with_initializer(VM_FILE, va, area->writable, lazy_load_file, container)) {
+        free(container);
+        return false;
+    }
+    return true;
+}
+
+/* mmap 작업을 수행합니다.
+ * 페이지마다 struct page를 만들지 않고 구간(VMA) 하나만 등록하므로, 길이와 상관없이 비용이 일정합니다.
+ * 페이지는 처음 접근할 때 file_backed_fault_in()이 만듭니다. */
 void *
 do_mmap(void *addr, size_t length, int writable,
         struct file *file, off_t offset)
 {
+    struct thread *curr = thread_current();
+    struct vm_area area;
+
     if (file == NULL || length == 0)
         return NULL;
-        
+
+    // 페이지 정렬 확인
+    if (pg_ofs(addr) != 0 || addr == NULL)
+        return NULL;
+
+    // 커널 영역이나 주소 공간 끝을 넘어가면 실패
+    void *end = pg_round_up(addr + length);
+    if (end <= addr || !is_user_vaddr(end - 1))
+        return NULL;
+
+    // 오프셋이 파일 크기를 초과하는지 확인
+    off_t file_size = file_length(file);
+    if (offset >= file_size)
+        return NULL;
+
+    // 이미 사용 중인 주소인지 확인: 다른 구간, 또는 구간 밖에 만든 페이지(스택 등)
+    if (vma_overlaps(&curr->spt.vmas, addr, end) || !spt_range_empty(&curr->spt, addr, end))
+        return NULL;
+
     struct file *mfile = file_reopen(file);
     if (mfile == NULL)
         return NULL;
-        
-    void *ori_addr = addr;
-    size_t file_size = file_length(mfile);
-    
-    // 오프셋이 파일 크기를 초과하는지 확인
-    if (offset >= file_size) {
+
+    area.start = addr;
+    area.end = end;
+    area.type = VM_FILE;
+    area.writable = writable;
+    area.shared = true;
+    area.text = false;
+    area.file = mfile;
+    area.shm = NULL;
+    area.offset = offset;
+    area.file_bytes = (size_t) (file_size - offset) < length ? (size_t) (file_size - offset) : length;
+    area.advice = MADV_NORMAL;
+    if (!vma_insert(&curr->spt.vmas, &area)) {
         file_close(mfile);
         return NULL;
     }
-    
-    // 페이지 정렬 확인
-    if (pg_ofs(addr) != 0) {
-        file_close(mfile);
-        return NULL;
+    return addr;
+}
+
+/* 구간의 페이지 PAGE를 정리합니다. WRITEBACK이고 dirty면 파일에 쓰고, SPT에서 빼서 해제합니다.
+ * 페이지는 다음 접근 때 구간에서 다시 만들어집니다. */
+static void
+drop_page (struct page *page, bool writeback) {
+    struct thread *curr = thread_current();
+    struct container *c = page_container(page);
+
+    // 페이지가 실제로 메모리에 로드되어 있고 dirty한 경우 write-back
+    if (writeback && c != NULL && page->frame != NULL && pml4_is_dirty(curr->pml4, page->va)) {
+        file_write_at(c->file, page->frame->kva, c->page_read_bytes, c->offset);
+        pml4_set_dirty(curr->pml4, page->va, 0);
     }
-    
-    size_t remaining_length = length;
-    off_t current_offset = offset;
-    void *current_addr = addr;
-    
-    while (remaining_length > 0) {
-        // 이미 사용 중인 주소인지 확인
-        if (spt_find_page(&thread_current()->spt, current_addr) != NULL) {
-            do_munmap(ori_addr);
-            file_close(mfile);
-            return NULL;
-        }
-        
-        // 이 페이지에서 읽을 바이트 수 계산
-        size_t page_read_bytes;
-        if (current_offset < file_size) {
-            size_t available_in_file = file_size - current_offset;
-            size_t needed_for_page = remaining_length < PGSIZE ? remaining_length : PGSIZE;
-            page_read_bytes = available_in_file < needed_for_page ? available_in_file : needed_for_page;
-        } else {
-            page_read_bytes = 0;
-        }
-        
-        struct container *container = (struct container*)malloc(sizeof(struct container));
-        if (container == NULL) {
-            do_munmap(ori_addr);
-            file_close(mfile);
-            return NULL;
-        }
-        
-        container->file = mfile;
-        container->offset = current_offset;
-        container->page_read_bytes = page_read_bytes;
-        
-        if (!vm_alloc_page_with_initializer(VM_FILE, current_addr, writable, lazy_load_file, container)) {
-            free(container);
-            do_munmap(ori_addr);
-            file_close(mfile);
-            return NULL;
+
+    // aux 구조체 해제
+    free(c);
+
+    // 물리 프레임 해제 (할당되어 있는 경우), 매핑도 함께 제거
+    vm_free_frame(page);
+
+    // SPT에서 페이지 제거
+    spt_delete_page(&curr->spt, page);
+
+    // 페이지 구조체 해제
+    free(page);
+}
+
+/* spt_for_each_in_range() 콜백: 올라와 있는 dirty 파일 페이지를 배치에 모음 */
+static void
+wb_collect (struct page *page, void *batch_) {
+    struct wb_batch *b = batch_;
+    struct container *c = page_container (page);
+    struct frame *frame;
+
+    if (b->cnt == b->cap || page->operations != &file_ops || c == NULL)
+        return;
+    frame = vm_pin_dirty_frame (page);
+    if (frame != NULL)
+        b->entries[b->cnt++] = (struct wb_entry) { c->offset, c->page_read_bytes, frame };
+}
+
+/* qsort() 비교 함수: 파일 오프셋 순 */
+static int
+wb_compare (const void *a_, const void *b_) {
+    const struct wb_entry *a = a_, *b = b_;
+    return a->offset < b->offset ? -1 : a->offset > b->offset;
+}
+
+/* 파일 FILE에 오프셋 순으로 정렬된 CNT개의 dirty 페이지 ENTRIES를 씁니다.
+ * 파일에서 이어지는 페이지는 BUF에 모아 WB_RUN_MAX개까지 한 번에 쓰고, BUF가 NULL이면 페이지마다 씁니다.
+ * 쓴 프레임은 고정을 풉니다. */
+static void
+wb_write (struct file *file, struct wb_entry *entries, size_t cnt, uint8_t *buf) {
+    size_t i = 0, j, run;
+
+    while (i < cnt) {
+        run = 1;
+        while (buf != NULL && run < WB_RUN_MAX && i + run < cnt
+                && entries[i + run - 1].bytes == PGSIZE
+                && entries[i + run].offset == entries[i + run - 1].offset + PGSIZE)
+            run++;
+
+        if (run == 1)
+            file_write_at (file, entries[i].frame->kva, entries[i].bytes, entries[i].offset);
+        else {
+            for (j = 0; j < run; j++)
+                memcpy (buf + j * PGSIZE, entries[i + j].frame->kva, entries[i + j].bytes);
+            file_write_at (file, buf, (run - 1) * PGSIZE + entries[i + run - 1].bytes,
+                    entries[i].offset);
         }
-        
-        remaining_length -= PGSIZE;
-        current_addr += PGSIZE;
-        current_offset += page_read_bytes;
+        for (j = 0; j < run; j++)
+            vm_unpin_frame (entries[i + j].frame);
+        writeback_pages += run;
+        writeback_writes++;
+        i += run;
     }
-    
-    return ori_addr;
 }
 
+/* 공유 매핑 구간 AREA의 [START, END)에 있는 dirty 페이지를 파일에 씁니다.
+ * dirty 페이지를 모아 dirty 비트를 한꺼번에 지우고 TLB는 한 번만 비운 뒤,
+ * 파일 오프셋 순으로 정렬해 이어지는 페이지끼리 묶어 씁니다.
+ * 한 번에 모을 수 있는 수보다 많으면, 방금 쓴 페이지는 이제 깨끗하므로 다시 훑어 나머지를 씁니다. */
+static void
+file_backed_writeback (struct vm_area *area, void *start, void *end) {
+    struct thread *curr = thread_current ();
+    struct wb_entry small[16];
+    struct wb_batch b;
+    uint8_t *buf = palloc_get_multiple (0, WB_RUN_MAX);
+    void *page = palloc_get_page (0);
+
+    b.entries = page != NULL ? page : small;
+    b.cap = page != NULL ? PGSIZE / sizeof *b.entries : sizeof small / sizeof *small;
+    do {
+        b.cnt = 0;
+        spt_for_each_in_range (&curr->spt, start, end, wb_collect, &b);
+        if (b.cnt == 0)
+            break;
+        pml4_flush_tlb (curr->pml4);
+        qsort (b.entries, b.cnt, sizeof *b.entries, wb_compare);
+        wb_write (area->file, b.entries, b.cnt, buf);
+    } while (b.cnt == b.cap);
+
+    if (buf != NULL)
+        palloc_free_multiple (buf, WB_RUN_MAX);
+    if (page != NULL)
+        palloc_free_page (page);
+}
+
+/* msync 작업을 수행합니다. [ADDR, ADDR + LENGTH)와 겹치는 공유 매핑의 dirty 페이지를 파일에 씁니다.
+ * 쓰기는 언제나 끝날 때까지 기다리므로 MS_ASYNC도 MS_SYNC처럼 동작하고,
+ * 파일 내용을 따로 캐시하지 않으므로 MS_INVALIDATE는 할 일이 없습니다.
+ * ADDR가 정렬되지 않았거나, 플래그가 잘못되었거나, 범위에 매핑이 없는 부분이 있으면 false. */
+bool
+do_msync (void *addr, size_t length, int flags) {
+    struct vm_areas *vmas = &thread_current ()->spt.vmas;
+    void *end = pg_round_up (addr + length);
+    void *va = addr;
+
+    if (pg_ofs (addr) != 0 || end < addr || (end > addr && !is_user_vaddr (end - 1))
+            || (flags & ~(MS_ASYNC | MS_INVALIDATE | MS_SYNC)) != 0
+            || (flags & (MS_ASYNC | MS_SYNC)) == (MS_ASYNC | MS_SYNC))
+        return false;
+
+    while (va < end) {
+        struct vm_area *area = vma_find (vmas, va);
+        void *area_end;
+
+        if (area == NULL)
+            return false;
+        area_end = area->end < end ? area->end : end;
+        if (area->shared && area->type == VM_FILE)
+            file_backed_writeback (area, va, area_end);
+        va = area_end;
+    }
+    return true;
+}
+
+/* munmap 할 구간의 페이지 PAGE를 정리합니다. 공유 익명 페이지는 쓸 파일이 없으므로 해제만 합니다. */
+static void
+munmap_page (struct page *page, void *aux UNUSED) {
+    if (page_get_type (page) == VM_SHM) {
+        spt_delete_page (&thread_current ()->spt, page);
+        vm_dealloc_page (page);
+    } else
+        drop_page (page, true);
+}
+
+/* MADV_DONTNEED: 파일 기반 PAGE를 버리고 다음 접근 때 파일에서 다시 읽게 합니다.
+ * 공유 매핑이면 dirty 내용을 먼저 파일에 쓰고, 사적인 매핑이면 바꾼 내용을 버립니다.
+ * 구간에서 만든 페이지가 아니면 다시 만들 수 없으므로 그대로 둡니다. */
+void
+file_backed_discard (struct page *page) {
+    struct vm_area *area = vma_find (&page->owner->spt.vmas, page->va);
+
+    if (area != NULL)
+        drop_page (page, area->shared);
+}
+
+/* ADDR에서 시작하는 mmap 구간을 해제합니다. 만들어진 페이지만 정리하고 파일을 닫거나
+ * 공유 객체의 참조를 내려놓습니다. */
 void
 do_munmap (void *addr) {
     struct thread *curr = thread_current();
-    struct file *file_to_close = NULL;
-    
-    while (true) {
-        struct page* page = spt_find_page(&curr->spt, addr);
-        if (page == NULL)
-            break;
-            
-        // VM_FILE 타입인 경우만 처리
-        if (page_get_type(page) != VM_FILE) {
-            addr += PGSIZE;
-            continue;
-        }
-        
-        struct container *aux = NULL;
-        
-        // 페이지 상태에 따라 올바른 aux 정보 가져오기
-        // uninit_ops는 static이므로 직접 비교할 수 없음
-        // 대신 페이지가 초기화되었는지 frame 존재 여부로 판단
-        if (page->frame != NULL) {
-            // 이미 로드된 페이지 - file.aux 사용
-            aux = (struct container *)page->file.aux;
-        } else {
-            // 아직 로드되지 않은 페이지 - uninit.aux 사용
-            aux = (struct container *)page->uninit.aux;
-        }
-        
-        // write-back 처리 (dirty한 경우만)
-        if (aux && aux->file) {
-            if (!file_to_close) {
-                file_to_close = aux->file; // 첫 번째 파일 참조만 저장
-            }
-            
-            // 페이지가 실제로 메모리에 로드되어 있고 dirty한 경우
-            if (page->frame && page->frame->kva && pml4_is_dirty(curr->pml4, page->va)) {
-                file_write_at(aux->file, page->frame->kva, aux->page_read_bytes, aux->offset);
-                pml4_set_dirty(curr->pml4, page->va, 0);
+    struct vm_area *area = vma_find(&curr->spt.vmas, addr);
+
+    if (area == NULL || area->start != addr || !area->shared)
+        return;
+    // dirty 페이지를 먼저 한꺼번에 써 두면 페이지를 하나씩 정리할 때는 쓸 것이 없음
+    if (area->type == VM_FILE)
+        file_backed_writeback(area, area->start, area->end);
+    spt_for_each_in_range(&curr->spt, area->start, area->end, munmap_page, NULL);
+    // 파일 닫기 (구간이 소유)
+    vma_remove(&curr->spt.vmas, vma_find(&curr->spt.vmas, addr));
+}
+
+/* read()/write()의 BUFFER와 LENGTH, FILE의 현재 위치가 모두 페이지 단위로 맞아서
+ * file_read_direct()나 file_write_direct()로 옮길 수 있으면 true */
+bool
+file_pages_aligned (struct file *file, const void *buffer, size_t length) {
+    return pg_ofs (buffer) == 0 && length >= PGSIZE && length % PGSIZE == 0
+        && file_tell (file) % PGSIZE == 0;
+}
+
+/* FILE의 현재 위치에서 페이지 정렬된 사용자 버퍼 BUFFER로 LENGTH 바이트를 읽고 위치를 옮깁니다.
+ * 읽은 바이트 수를 반환합니다. 사용자 주소로 복사하는 대신 페이지마다 프레임을 고정해서
+ * text 캐시에 있는 내용이면 그 프레임에서, 아니면 디스크에서 커널 주소로 바로 채웁니다.
+ * 채우는 동안 사용자 페이지에 fault가 나지 않고, 새 페이지는 0으로 채우거나 COW로 복사하지 않습니다.
+ * 익명 페이지가 아니거나 파일 끝에 걸린 페이지는 보통처럼 사용자 주소로 읽습니다. filesys_lock을 잡고 호출합니다. */
+off_t
+file_read_direct (struct file *file, void *buffer, size_t length) {
+    struct supplemental_page_table *spt = &thread_current ()->spt;
+    struct inode *inode = file_get_inode (file);
+    off_t pos = file_tell (file), total = 0;
+    size_t i;
+
+    for (i = 0; i < length / PGSIZE; i++) {
+        void *upage = buffer + i * PGSIZE;
+        struct page *page = spt_find_page (spt, upage);
+        struct frame *frame = NULL;
+        off_t n;
+
+        // 페이지 일부만 읽으면 나머지는 원래 내용을 남겨야 하므로 프레임을 바꿀 수 없음
+        if (page != NULL && inode_length (inode) - pos >= PGSIZE)
+            frame = vm_pin_fill_frame (page);
+        if (frame == NULL)
+            n = file_read_at (file, upage, PGSIZE, pos);
+        else {
+            if (vm_read_cached (inode, pos, frame->kva)) {
+                n = PGSIZE;
+                zero_copy_cached++;
+            } else {
+                n = inode_read_at (inode, frame->kva, PGSIZE, pos);
+                // 못 읽은 부분에 이전 주인의 내용이 보이지 않게 함
+                if (n < PGSIZE)
+                    memset (frame->kva + n, 0, PGSIZE - n);
+                zero_copy_disk++;
             }
+            vm_unpin_frame (frame);
         }
-        
-        // aux 구조체 해제
-        if (aux) {
-            free(aux);
-        }
-        
-        // 물리 프레임 해제 (할당되어 있는 경우)
-        if (page->frame) {
-            palloc_free_page(page->frame->kva);
-            free(page->frame);
-        }
-        
-        // 페이지 테이블에서 매핑 제거
-        pml4_clear_page(curr->pml4, page->va);
-        
-        // SPT에서 페이지 제거
-        hash_delete(&curr->spt.pages, &page->hash_elem);
-        
-        // 페이지 구조체 해제
-        free(page);
-        
-        addr += PGSIZE;
-    }
-    
-    // 파일 닫기 (마지막에 한 번만)
-    if (file_to_close) {
-        file_close(file_to_close);
+        if (n <= 0)
+            break;
+        total += n;
+        pos += n;
+        if (n < PGSIZE)
+            break;
     }
+    file_seek (file, pos);
+    return total;
 }
 
+/* 페이지 정렬된 사용자 버퍼 BUFFER의 LENGTH 바이트를 FILE의 현재 위치에 쓰고 위치를 옮깁니다.
+ * 쓴 바이트 수를 반환합니다. 올라와 있는 페이지는 프레임을 고정해서 커널 주소에서 디스크로 바로 쓰고,
+ * 아니면 보통처럼 사용자 주소에서 씁니다. filesys_lock을 잡고 호출합니다. */
+off_t
+file_write_direct (struct file *file, const void *buffer, size_t length) {
+    struct supplemental_page_table *spt = &thread_current ()->spt;
+    off_t pos = file_tell (file), total = 0;
+    size_t i;
+
+    for (i = 0; i < length / PGSIZE; i++) {
+        const void *upage = buffer + i * PGSIZE;
+        struct page *page = spt_find_page (spt, (void *) upage);
+        struct frame *frame = page != NULL ? vm_pin_frame (page) : NULL;
+        off_t n;
+
+        if (frame == NULL)
+            n = file_write_at (file, upage, PGSIZE, pos);
+        else {
+            n = file_write_at (file, frame->kva, PGSIZE, pos);
+            vm_unpin_frame (frame);
+            zero_copy_writes++;
+        }
+        if (n <= 0)
+            break;
+        total += n;
+        pos += n;
+        if (n < PGSIZE)
+            break;
+    }
+    file_seek (file, pos);
+    return total;
+}
@@ -5,6 +5,7 @@
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "vm/inspect.h"
+#include "vm/vm.h"
 
 static void
 inspect (struct intr_frame *f) {
@@ -12,13 +13,26 @@ inspect (struct intr_frame *f) {
 	f->R.rax = PTE_ADDR (pml4_get_page (thread_current ()->pml4, va));
 }
 
+static void
+inspect_vm_event (struct intr_frame *f) {
+	f->R.rax = vm_event_cnt (f->R.rax, f->R.rdx != 0);
+}
+
 /* 가상 메모리 컴포넌트를 테스트하기 위한 도구입니다.
  * int 0x42 인터럽트를 통해 이 함수를 호출할 수 있습니다.
  * 입력:
  *   @RAX - 조사할 가상 주소(Virtual address)
  * 출력:
- *   @RAX - 입력된 가상 주소에 매핑된 물리 주소(Physical address) */
+ *   @RAX - 입력된 가상 주소에 매핑된 물리 주소(Physical address)
+ *
+ * int 0x45 인터럽트로는 VM 이벤트 수를 읽을 수 있습니다(get_vm_event_cnt()).
+ * 입력:
+ *   @RAX - 이벤트 번호(enum vmstat_event)
+ *   @RDX - 0이면 현재 프로세스, 아니면 시스템 전체
+ * 출력:
+ *   @RAX - 이벤트 수. 이벤트 번호가 잘못되었으면 -1 */
 void
 register_inspect_intr (void) {
 	intr_register_int (0x42, 3, INTR_OFF, inspect, "Inspect Virtual Memory");
+	intr_register_int (0x45, 3, INTR_OFF, inspect_vm_event, "Inspect VM Event Count");
 }
@@ -0,0 +1,71 @@
+/* ksm.c: 같은 내용의 익명 페이지를 합치기 위한 프레임 표
+ *
+ * ksmd(vm.c)가 두 번 연속 같은 checksum이 나온 프레임을 checksum으로 찾아볼 수 있게 넣어 둡니다.
+ * 표에는 checksum마다 프레임 하나만 둡니다. 넣은 뒤 내용이 바뀌었을 수 있으므로
+ * 찾은 프레임은 합치기 전에 반드시 내용을 비교해야 합니다.
+ * 프레임은 해제되거나 evict 될 때 표에서 빠집니다. 모든 함수는 frame_lock을 잡고 호출해야 합니다. */
+
+#include "vm/ksm.h"
+#include "vm/vm.h"
+
+size_t ksm_pages_to_scan = KSM_DEFAULT_SCAN;
+unsigned ksm_sleep_ms = KSM_DEFAULT_SLEEP;
+
+static struct hash ksm_frames;    /* 표에 있는 프레임 */
+static size_t ksm_cnt;            /* 표에 있는 프레임 수 */
+
+static uint64_t
+ksm_hash (const struct hash_elem *e, void *aux UNUSED) {
+	return hash_entry (e, struct frame, ksm_elem)->ksm_sum;
+}
+
+static bool
+ksm_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux UNUSED) {
+	return hash_entry (a, struct frame, ksm_elem)->ksm_sum
+		< hash_entry (b, struct frame, ksm_elem)->ksm_sum;
+}
+
+/* 표를 초기화합니다. */
+void
+ksm_init (void) {
+	hash_init (&ksm_frames, ksm_hash, ksm_less, NULL);
+}
+
+/* checksum이 SUM인 프레임을 찾습니다. 없으면 NULL. */
+struct frame *
+ksm_lookup (uint64_t sum) {
+	struct frame key;
+	struct hash_elem *e;
+
+	if (ksm_cnt == 0)
+		return NULL;
+	key.ksm_sum = sum;
+	e = hash_find (&ksm_frames, &key.ksm_elem);
+	return e != NULL ? hash_entry (e, struct frame, ksm_elem) : NULL;
+}
+
+/* FRAME을 자기 ksm_sum으로 표에 넣습니다. 같은 checksum의 프레임이 있으면 넣지 않습니다. */
+void
+ksm_insert (struct frame *frame) {
+	if (!frame->ksm_listed && hash_insert (&ksm_frames, &frame->ksm_elem) == NULL) {
+		frame->ksm_listed = true;
+		ksm_cnt++;
+	}
+}
+
+/* 표에 있다면 FRAME을 뺍니다. ksm_sum을 바꾸기 전에 불러야 합니다. */
+void
+ksm_remove (struct frame *frame) {
+	if (frame->ksm_listed) {
+		hash_delete (&ksm_frames, &frame->ksm_elem);
+		frame->ksm_listed = false;
+		ksm_cnt--;
+	}
+}
+
+/* 표에 있는 프레임 수를 반환합니다. */
+size_t
+ksm_listed_cnt (void) {
+	return ksm_cnt;
+}
@@ -0,0 +1,149 @@
+/* lz.c: 압축 swap에 쓰는 LZ77 계열 압축기
+ *
+ * 4바이트마다 해시 테이블에서 같은 4바이트가 마지막으로 나온 위치를 찾아,
+ * 같으면 최대한 늘려서 (거리, 길이)로, 아니면 그대로(literal) 내보냅니다.
+ * 한 번만 보고 지나가므로 압축률보다 속도를 택한 방식입니다. 형식은 lz.h에 있습니다. */
+
+#include "vm/lz.h"
+#include <stdint.h>
+#include <string.h>
+
+#define HASH_BITS 11                      /* LZ_WORK_SIZE / sizeof (uint16_t)개의 칸 */
+
+static inline uint32_t
+read32 (const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline size_t
+hash32 (uint32_t v) {
+	return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/* OUT에 길이 확장 바이트를 씁니다. 넘치면 NULL을 반환합니다. */
+static uint8_t *
+put_length (uint8_t *out, uint8_t *end, size_t len) {
+	for (; len >= 255; len -= 255) {
+		if (out >= end)
+			return NULL;
+		*out++ = 255;
+	}
+	if (out >= end)
+		return NULL;
+	*out++ = len;
+	return out;
+}
+
+/* literal LIT_LEN바이트와, MATCH_LEN이 0이 아니면 거리 OFFSET의 match 하나를 OUT에 씁니다.
+ * 넘치면 NULL을 반환합니다. */
+static uint8_t *
+put_sequence (uint8_t *out, uint8_t *end, const uint8_t *lit, size_t lit_len,
+		size_t offset, size_t match_len) {
+	uint8_t *token = out++;
+	size_t m = match_len ? match_len - LZ_MIN_MATCH : 0;
+
+	if (token >= end)
+		return NULL;
+	*token = (lit_len < 15 ? lit_len : 15) << 4 | (m < 15 ? m : 15);
+	if (lit_len >= 15 && (out = put_length (out, end, lit_len - 15)) == NULL)
+		return NULL;
+	if ((size_t) (end - out) < lit_len)
+		return NULL;
+	memcpy (out, lit, lit_len);
+	out += lit_len;
+	if (match_len == 0)
+		return out;
+	if (end - out < 2)
+		return NULL;
+	*out++ = offset & 0xff;
+	*out++ = offset >> 8;
+	if (m >= 15 && (out = put_length (out, end, m - 15)) == NULL)
+		return NULL;
+	return out;
+}
+
+/* SRC의 SRC_LEN바이트를 압축해 DST에 DST_CAP바이트 이하로 씁니다.
+ * WORK는 LZ_WORK_SIZE바이트의 작업 공간입니다. 압축한 길이를 반환하고,
+ * DST_CAP에 들어가지 않으면 0을 반환합니다. SRC_LEN은 65535 이하여야 합니다. */
+size_t
+lz_compress (const void *src_, size_t src_len, void *dst_, size_t dst_cap,
+		void *work) {
+	const uint8_t *src = src_;
+	uint8_t *out = dst_, *end = out + dst_cap;
+	uint16_t *table = work;
+	size_t ip = 0, anchor = 0;
+
+	memset (table, 0, LZ_WORK_SIZE);
+	while (ip + LZ_MIN_MATCH <= src_len) {
+		uint32_t seq = read32 (src + ip);
+		size_t h = hash32 (seq), ref = table[h], len;
+
+		table[h] = ip;
+		if (ref >= ip || read32 (src + ref) != seq) {
+			ip++;
+			continue;
+		}
+		len = LZ_MIN_MATCH;
+		while (ip + len < src_len && src[ref + len] == src[ip + len])
+			len++;
+		out = put_sequence (out, end, src + anchor, ip - anchor, ip - ref, len);
+		if (out == NULL)
+			return 0;
+		ip += len;
+		anchor = ip;
+	}
+	out = put_sequence (out, end, src + anchor, src_len - anchor, 0, 0);
+	return out != NULL ? (size_t) (out - (uint8_t *) dst_) : 0;
+}
+
+/* IN에서 길이 확장 바이트를 읽어 *LEN에 더합니다. 입력이 끝나면 false. */
+static bool
+get_length (const uint8_t **in, const uint8_t *end, size_t *len) {
+	uint8_t b;
+
+	do {
+		if (*in >= end)
+			return false;
+		b = *(*in)++;
+		*len += b;
+	} while (b == 255);
+	return true;
+}
+
+/* lz_compress()로 압축한 SRC_LEN바이트를 풀어 DST에 정확히 DST_LEN바이트를 씁니다.
+ * 데이터가 깨졌거나 길이가 맞지 않으면 false를 반환합니다. */
+bool
+lz_decompress (const void *src, size_t src_len, void *dst_, size_t dst_len) {
+	const uint8_t *in = src, *in_end = in + src_len;
+	uint8_t *dst = dst_, *out = dst, *out_end = dst + dst_len;
+
+	while (in < in_end) {
+		uint8_t token = *in++;
+		size_t lit = token >> 4, match = token & 15, offset;
+
+		if (lit == 15 && !get_length (&in, in_end, &lit))
+			return false;
+		if ((size_t) (in_end - in) < lit || (size_t) (out_end - out) < lit)
+			return false;
+		memcpy (out, in, lit);
+		in += lit;
+		out += lit;
+		if (in == in_end)
+			break;
+
+		if (in_end - in < 2)
+			return false;
+		offset = in[0] | (in[1] << 8);
+		in += 2;
+		if (match == 15 && !get_length (&in, in_end, &match))
+			return false;
+		match += LZ_MIN_MATCH;
+		if (offset == 0 || offset > (size_t) (out - dst)
+				|| (size_t) (out_end - out) < match)
+			return false;
+		/* 겹칠 수 있으므로 한 바이트씩 */
+		for (; match > 0; match--, out++)
+			*out = out[-offset];
+	}
+	return out == out_end;
+}
@@ -0,0 +1,195 @@
+/* radix.c: 가상 주소로 찾는 4단계 radix tree
+ *
+ * 하드웨어 페이지 테이블과 같은 모양입니다. 노드 하나는 512개의 포인터를 담은 커널 페이지 하나이고,
+ * 단계마다 PML4/PDPE/PDX/PTX와 같은 9비트로 다음 노드를 고릅니다.
+ * 해시와 달리 키를 해시하거나 bucket 목록을 따라갈 필요가 없고, 커지면서 다시 해시하지도 않습니다.
+ * 마지막으로 찾은 잎 노드를 기억해 두므로 가까운 주소를 연달아 찾으면 한 번에 끝납니다.
+ * 빈 노드는 radix_walk()가 지나가면서 풀어 줍니다. */
+
+#include "vm/radix.h"
+#include <debug.h>
+#include "threads/palloc.h"
+#include "threads/pte.h"
+#include "threads/vaddr.h"
+
+#define RADIX_FANOUT 512
+#define RADIX_LEVELS 4
+
+struct radix_node {
+	void *slot[RADIX_FANOUT];   /* 아래 노드, 잎이면 값 */
+};
+
+/* LEVEL 단계(잎이 0) 노드에서 VA가 들어갈 칸 번호 */
+static inline size_t
+slot_index (uint64_t va, int level) {
+	return (va >> (PTXSHIFT + 9 * level)) & (RADIX_FANOUT - 1);
+}
+
+static struct radix_node *
+node_alloc (void) {
+	return palloc_get_page (PAL_ZERO);
+}
+
+static void
+node_free (struct radix *r, struct radix_node *node) {
+	if (r->leaf == node)
+		r->leaf = NULL;
+	palloc_free_page (node);
+}
+
+static bool
+node_empty (const struct radix_node *node) {
+	size_t i;
+
+	for (i = 0; i < RADIX_FANOUT; i++)
+		if (node->slot[i] != NULL)
+			return false;
+	return true;
+}
+
+/* 빈 트리로 초기화합니다. */
+void
+radix_init (struct radix *r) {
+	r->root = NULL;
+	r->cnt = 0;
+	r->leaf = NULL;
+	r->leaf_tag = 0;
+}
+
+/* VA가 속한 잎 노드를 반환합니다. 없으면 CREATE일 때 만들고, 아니면 NULL을 반환합니다.
+ * 메모리가 없어도 NULL. */
+static struct radix_node *
+leaf_of (struct radix *r, uint64_t va, bool create) {
+	uint64_t tag = va >> PDXSHIFT;
+	struct radix_node **slot = &r->root;
+	int level;
+
+	if (r->leaf != NULL && r->leaf_tag == tag)
+		return r->leaf;
+	for (level = RADIX_LEVELS - 1; ; level--) {
+		if (*slot == NULL) {
+			if (!create || (*slot = node_alloc ()) == NULL)
+				return NULL;
+		}
+		if (level == 0)
+			break;
+		slot = (struct radix_node **) &(*slot)->slot[slot_index (va, level)];
+	}
+	r->leaf = *slot;
+	r->leaf_tag = tag;
+	return *slot;
+}
+
+/* VA의 값을 반환합니다. 없으면 NULL. */
+void *
+radix_find (struct radix *r, const void *va) {
+	struct radix_node *leaf = leaf_of (r, (uint64_t) va, false);
+
+	return leaf != NULL ? leaf->slot[slot_index ((uint64_t) va, 0)] : NULL;
+}
+
+/* VA에 VALUE를 넣습니다. 이미 값이 있거나 노드를 만들 메모리가 없으면 false를 반환합니다. */
+bool
+radix_insert (struct radix *r, const void *va, void *value) {
+	struct radix_node *leaf = leaf_of (r, (uint64_t) va, true);
+	void **slot;
+
+	ASSERT (value != NULL);
+	if (leaf == NULL)
+		return false;
+	slot = &leaf->slot[slot_index ((uint64_t) va, 0)];
+	if (*slot != NULL)
+		return false;
+	*slot = value;
+	r->cnt++;
+	return true;
+}
+
+/* VA의 값을 빼고 반환합니다. 없으면 NULL. 빈 노드는 바로 풀지 않습니다. */
+void *
+radix_remove (struct radix *r, const void *va) {
+	struct radix_node *leaf = leaf_of (r, (uint64_t) va, false);
+	void **slot, *value;
+
+	if (leaf == NULL)
+		return NULL;
+	slot = &leaf->slot[slot_index ((uint64_t) va, 0)];
+	value = *slot;
+	if (value != NULL) {
+		*slot = NULL;
+		r->cnt--;
+	}
+	return value;
+}
+
+/* BASE부터를 맡은 LEVEL 단계 NODE 아래에서 [START, END) 안의 값마다 FN을 부릅니다.
+ * 그 사이에 값이 빠져 NODE가 비었으면 true를 반환합니다. */
+static bool
+walk (struct radix *r, struct radix_node *node, int level, uint64_t base,
+		uint64_t start, uint64_t end, radix_func *fn, void *aux) {
+	uint64_t span = 1ULL << (PTXSHIFT + 9 * level);
+	size_t i = start > base ? (start - base) / span : 0;
+	bool removed = false;
+
+	for (; i < RADIX_FANOUT && base + i * span < end; i++) {
+		void *child = node->slot[i];
+
+		if (child == NULL)
+			continue;
+		if (level == 0) {
+			size_t cnt = r->cnt;
+
+			fn (child, aux);
+			removed |= r->cnt != cnt;
+		} else if (walk (r, child, level - 1, base + i * span, start, end, fn, aux)) {
+			node_free (r, child);
+			node->slot[i] = NULL;
+			removed = true;
+		}
+	}
+	return removed && node_empty (node);
+}
+
+/* [START, END) 안의 값마다 주소 순서로 FN(value, AUX)를 부릅니다.
+ * FN은 자기가 받은 값을 radix_remove()로 빼도 되며, 그래서 빈 노드는 그 자리에서 풀립니다.
+ * 다른 값을 넣거나 빼면 안 됩니다. */
+void
+radix_walk (struct radix *r, const void *start, const void *end,
+		radix_func *fn, void *aux) {
+	if (r->root != NULL
+			&& walk (r, r->root, RADIX_LEVELS - 1, 0, (uint64_t) start,
+				(uint64_t) end, fn, aux)) {
+		node_free (r, r->root);
+		r->root = NULL;
+	}
+}
+
+/* LEVEL 단계 NODE 아래의 값마다 FN을 부르고 노드를 모두 풉니다. */
+static void
+destroy (struct radix *r, struct radix_node *node, int level,
+		radix_func *fn, void *aux) {
+	size_t i;
+
+	for (i = 0; i < RADIX_FANOUT; i++) {
+		void *child = node->slot[i];
+
+		if (child == NULL)
+			continue;
+		if (level == 0) {
+			if (fn != NULL)
+				fn (child, aux);
+		} else
+			destroy (r, child, level - 1, fn, aux);
+		node->slot[i] = NULL;
+	}
+	node_free (r, node);
+}
+
+/* 모든 값에 FN(value, AUX)를 부르고(FN이 NULL이 아니면) 트리를 비웁니다.
+ * FN이 부르는 동안 트리를 찾아보면 아직 지나가지 않은 값만 보입니다. */
+void
+radix_destroy (struct radix *r, radix_func *fn, void *aux) {
+	if (r->root != NULL)
+		destroy (r, r->root, RADIX_LEVELS - 1, fn, aux);
+	radix_init (r);
+}
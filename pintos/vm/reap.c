@@ -0,0 +1,99 @@
+/* reap.c: 종료한 프로세스의 주소 공간을 정리하는 reaper 스레드
+ *
+ * process_exit()은 공유 mmap 구간을 파일에 쓴 뒤 나머지 주소 공간을 이곳 큐에 넘기고 부모에게 종료를 알립니다.
+ * reaper는 큐에서 스레드를 꺼내 spt_teardown()으로 페이지를 묶음 단위로 정리하고 page table을 해제합니다.
+ * 페이지의 owner가 그 스레드를 가리키므로, 종료하는 스레드는 reaper가 끝낼 때까지 reap_sema에서 기다립니다. */
+
+#include "vm/reap.h"
+#include <list.h>
+#include "vm/vm.h"
+#include "threads/interrupt.h"
+#include "threads/mmu.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+bool reap_enabled = true;
+
+static struct list reap_queue;     /* 정리를 기다리는 스레드 */
+static bool reap_busy;             /* 큐에서 꺼낸 스레드를 정리하는 중 */
+static struct lock reap_lock;      /* 위의 둘을 보호 */
+static struct condition reap_work; /* 큐에 스레드가 들어옴 */
+static struct condition reap_idle; /* 큐가 비고 정리 중인 것도 없음 */
+static bool reap_started;
+
+/* 스레드 T의 주소 공간을 정리합니다. T는 reap_sema에서 기다리고 있습니다. */
+static void
+reap (struct thread *t) {
+	enum intr_level old_level;
+	uint64_t *pml4;
+
+	spt_teardown (t);
+
+	/* T가 다시 실행될 때 해제한 page table을 켜지 않도록 먼저 지움 */
+	old_level = intr_disable ();
+	pml4 = t->pml4;
+	t->pml4 = NULL;
+	intr_set_level (old_level);
+	/* 매핑된 물리 페이지는 spt_teardown()이 이미 돌려줬으므로 table만 해제함 */
+	pml4_destroy_tables (pml4);
+
+	sema_up (&t->reap_sema);
+}
+
+static void
+reaper (void *aux UNUSED) {
+	lock_acquire (&reap_lock);
+	for (;;) {
+		struct thread *t;
+
+		while (list_empty (&reap_queue)) {
+			reap_busy = false;
+			cond_broadcast (&reap_idle, &reap_lock);
+			cond_wait (&reap_work, &reap_lock);
+		}
+		t = list_entry (list_pop_front (&reap_queue), struct thread, reap_elem);
+		reap_busy = true;
+		lock_release (&reap_lock);
+
+		reap (t);
+
+		lock_acquire (&reap_lock);
+	}
+}
+
+/* reaper 스레드를 시작합니다. */
+void
+reap_init (void) {
+	list_init (&reap_queue);
+	lock_init (&reap_lock);
+	cond_init (&reap_work);
+	cond_init (&reap_idle);
+	if (reap_enabled
+			&& thread_create ("reaper", PRI_DEFAULT, reaper, NULL) != TID_ERROR)
+		reap_started = true;
+}
+
+/* 종료하는 스레드 T의 주소 공간 정리를 reaper에 맡깁니다.
+ * 맡겼으면 true를 반환하며, T는 스레드를 끝내기 전에 T->reap_sema를 기다려야 합니다.
+ * false이면 호출자가 직접 정리해야 합니다. */
+bool
+reap_submit (struct thread *t) {
+	if (!reap_started || t->pml4 == NULL)
+		return false;
+	lock_acquire (&reap_lock);
+	list_push_back (&reap_queue, &t->reap_elem);
+	cond_signal (&reap_work, &reap_lock);
+	lock_release (&reap_lock);
+	return true;
+}
+
+/* 맡긴 주소 공간을 reaper가 모두 정리할 때까지 기다립니다. 전원을 끄기 전에 부릅니다. */
+void
+reap_drain (void) {
+	if (!reap_started)
+		return;
+	lock_acquire (&reap_lock);
+	while (!list_empty (&reap_queue) || reap_busy)
+		cond_wait (&reap_idle, &reap_lock);
+	lock_release (&reap_lock);
+}
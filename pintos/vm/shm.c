@@ -0,0 +1,214 @@
+/* shm.c: 프로세스끼리 공유하는 익명 메모리
+ *
+ * mmap()에 MAP_ANONYMOUS를 주면 파일 없이 0으로 시작하는 공유 객체를 만들어 구간(VMA)에 답니다.
+ * fork한 자식은 구간을 복사하면서 같은 객체를 가리키므로, 복사하지 않고 공유합니다.
+ * 객체는 페이지마다 그 페이지를 담은 프레임이나 swap slot을 기억합니다. 프로세스의 페이지는
+ * 처음 접근할 때 객체에 프레임이 있으면 그 프레임을 쓰기 가능하게 함께 매핑하고(vm.c의 shm_claim),
+ * 없으면 swap이나 0으로 새 프레임을 채워 객체에 기록합니다.
+ * 프레임은 익명 페이지처럼 swap으로 evict 되며, 그때 모든 프로세스의 매핑이 함께 끊깁니다.
+ * 객체의 slot은 frame_lock 아래에서 바뀌고, 객체의 lock은 한 페이지를 두 프로세스가 동시에 읽어 오지 않게 막습니다. */
+
+#include "vm/shm.h"
+#include <mman.h>
+#include <string.h>
+#include "vm/vm.h"
+#include "vm/swap.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/vaddr.h"
+
+static bool shm_swap_in (struct page *page, void *kva);
+static bool shm_swap_out (struct page *page);
+static void shm_destroy (struct page *page);
+
+static const struct page_operations shm_ops = {
+	.swap_in = shm_swap_in,
+	.swap_out = shm_swap_out,
+	.destroy = shm_destroy,
+	.type = VM_SHM,
+};
+
+/* PAGE_CNT 페이지짜리 객체를 만듭니다. 참조 하나를 가지고 시작합니다. 메모리가 없으면 NULL. */
+struct shm *
+shm_create (size_t page_cnt) {
+	struct shm *obj = malloc (sizeof *obj);
+	size_t i;
+
+	if (obj == NULL)
+		return NULL;
+	obj->slots = malloc (page_cnt * sizeof *obj->slots);
+	if (obj->slots == NULL) {
+		free (obj);
+		return NULL;
+	}
+	for (i = 0; i < page_cnt; i++) {
+		obj->slots[i].frame = NULL;
+		obj->slots[i].swap_index = SWAP_ERROR;
+		obj->slots[i].held = false;
+	}
+	obj->page_cnt = page_cnt;
+	obj->ref_cnt = 1;
+	lock_init (&obj->lock);
+	return obj;
+}
+
+/* OBJ의 참조를 하나 늘립니다. */
+void
+shm_get (struct shm *obj) {
+	enum intr_level old_level = intr_disable ();
+	obj->ref_cnt++;
+	intr_set_level (old_level);
+}
+
+/* OBJ의 참조를 하나 내려놓습니다. 마지막이면 swap slot과 객체가 붙잡아 둔 프레임을 돌려주고 객체를 해제합니다.
+ * 그 전에 객체를 매핑하던 페이지는 모두 정리되어 있어야 합니다. frame_lock을 잡지 않고 호출해야 합니다. */
+void
+shm_put (struct shm *obj) {
+	enum intr_level old_level = intr_disable ();
+	bool last = --obj->ref_cnt == 0;
+	size_t i;
+
+	intr_set_level (old_level);
+	if (!last)
+		return;
+	for (i = 0; i < obj->page_cnt; i++) {
+		struct shm_slot *slot = &obj->slots[i];
+
+		ASSERT (slot->frame == NULL || slot->held);
+		if (slot->held)
+			vm_unpin_frame (slot->frame);
+		if (slot->swap_index != SWAP_ERROR)
+			swap_free (slot->swap_index);
+	}
+	free (obj->slots);
+	free (obj);
+}
+
+/* 공유 익명 페이지를 초기화합니다. uninit 페이지의 aux로 받은 객체와, 페이지를 담은 구간에서 구한
+ * 페이지 번호를 기록합니다. 내용은 채우지 않습니다. 어느 프레임을 쓸지는 shm_claim()이 객체를 보고 정합니다. */
+bool
+shm_initializer (struct page *page, enum vm_type type UNUSED, void *kva UNUSED) {
+	struct shm *obj = page->uninit.aux;
+	struct vm_area *area = vma_find (&page->owner->spt.vmas, page->va);
+
+	ASSERT (area != NULL && area->shm == obj);
+	page->operations = &shm_ops;
+	page->shm.obj = obj;
+	page->shm.idx = (page->va - area->start) / PGSIZE;
+	return true;
+}
+
+/* 구간 AREA 안의 VA에 공유 익명 페이지를 만들어 SPT에 넣습니다. */
+bool
+shm_fault_in (struct vm_area *area, void *va) {
+	return vm_alloc_page_with_initializer (VM_SHM, va, area->writable, NULL, area->shm);
+}
+
+/* 객체에 프레임이 없는 PAGE의 내용을 KVA에 채웁니다. swap에 있으면 읽어 오고 slot을 돌려주며,
+ * 한 번도 쓰지 않은 페이지면 0으로 채웁니다. 객체의 lock을 잡고 호출해야 합니다. */
+static bool
+shm_swap_in (struct page *page, void *kva) {
+	struct shm_slot *slot = &page->shm.obj->slots[page->shm.idx];
+
+	if (slot->swap_index == SWAP_ERROR) {
+		memset (kva, 0, PGSIZE);
+		return true;
+	}
+	swap_read (slot->swap_index, kva);
+	swap_free (slot->swap_index);
+	slot->swap_index = SWAP_ERROR;
+	return true;
+}
+
+/* PAGE의 프레임을 swap에 써서 내보냅니다. 프레임을 매핑한 모든 프로세스의 매핑을 끊고
+ * 객체에는 프레임 대신 swap slot을 기록합니다. frame_lock을 잡고 호출해야 합니다. */
+static bool
+shm_swap_out (struct page *page) {
+	struct frame *frame = page->frame;
+	struct list_elem *e;
+	size_t idx = swap_alloc (page);
+
+	if (idx == SWAP_ERROR)
+		return false;
+	for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e)) {
+		struct page *p = list_entry (e, struct page, share_elem);
+		pml4_clear_page (p->owner->pml4, p->va);
+	}
+	swap_write (idx, frame->kva);
+	shm_swap_commit (frame, idx);
+	return true;
+}
+
+/* 내용을 swap slot IDX에 다 쓴 FRAME을 객체에서 떼어 냅니다. 매핑한 페이지들은 프레임을 잃고
+ * 객체는 프레임 대신 IDX를 기억합니다. 페이지의 매핑은 이미 끊겨 있어야 합니다. frame_lock을 잡고 호출해야 합니다. */
+void
+shm_swap_commit (struct frame *frame, size_t idx) {
+	struct page *page = frame->page;
+	struct shm_slot *slot = &page->shm.obj->slots[page->shm.idx];
+	struct list_elem *e;
+
+	for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e))
+		list_entry (e, struct page, share_elem)->frame = NULL;
+	slot->frame = NULL;
+	slot->swap_index = idx;
+}
+
+/* 프레임을 마지막으로 매핑하던 PAGE가 프레임을 놓으려 합니다. 객체를 매핑한 다른 구간이 있으면
+ * 나중에 그쪽에서 읽을 수 있게 내용을 swap에 옮겨 둡니다. swap이 가득 차 있으면 내용을 잃지 않도록
+ * 프레임을 고정해서 객체에 남겨 두고, 다음에 매핑하는 shm_claim()이나 마지막 shm_put()이 풀어 줍니다.
+ * frame_lock을 잡고 호출해야 합니다. */
+void
+shm_frame_unmapped (struct page *page) {
+	struct shm *obj = page->shm.obj;
+	struct shm_slot *slot = &obj->slots[page->shm.idx];
+	size_t idx;
+
+	if (obj->ref_cnt > 1) {
+		idx = swap_alloc (page);
+		if (idx == SWAP_ERROR) {
+			page->frame->pin_cnt++;
+			slot->held = true;
+			return;
+		}
+		swap_write (idx, page->frame->kva);
+		slot->swap_index = idx;
+	}
+	slot->frame = NULL;
+}
+
+/* 공유 익명 페이지를 파괴합니다. 객체는 구간이 가지고 있으므로 프레임만 놓습니다. */
+static void
+shm_destroy (struct page *page) {
+	vm_free_frame (page);
+}
+
+/* 현재 프로세스의 ADDR에 LENGTH 바이트의 공유 익명 구간을 만듭니다. 내용은 0으로 시작하며,
+ * 이후 fork한 자식과 공유됩니다. 실패하면 NULL. */
+void *
+shm_mmap (void *addr, size_t length, bool writable) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	void *end = pg_round_up (addr + length);
+	struct vm_area area;
+
+	if (addr == NULL || pg_ofs (addr) != 0 || length == 0 || end <= addr
+			|| !is_user_vaddr (end - 1))
+		return NULL;
+	if (vma_overlaps (&spt->vmas, addr, end) || !spt_range_empty (spt, addr, end))
+		return NULL;
+
+	memset (&area, 0, sizeof area);
+	area.start = addr;
+	area.end = end;
+	area.type = VM_SHM;
+	area.writable = writable;
+	area.shared = true;
+	area.advice = MADV_NORMAL;
+	area.shm = shm_create ((end - addr) / PGSIZE);
+	if (area.shm == NULL)
+		return NULL;
+	if (!vma_insert (&spt->vmas, &area)) {
+		shm_put (area.shm);
+		return NULL;
+	}
+	return addr;
+}
@@ -0,0 +1,220 @@
+/* swap.c: swap 디스크의 slot을 관리합니다.
+ *
+ * slot은 SWAP_CLUSTER개씩 cluster로 묶고, cluster마다 빈 slot 수를 둡니다.
+ * 프로세스는 주소 공간의 SWAP_CLUSTER 페이지 단위 창(window)마다 빈 cluster 하나를 예약해서,
+ * 창 안의 페이지를 같은 순서로 예약한 cluster의 slot에 놓습니다.
+ * 그래서 가상 주소로 이웃한 페이지가 디스크에서도 이웃하고, swap-in 때 이어서 읽어 올 수 있습니다.
+ * 예약한 slot을 쓸 수 없으면 next-fit으로 빈 slot이 있는 cluster를 찾습니다.
+ * slot마다 참조 수를 두어 fork 이후 공유를 허용하며, 해제는 상수 시간입니다.
+ * 읽고 쓰기는 먼저 압축 캐시(zswap.c)를 거치고, 거기에 없거나 들어가지 않는 페이지만 디스크로 갑니다. */
+
+#include "vm/swap.h"
+#include "vm/vm.h"
+#include "vm/zswap.h"
+#include "devices/disk.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+#define SECTORS_PER_SLOT (PGSIZE / DISK_SECTOR_SIZE)
+
+struct swap_cluster {
+	uint8_t free_cnt;       /* 빈 slot 수 */
+	bool reserved;          /* 어떤 프로세스가 예약했는지 */
+};
+
+static struct disk *swap_disk;
+static size_t cluster_cnt;
+static uint16_t *slot_ref;             /* slot별 참조 수. 0이면 빈 slot */
+static struct swap_cluster *clusters;
+static size_t cursor;                  /* next-fit 탐색을 시작할 cluster */
+static size_t used_cnt;                /* 사용 중인 slot 수 */
+static struct lock swap_lock;          /* 위의 모든 것을 보호. frame_lock보다 나중에, zswap_lock보다 먼저 잡음 */
+
+/* swap 디스크를 찾고 slot 관리 구조를 만듭니다. */
+void
+swap_init (void) {
+	size_t i;
+
+	lock_init (&swap_lock);
+	swap_disk = disk_get (1, 1);
+	if (swap_disk == NULL)
+		return;
+
+	/* cluster에 다 차지 않는 끝의 slot은 쓰지 않음 */
+	cluster_cnt = disk_size (swap_disk) / SECTORS_PER_SLOT / SWAP_CLUSTER;
+	slot_ref = calloc (cluster_cnt * SWAP_CLUSTER, sizeof *slot_ref);
+	clusters = calloc (cluster_cnt, sizeof *clusters);
+	if (slot_ref == NULL || clusters == NULL)
+		PANIC ("swap_init: out of memory");
+	for (i = 0; i < cluster_cnt; i++)
+		clusters[i].free_cnt = SWAP_CLUSTER;
+	zswap_init (cluster_cnt * SWAP_CLUSTER);
+}
+
+/* 빈 SLOT을 차지합니다. 이미 쓰이고 있으면 false. swap_lock을 잡고 호출해야 합니다. */
+static bool
+slot_take (size_t slot) {
+	if (slot_ref[slot] != 0)
+		return false;
+	slot_ref[slot] = 1;
+	clusters[slot / SWAP_CLUSTER].free_cnt--;
+	used_cnt++;
+	return true;
+}
+
+/* cursor부터 next-fit으로 cluster를 찾습니다. WHOLE이면 통째로 비어 있는 cluster만,
+ * 아니면 빈 slot이 하나라도 있는 cluster를 찾되 다른 프로세스가 예약한 cluster는 마지막에 봅니다.
+ * 없으면 SWAP_ERROR. swap_lock을 잡고 호출해야 합니다. */
+static size_t
+cluster_find (bool whole) {
+	int pass;
+	size_t i;
+
+	for (pass = 0; pass < (whole ? 1 : 2); pass++)
+		for (i = 0; i < cluster_cnt; i++) {
+			size_t c = (cursor + i) % cluster_cnt;
+			struct swap_cluster *cl = &clusters[c];
+
+			if (cl->reserved && pass == 0)
+				continue;
+			if (whole ? cl->free_cnt == SWAP_CLUSTER : cl->free_cnt > 0) {
+				cursor = c;
+				return c;
+			}
+		}
+	return SWAP_ERROR;
+}
+
+/* PAGE를 내보낼 slot을 하나 할당하고 참조 수 1로 돌려줍니다.
+ * 가능하면 소유 프로세스가 PAGE의 창에 예약한 cluster 안, 창 안의 위치와 같은 slot을 줍니다.
+ * 디스크가 가득 차 있으면 SWAP_ERROR. */
+size_t
+swap_alloc (struct page *page) {
+	struct swap_reservation *rsv = &page->owner->swap_rsv;
+	uint64_t window = pg_no (page->va) / SWAP_CLUSTER;
+	size_t ofs = pg_no (page->va) % SWAP_CLUSTER;
+	size_t slot = SWAP_ERROR;
+	size_t c, i;
+
+	lock_acquire (&swap_lock);
+	if (!rsv->active || rsv->window != window) {
+		c = cluster_find (true);
+		if (c != SWAP_ERROR) {
+			if (rsv->active)
+				clusters[rsv->cluster].reserved = false;
+			clusters[c].reserved = true;
+			rsv->active = true;
+			rsv->window = window;
+			rsv->cluster = c;
+		}
+	}
+	if (rsv->active && rsv->window == window
+			&& slot_take (rsv->cluster * SWAP_CLUSTER + ofs))
+		slot = rsv->cluster * SWAP_CLUSTER + ofs;
+	else if ((c = cluster_find (false)) != SWAP_ERROR)
+		for (i = 0; i < SWAP_CLUSTER; i++)
+			if (slot_take (c * SWAP_CLUSTER + i)) {
+				slot = c * SWAP_CLUSTER + i;
+				break;
+			}
+	lock_release (&swap_lock);
+	return slot;
+}
+
+/* SLOT을 가리키는 페이지가 하나 늘었습니다. */
+void
+swap_dup (size_t slot) {
+	lock_acquire (&swap_lock);
+	slot_ref[slot]++;
+	lock_release (&swap_lock);
+}
+
+/* SLOT의 참조를 하나 내려놓습니다. swap_lock을 잡고 호출해야 합니다. */
+static void
+slot_put (size_t slot) {
+	ASSERT (slot_ref[slot] > 0);
+	if (--slot_ref[slot] == 0) {
+		/* 다시 할당되기 전에 지워야 새 내용과 섞이지 않음 */
+		zswap_invalidate (slot);
+		clusters[slot / SWAP_CLUSTER].free_cnt++;
+		used_cnt--;
+	}
+}
+
+/* SLOT의 참조를 하나 내려놓고, 마지막이었으면 slot을 비웁니다. */
+void
+swap_free (size_t slot) {
+	lock_acquire (&swap_lock);
+	slot_put (slot);
+	lock_release (&swap_lock);
+}
+
+/* SLOTS의 CNT개 slot 참조를 한꺼번에 내려놓습니다.
+ * 주소 공간을 통째로 정리할 때 slot마다 swap_lock을 잡지 않도록 합니다. */
+void
+swap_free_multiple (const size_t *slots, size_t cnt) {
+	size_t i;
+
+	if (cnt == 0)
+		return;
+	lock_acquire (&swap_lock);
+	for (i = 0; i < cnt; i++)
+		slot_put (slots[i]);
+	lock_release (&swap_lock);
+}
+
+/* SLOT이 할당되어 있는지 알려줍니다. */
+bool
+swap_in_use (size_t slot) {
+	return slot < cluster_cnt * SWAP_CLUSTER && slot_ref[slot] != 0;
+}
+
+/* SLOT의 내용을 KVA로 읽어 옵니다. */
+void
+swap_read (size_t slot, void *kva) {
+	if (!zswap_load (slot, kva))
+		swap_disk_read (slot, kva);
+	vm_event (VMSTAT_SWAP_IN, 1);
+}
+
+/* KVA의 한 페이지를 SLOT에 씁니다. */
+void
+swap_write (size_t slot, const void *kva) {
+	if (!zswap_store (slot, kva))
+		swap_disk_write (slot, kva);
+	vm_event (VMSTAT_SWAP_OUT, 1);
+}
+
+/* 압축 캐시를 거치지 않고 디스크의 SLOT 자리를 KVA로 읽어 옵니다. */
+void
+swap_disk_read (size_t slot, void *kva) {
+	for (size_t i = 0; i < SECTORS_PER_SLOT; i++)
+		disk_read (swap_disk, slot * SECTORS_PER_SLOT + i, kva + DISK_SECTOR_SIZE * i);
+}
+
+/* 압축 캐시를 거치지 않고 KVA의 한 페이지를 디스크의 SLOT 자리에 씁니다. */
+void
+swap_disk_write (size_t slot, const void *kva) {
+	for (size_t i = 0; i < SECTORS_PER_SLOT; i++)
+		disk_write (swap_disk, slot * SECTORS_PER_SLOT + i, kva + DISK_SECTOR_SIZE * i);
+}
+
+/* 프로세스 T가 예약한 cluster를 풀어 줍니다. 이미 쓴 slot은 그대로 둡니다. */
+void
+swap_release (struct thread *t) {
+	lock_acquire (&swap_lock);
+	if (t->swap_rsv.active) {
+		clusters[t->swap_rsv.cluster].reserved = false;
+		t->swap_rsv.active = false;
+	}
+	lock_release (&swap_lock);
+}
+
+/* 전체 slot 수와 사용 중인 slot 수(페이지 단위)를 알려줍니다. */
+void
+swap_stats (size_t *total, size_t *used) {
+	*total = cluster_cnt * SWAP_CLUSTER;
+	*used = used_cnt;
+}
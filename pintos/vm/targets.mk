@@ -3,3 +3,13 @@ vm_SRC += vm/uninit.c     # Uninitialized page
 vm_SRC += vm/anon.c       # Anonymous page
 vm_SRC += vm/file.c       # File mapped page
 vm_SRC += vm/inspect.c    # Testing utility
+vm_SRC += vm/swap.c       # Swap slot allocator
+vm_SRC += vm/zswap.c      # Compressed swap cache
+vm_SRC += vm/lz.c         # LZ compressor for zswap
+vm_SRC += vm/text.c       # Shared executable text cache
+vm_SRC += vm/ksm.c        # Same-page merging table
+vm_SRC += vm/vma.c        # Address space regions
+vm_SRC += vm/radix.c      # Radix-tree page table backend
+vm_SRC += vm/shm.c        # Shared anonymous memory
+vm_SRC += vm/reap.c       # Deferred address space teardown
+vm_SRC += vm/uffd.c       # User-level fault handling
@@ -0,0 +1,140 @@
+/* text.c: 실행 파일의 읽기 전용 페이지를 프로세스끼리 공유하는 캐시
+ *
+ * 같은 프로그램을 실행한 프로세스들은 읽기 전용 PT_LOAD 세그먼트의 페이지를
+ * 각자 파일에서 읽는 대신, 먼저 읽은 프로세스의 프레임을 읽기 전용으로 함께 매핑합니다.
+ * 프레임은 (inode, 파일 오프셋)으로 찾습니다. 두 세그먼트가 파일의 한 페이지를 나눠 쓰면
+ * 파일에서 읽은 길이(나머지는 0)가 다를 수 있으므로, 길이까지 같을 때만 공유합니다.
+ * 프레임은 매핑한 페이지가 있는 동안만 캐시에 있고, 해제되거나 evict 될 때 빠집니다.
+ * inode에 쓰거나 inode가 닫힐 때는 해당 범위를 캐시에서 빼서 이후 fault가 파일을 다시 읽게 합니다.
+ * 이미 매핑한 프로세스는 하던 대로 옛 내용을 계속 봅니다. */
+
+#include "vm/text.h"
+#include "vm/vm.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+static struct hash text_frames;   /* 캐시에 있는 프레임 */
+static size_t text_cnt;           /* 캐시에 있는 프레임 수 */
+static struct lock text_lock;     /* 위의 둘과 프레임의 cache_* 필드를 보호. frame_lock보다 나중에 잡음 */
+
+/* text_lookup()과 text_remove()는 text_lock 없이 text_cnt가 0이면 바로 돌아갑니다.
+ * 프레임을 캐시에 넣는 text_insert()도 frame_lock을 잡고 불리므로, frame_lock을 잡은 동안에는
+ * text_cnt가 0에서 늘어날 수 없습니다. 락 없이 줄일 수 있는 것은 text_invalidate()뿐이라,
+ * 0이 아닌 값을 보고 락을 잡은 뒤 항목이 없어져 있어도 찾지 못할 뿐입니다.
+ * frame_lock 없이 불리는 text_invalidate()는 text_lock 아래에서 봅니다. */
+
+static uint64_t
+text_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct frame *f = hash_entry (e, struct frame, cache_elem);
+	uint64_t key[2] = { (uint64_t) f->cache_inode, f->cache_ofs };
+
+	return hash_bytes (key, sizeof key);
+}
+
+static bool
+text_less (const struct hash_elem *a_, const struct hash_elem *b_,
+		void *aux UNUSED) {
+	const struct frame *a = hash_entry (a_, struct frame, cache_elem);
+	const struct frame *b = hash_entry (b_, struct frame, cache_elem);
+
+	if (a->cache_inode != b->cache_inode)
+		return a->cache_inode < b->cache_inode;
+	return a->cache_ofs < b->cache_ofs;
+}
+
+/* 캐시를 초기화합니다. */
+void
+text_init (void) {
+	hash_init (&text_frames, text_hash, text_less, NULL);
+	lock_init (&text_lock);
+}
+
+/* INODE의 OFS에서 READ_BYTES만큼 읽고 나머지를 0으로 채운 페이지를 담은 프레임을 찾습니다.
+ * 없으면 NULL. 돌려받은 프레임이 풀리지 않도록 frame_lock을 잡고 호출해야 합니다. */
+struct frame *
+text_lookup (struct inode *inode, off_t ofs, size_t read_bytes) {
+	struct frame key, *frame = NULL;
+	struct hash_elem *e;
+
+	if (text_cnt == 0)
+		return NULL;
+	key.cache_inode = inode;
+	key.cache_ofs = ofs;
+	lock_acquire (&text_lock);
+	e = hash_find (&text_frames, &key.cache_elem);
+	if (e != NULL) {
+		frame = hash_entry (e, struct frame, cache_elem);
+		if (frame->cache_bytes != read_bytes)
+			frame = NULL;
+	}
+	lock_release (&text_lock);
+	return frame;
+}
+
+/* 방금 파일에서 채운 FRAME을 캐시에 넣습니다. 같은 자리의 프레임이 이미 있으면
+ * (두 프로세스가 동시에 읽었거나, 길이가 다른 경우) 넣지 않고 FRAME은 사적인 사본으로 남습니다.
+ * frame_lock을 잡고 호출해야 합니다. */
+void
+text_insert (struct frame *frame, struct inode *inode, off_t ofs,
+		size_t read_bytes) {
+	lock_acquire (&text_lock);
+	if (frame->cache_inode == NULL) {
+		frame->cache_inode = inode;
+		frame->cache_ofs = ofs;
+		frame->cache_bytes = read_bytes;
+		if (hash_insert (&text_frames, &frame->cache_elem) == NULL)
+			text_cnt++;
+		else
+			frame->cache_inode = NULL;
+	}
+	lock_release (&text_lock);
+}
+
+/* 캐시에 있다면 FRAME을 뺍니다. text_lock을 잡고 호출해야 합니다. */
+static void
+remove_locked (struct frame *frame) {
+	if (frame->cache_inode != NULL) {
+		hash_delete (&text_frames, &frame->cache_elem);
+		frame->cache_inode = NULL;
+		text_cnt--;
+	}
+}
+
+/* FRAME이 풀리거나 evict 될 때 캐시에서 뺍니다. frame_lock을 잡고 호출해야 합니다. */
+void
+text_remove (struct frame *frame) {
+	if (text_cnt == 0)
+		return;
+	lock_acquire (&text_lock);
+	remove_locked (frame);
+	lock_release (&text_lock);
+}
+
+/* INODE의 [OFS, OFS + SIZE) 범위와 겹치는 페이지를 캐시에서 뺍니다.
+ * inode에 쓰거나 마지막으로 닫을 때 부릅니다. 파일을 쓰는 도중 frame_lock을 잡고 있을 수도 있으므로
+ * (mmap 페이지의 writeback) frame_lock은 잡지 않습니다. */
+void
+text_invalidate (struct inode *inode, off_t ofs, off_t size) {
+	off_t page;
+
+	if (size <= 0)
+		return;
+	lock_acquire (&text_lock);
+	for (page = ofs & ~PGMASK; page < ofs + size && text_cnt > 0; page += PGSIZE) {
+		struct frame key;
+		struct hash_elem *e;
+
+		key.cache_inode = inode;
+		key.cache_ofs = page;
+		e = hash_find (&text_frames, &key.cache_elem);
+		if (e != NULL)
+			remove_locked (hash_entry (e, struct frame, cache_elem));
+	}
+	lock_release (&text_lock);
+}
+
+/* 캐시에 있는 프레임 수를 반환합니다. */
+size_t
+text_cached (void) {
+	return text_cnt;
+}
@@ -0,0 +1,372 @@
+/* uffd.c: 사용자 프로그램이 직접 처리하는 page fault
+ *
+ * uffd_register_range()로 등록한 구간의 페이지는 커널이 만들지 않습니다. 없는 페이지에 fault가 나면
+ * 프로세스의 문맥(struct uffd)에 fault를 넣고, 등록 뒤 fork한 처리 프로세스가 채워 줄 때까지 잡니다.
+ * 처리 프로세스는 uffd_next_fault()로 fault를 꺼내고 uffd_fill()로 프레임을 채워 넘깁니다.
+ * 넘겨받은 프레임은 fault 난 프로세스가 자기 문맥에서 통째로 매핑하므로, 반쯤 채운 페이지가 보이는 일은 없습니다.
+ * 처리 프로세스는 다른 프로세스의 SPT를 건드리지 않습니다. */
+
+#include "vm/uffd.h"
+#include "vm/vm.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include <mman.h>
+#include <string.h>
+
+/* 처리를 기다리는 fault 하나. fault 난 프로세스의 커널 스택에 있음 */
+struct uffd_fault {
+	struct list_elem elem;      /* struct uffd의 faults 원소 */
+	void *va;
+	bool write;
+	bool queued;                /* 아직 faults에 있음 */
+};
+
+/* 주인이 등록한 구간. 처리 프로세스의 구간 사본에는 표시가 없으므로 문맥이 기억함 */
+struct uffd_range {
+	struct list_elem elem;      /* struct uffd의 ranges 원소 */
+	void *start;
+	void *end;
+};
+
+/* 채웠지만 아직 매핑하지 않은 페이지 */
+struct uffd_page {
+	struct list_elem elem;      /* struct uffd의 ready 원소 */
+	void *va;
+	struct frame *frame;        /* 고정된 채 채운 프레임. NULL이면 0으로 채운 페이지 */
+};
+
+static long long copy_cnt;        /* 복사해서 채운 페이지 수 */
+static long long zero_cnt;        /* 0으로 채운 페이지 수 */
+
+/* 스레드 T가 주인인 새 문맥을 만듭니다. */
+static struct uffd *
+uffd_create (struct thread *t) {
+	struct uffd *u = malloc (sizeof *u);
+
+	if (u == NULL)
+		return NULL;
+	lock_init (&u->lock);
+	cond_init (&u->fault_cond);
+	cond_init (&u->ready_cond);
+	list_init (&u->faults);
+	list_init (&u->ready);
+	list_init (&u->ranges);
+	u->pinned = 0;
+	u->owner = t;
+	u->ref_cnt = 1;
+	return u;
+}
+
+/* 마지막 참조가 사라진 U를 해제합니다. 매핑하지 못한 페이지는 돌려줍니다. */
+static void
+uffd_free (struct uffd *u) {
+	while (!list_empty (&u->ready)) {
+		struct uffd_page *p = list_entry (list_pop_front (&u->ready), struct uffd_page, elem);
+
+		if (p->frame != NULL)
+			vm_unpin_frame (p->frame);
+		free (p);
+	}
+	while (!list_empty (&u->ranges))
+		free (list_entry (list_pop_front (&u->ranges), struct uffd_range, elem));
+	free (u);
+}
+
+/* 현재 프로세스의 ADDR부터 LENGTH 바이트를 사용자가 처리하는 구간으로 등록합니다.
+ * 구간은 비어 있어야 하며, 다른 프로세스의 fault를 처리하는 프로세스는 등록할 수 없습니다. */
+bool
+uffd_register_range (void *addr, size_t length) {
+	struct thread *t = thread_current ();
+	struct supplemental_page_table *spt = &t->spt;
+	void *end = pg_round_up (addr + length);
+	struct vm_area area;
+	struct uffd_range *r;
+
+	if (addr == NULL || pg_ofs (addr) != 0 || length == 0 || end <= addr
+			|| !is_user_vaddr (end - 1))
+		return false;
+	if (vma_overlaps (&spt->vmas, addr, end) || !spt_range_empty (spt, addr, end))
+		return false;
+	if (t->uffd != NULL && t->uffd->owner != t)
+		return false;
+	if (t->uffd == NULL && (t->uffd = uffd_create (t)) == NULL)
+		return false;
+	r = malloc (sizeof *r);
+	if (r == NULL)
+		return false;
+	r->start = addr;
+	r->end = end;
+
+	memset (&area, 0, sizeof area);
+	area.start = addr;
+	area.end = end;
+	area.type = VM_ANON;
+	area.writable = true;
+	area.uffd = true;
+	area.advice = MADV_NORMAL;
+	if (!vma_insert (&spt->vmas, &area)) {
+		free (r);
+		return false;
+	}
+	lock_acquire (&t->uffd->lock);
+	list_push_back (&t->uffd->ranges, &r->elem);
+	lock_release (&t->uffd->lock);
+	return true;
+}
+
+/* 현재 프로세스가 처리하는 문맥에서 가장 오래된 fault를 꺼내 *ADDR과 *WRITE에 담습니다.
+ * fault가 없으면 들어올 때까지 기다리며, 주인 프로세스가 종료했으면 false를 반환합니다. */
+bool
+uffd_next_fault (void **addr, bool *write) {
+	struct thread *t = thread_current ();
+	struct uffd *u = t->uffd;
+	struct uffd_fault *fault;
+	void *va;
+	bool w;
+
+	if (u == NULL || u->owner == t)
+		return false;
+	lock_acquire (&u->lock);
+	while (list_empty (&u->faults) && u->owner != NULL)
+		cond_wait (&u->fault_cond, &u->lock);
+	if (list_empty (&u->faults)) {
+		lock_release (&u->lock);
+		return false;
+	}
+	fault = list_entry (list_pop_front (&u->faults), struct uffd_fault, elem);
+	fault->queued = false;
+	va = fault->va;
+	w = fault->write;
+	lock_release (&u->lock);
+
+	/* 사용자 메모리에 쓰다가 fault가 날 수 있으므로 락을 놓고 씀 */
+	*addr = va;
+	*write = w;
+	return true;
+}
+
+/* DST부터 LENGTH 바이트가 U에 등록한 구간 하나 안에 있으면 true. U의 lock을 잡고 호출해야 합니다. */
+static bool
+uffd_in_range (struct uffd *u, void *dst, size_t length) {
+	struct list_elem *e;
+
+	for (e = list_begin (&u->ranges); e != list_end (&u->ranges); e = list_next (e)) {
+		struct uffd_range *r = list_entry (e, struct uffd_range, elem);
+
+		if (r->start <= dst && dst + length <= r->end)
+			return true;
+	}
+	return false;
+}
+
+/* VA의 페이지를 이미 채워 두었으면 true. U의 lock을 잡고 호출해야 합니다. */
+static bool
+uffd_pending (struct uffd *u, void *va) {
+	struct list_elem *e;
+
+	for (e = list_begin (&u->ready); e != list_end (&u->ready); e = list_next (e))
+		if (list_entry (e, struct uffd_page, elem)->va == va)
+			return true;
+	return false;
+}
+
+/* 현재 프로세스의 문맥에 DST부터 LENGTH 바이트의 페이지를 채워 넣습니다.
+ * SRC가 있으면 현재 프로세스의 SRC에서 복사하고, NULL이면 0으로 채웁니다.
+ * 페이지마다 다 채운 뒤에 넘기므로, 그 페이지를 기다리던 fault는 바로 풀려납니다.
+ * 등록한 구간 밖이거나, 이미 채워 둔 페이지가 있거나, 매핑을 기다리며 고정된 프레임이
+ * mlock_limit을 넘게 되면 아무것도 채우지 않고 false. */
+bool
+uffd_fill (void *dst, const void *src, size_t length) {
+	struct thread *t = thread_current ();
+	struct uffd *u = t->uffd;
+	size_t i;
+	bool ok;
+
+	if (u == NULL || dst == NULL || pg_ofs (dst) != 0 || length == 0
+			|| pg_ofs (length) != 0 || dst + length <= dst || !is_user_vaddr (dst + length - 1))
+		return false;
+	if (src != NULL) {
+		if (src + length <= src || !is_user_vaddr (src + length - 1))
+			return false;
+		for (i = 0; i < length; i += PGSIZE)
+			if (spt_find_page (&t->spt, (void *) src + i) == NULL)
+				return false;
+	}
+
+	/* 고정할 프레임을 미리 잡아 두어, 처리 프로세스가 user pool을 모두 고정하지 못하게 함 */
+	lock_acquire (&u->lock);
+	ok = uffd_in_range (u, dst, length);
+	for (i = 0; ok && i < length; i += PGSIZE)
+		ok = !uffd_pending (u, dst + i);
+	if (ok && src != NULL) {
+		ok = u->pinned + length / PGSIZE <= mlock_limit;
+		if (ok)
+			u->pinned += length / PGSIZE;
+	}
+	lock_release (&u->lock);
+	if (!ok)
+		return false;
+
+	for (i = 0; i < length; i += PGSIZE) {
+		struct uffd_page *p = malloc (sizeof *p);
+
+		if (p != NULL) {
+			p->va = dst + i;
+			p->frame = src != NULL ? vm_fill_frame (src + i) : NULL;
+		}
+
+		lock_acquire (&u->lock);
+		/* 그사이 다른 처리 프로세스가 같은 페이지를 채웠으면 버림 */
+		if (p == NULL || u->owner == NULL || uffd_pending (u, p->va)) {
+			if (src != NULL)
+				u->pinned -= (length - i) / PGSIZE;
+			lock_release (&u->lock);
+			if (p != NULL && p->frame != NULL)
+				vm_unpin_frame (p->frame);
+			free (p);
+			return false;
+		}
+		list_push_back (&u->ready, &p->elem);
+		if (p->frame != NULL)
+			copy_cnt++;
+		else
+			zero_cnt++;
+		cond_broadcast (&u->ready_cond, &u->lock);
+		lock_release (&u->lock);
+	}
+	return true;
+}
+
+/* 채워 둔 페이지 P를 현재 프로세스에 매핑합니다. 등록한 구간 밖이거나 이미 페이지가 있으면 버립니다. */
+static bool
+uffd_install (struct uffd_page *p) {
+	struct vm_area *area = vma_find (&thread_current ()->spt.vmas, p->va);
+
+	if (area == NULL || !area->uffd) {
+		if (p->frame != NULL)
+			vm_unpin_frame (p->frame);
+		return false;
+	}
+	return vm_install_frame (p->va, p->frame, area->writable);
+}
+
+/* 등록한 구간의 ADDR에서 난 fault를 처리합니다. 채워 둔 페이지가 없으면 fault를 넣고 채워질 때까지 잡니다.
+ * 처리 프로세스가 없거나 모두 종료하면 false. 그동안 채워 둔 다른 페이지도 함께 매핑합니다. */
+bool
+uffd_handle_fault (void *addr, bool write) {
+	struct thread *t = thread_current ();
+	struct uffd *u = t->uffd;
+	struct uffd_fault fault;
+	struct list ready;
+	struct list_elem *e;
+	bool found = false, success = false;
+
+	if (u == NULL || u->owner != t)
+		return false;
+	fault.va = pg_round_down (addr);
+	fault.write = write;
+	fault.queued = false;
+
+	lock_acquire (&u->lock);
+	for (;;) {
+		for (e = list_begin (&u->ready); e != list_end (&u->ready); e = list_next (e))
+			if (list_entry (e, struct uffd_page, elem)->va == fault.va)
+				found = true;
+		/* 처리 프로세스가 없으면 아무도 채워 주지 않음 */
+		if (found || u->ref_cnt == 1)
+			break;
+		if (!fault.queued) {
+			list_push_back (&u->faults, &fault.elem);
+			fault.queued = true;
+			cond_signal (&u->fault_cond, &u->lock);
+		}
+		cond_wait (&u->ready_cond, &u->lock);
+	}
+	if (fault.queued)
+		list_remove (&fault.elem);
+	list_init (&ready);
+	while (!list_empty (&u->ready)) {
+		struct uffd_page *p = list_entry (list_pop_front (&u->ready), struct uffd_page, elem);
+
+		if (p->frame != NULL)
+			u->pinned--;
+		list_push_back (&ready, &p->elem);
+	}
+	lock_release (&u->lock);
+
+	/* 매핑은 프레임을 얻거나 page table을 만들 수 있으므로 락 밖에서 */
+	while (!list_empty (&ready)) {
+		struct uffd_page *p = list_entry (list_pop_front (&ready), struct uffd_page, elem);
+
+		if (uffd_install (p) && p->va == fault.va)
+			success = true;
+		free (p);
+	}
+	if (success)
+		vm_event (VMSTAT_FAULT_USER, 1);
+	return success;
+}
+
+/* 현재 프로세스의 BUFFER부터 SIZE 바이트 중 등록한 구간에 있고 아직 없는 페이지를 처리 프로세스에게 받아 둡니다.
+ * read()나 write()가 filesys_lock을 잡은 채 fault로 잠들면, 파일을 읽어 페이지를 채우려는 처리 프로세스가
+ * 그 락을 기다리며 서로 멈추므로, 락을 잡기 전에 부릅니다. 받지 못한 페이지가 있으면 false. */
+bool
+uffd_prefault (const void *buffer, size_t size, bool write) {
+	struct thread *t = thread_current ();
+	void *va;
+
+	if (t->uffd == NULL || t->uffd->owner != t || size == 0)
+		return true;
+	for (va = pg_round_down (buffer); va < buffer + size && is_user_vaddr (va); va += PGSIZE) {
+		struct vm_area *area = vma_find (&t->spt.vmas, va);
+
+		if (area != NULL && area->uffd && spt_find_page (&t->spt, va) == NULL
+				&& !uffd_handle_fault (va, write))
+			return false;
+	}
+	return true;
+}
+
+/* fork: 자식 CHILD가 부모 PARENT의 문맥을 물려받아 그 fault를 처리할 수 있게 합니다. */
+void
+uffd_fork (struct thread *child, struct thread *parent) {
+	struct uffd *u = parent->uffd;
+
+	if (u == NULL)
+		return;
+	lock_acquire (&u->lock);
+	u->ref_cnt++;
+	lock_release (&u->lock);
+	child->uffd = u;
+}
+
+/* 종료하는 스레드 T의 문맥을 내려놓습니다. 주인이면 처리 프로세스들을 깨워 끝났음을 알리고,
+ * 처리 프로세스면 기다리는 주인을 깨워 남은 처리 프로세스가 있는지 다시 보게 합니다.
+ * 주인이 깨어나 ref_cnt를 볼 때 이미 줄어 있도록, 참조는 깨우기 전에 같은 락 안에서 내려놓습니다. */
+void
+uffd_exit (struct thread *t) {
+	struct uffd *u = t->uffd;
+	bool last;
+
+	if (u == NULL)
+		return;
+	t->uffd = NULL;
+	lock_acquire (&u->lock);
+	last = --u->ref_cnt == 0;
+	if (u->owner == t) {
+		u->owner = NULL;
+		cond_broadcast (&u->fault_cond, &u->lock);
+	} else
+		cond_broadcast (&u->ready_cond, &u->lock);
+	lock_release (&u->lock);
+	if (last)
+		uffd_free (u);
+}
+
+/* 처리 프로세스가 복사해서 채운 페이지 수와 0으로 채운 페이지 수를 돌려줍니다. */
+void
+uffd_get_stats (long long *copied, long long *zeroed) {
+	*copied = copy_cnt;
+	*zeroed = zero_cnt;
+}
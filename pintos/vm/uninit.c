@@ -9,6 +9,7 @@
 
 #include "vm/vm.h"
 #include "vm/uninit.h"
+#include "threads/malloc.h"
 
 static bool uninit_initialize (struct page *page, void *kva);
 static void uninit_destroy (struct page *page);
@@ -64,4 +65,7 @@ uninit_destroy (struct page *page) {
 	struct uninit_page *uninit UNUSED = &page->uninit;
 	/* TODO: 이 함수를 구현하세요.
 	 * TODO: 수행할 작업이 없다면 그냥 return 하세요. */
+	/* 파일 기반 페이지의 container는 페이지마다 따로 할당됨 */
+	if (VM_TYPE (uninit->type) == VM_FILE)
+		free (uninit->aux);
 }
@@ -5,10 +5,100 @@
 #include "vm/inspect.h"
 #include "threads/vaddr.h"
 #include "threads/mmu.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "userprog/process.h"
+#include "devices/timer.h"
+#include "intrinsic.h"
+#include <bitmap.h>
+#include <mman.h>
+#include <stdio.h>
+#include <string.h>
 
 /* Project 3 */
-struct list frame_table;
-struct list_elem* start;
+/* 프레임 테이블: user pool의 물리 페이지마다 하나씩, 물리 프레임 번호(pfn) 순서로 둡니다.
+ * kva가 NULL이면 비어 있는 칸입니다. */
+static struct frame *frame_table;
+static size_t frame_cnt;          /* frame_table 칸 수 = user pool 페이지 수 */
+static uint64_t frame_base_pfn;   /* frame_table[0]의 pfn */
+static size_t frame_used_cnt;     /* 사용 중인 칸 수 */
+
+/* 두 바늘 clock. 앞 바늘이 accessed 비트를 지우고,
+ * HANDSPREAD 칸 뒤의 뒷 바늘이 그때까지 다시 접근되지 않은 프레임을 내보냅니다. */
+static size_t clock_front, clock_back;
+static size_t clock_handspread;
+
+/* frame_table, 각 프레임의 역매핑(pages), clock 바늘을 보호합니다.
+ * filesys_lock을 잡은 채로 얻을 수 있으므로, 이 락을 잡은 채 filesys_lock을 잡으면 안 됩니다. */
+static struct lock frame_lock;
+
+/* 모두 0인 공유 프레임. 아직 쓴 적 없는 익명 페이지를 읽기만 하면 이 프레임을 읽기 전용으로 매핑하고,
+ * 처음 쓸 때 vm_handle_wp()가 사적인 프레임으로 옮깁니다. 항상 고정되어 있어 evict 되지 않습니다. */
+static struct frame *zero_frame;
+static uint64_t zero_sum;         /* zero_frame의 checksum */
+static struct frame *vm_get_frame (void);
+
+/* kswapd: 빈 프레임이 low watermark 아래로 내려가면 깨어나서 high watermark까지
+ * 익명 페이지를 연속된 swap slot에 묶어 내보냅니다. fault 경로는 대개 I/O 없이 빈 프레임을 얻습니다. */
+#define KSWAPD_BATCH 16           /* 한 번에 내보내는 최대 프레임 수 */
+#define SWAP_RA_PAGES 8           /* swap-in 때 미리 읽는 최대 이웃 페이지 수 */
+bool kswapd_enabled = true;
+/* -spt=radix: 새 보조 페이지 테이블을 해시 대신 radix tree에 둠 */
+bool spt_radix;
+/* -mlock-limit=N: 프로세스 하나가 mlock()으로 고정할 수 있는 최대 페이지 수 */
+size_t mlock_limit = MLOCK_DEFAULT_LIMIT;
+/* -stack-limit=N: 스택이 커질 수 있는 최대 페이지 수. 그 아래 한 페이지는 guard로 비워 둠 */
+size_t stack_limit = STACK_DEFAULT_LIMIT;
+/* x86-64 ABI의 red zone: 함수는 rsp 아래 이만큼을 rsp를 옮기지 않고 씀 */
+#define STACK_RED_ZONE 128
+static struct semaphore kswapd_sema;
+static bool kswapd_awake;
+static void kswapd (void *aux);
+
+/* wssd: wss_interval_ms마다 모든 프레임의 accessed 비트를 보고 지워서 페이지마다 참조되지 않은 표본 수(idle)를 셉니다.
+ * idle이 wss_window보다 작은 페이지가 그 프로세스의 working set이고, 나머지는 차가운 페이지입니다.
+ * WSS_IDLE_SAMPLES번 넘게 아무 페이지도 참조하지 않은 프로세스의 차가운 페이지는 메모리가 모자라기 전에 미리 내보냅니다. */
+unsigned wss_interval_ms = WSS_DEFAULT_INTERVAL;
+unsigned wss_window = WSS_DEFAULT_WINDOW;
+bool wss_trim_enabled = true;
+static size_t trim_cursor;        /* 차가운 프레임을 찾기 시작할 칸 */
+static size_t trim_scan_left;     /* 이번에 더 볼 수 있는 칸 수 */
+static void wssd (void *aux);
+
+/* ksmd: 익명 프레임을 ksm_sleep_ms마다 ksm_pages_to_scan개씩 pfn 순서로 훑어 같은 내용끼리 합칩니다. */
+static size_t ksm_cursor;
+static void ksmd (void *aux);
+
+/* 통계 */
+static long long shrink_cnt;      /* eviction 전에 shrinker를 돌린 횟수 */
+static long long shrink_freed;    /* shrinker가 돌려준 페이지 수 */
+static long long cow_share_cnt;   /* fork에서 복사 대신 공유한 페이지 수 */
+static long long remap_cnt;       /* kswapd가 내보내던 프레임을 다시 매핑만 한 fault 수 */
+static long long kswapd_wake_cnt; /* kswapd를 깨운 횟수 */
+static long long kswapd_batch_cnt;    /* kswapd가 쓴 묶음 수 */
+static long long kswapd_reclaim_cnt;  /* kswapd가 비운 프레임 수 */
+static long long readahead_cnt;   /* swap에서 미리 읽어 온 페이지 수 */
+static long long fault_around_cnt;    /* fault-around로 함께 매핑한 파일 페이지 수 */
+static long long fault_around_reads;  /* fault-around 묶음 읽기 횟수 */
+static long long text_share_cnt;  /* text 캐시에서 다른 프로세스의 프레임을 매핑한 페이지 수 */
+static long long zero_cow_cnt;    /* zero_frame에 쓰려다 사적인 프레임을 받은 횟수 */
+static long long ksm_scan_cnt;    /* ksmd가 checksum을 구한 프레임 수 */
+static long long ksm_merge_cnt;   /* ksmd가 합쳐서 돌려준 프레임 수 */
+static long long populate_cnt;    /* MAP_POPULATE나 MADV_WILLNEED로 미리 올린 페이지 수 */
+static long long lazyfree_cnt;    /* MADV_FREE 후 쓰이지 않아 swap 없이 버린 프레임 수 */
+static long long shm_share_cnt;   /* 공유 익명 객체에서 다른 프로세스의 프레임을 매핑한 횟수 */
+static long long shm_load_cnt;    /* 공유 익명 페이지를 0이나 swap으로 새 프레임에 채운 횟수 */
+static long long stack_grow_pages;    /* fault 주소나 rsp까지 스택을 키운 페이지 수 */
+static long long stack_ahead_pages;   /* 그 아래로 미리 매핑한 스택 페이지 수 */
+static long long stack_overflow_cnt;  /* guard 페이지에 닿은 fault 수 */
+static long long zero_copy_cow_cnt;   /* 공유하던 프레임을 복사 없이 새 프레임으로 바꾼 read() 페이지 수 */
+static long long wss_sample_cnt;  /* working-set 표본 수 */
+static long long trim_batch_cnt;  /* idle 프로세스를 다듬으며 쓴 묶음 수 */
+static long long trim_reclaim_cnt;    /* 그때 비운 프레임 수 */
+static long long vm_events[VMSTAT_EVENT_CNT];  /* 시스템 전체의 VM 이벤트 수. 프로세스별 수는 thread에 둠 */
+/* fault 처리 시간 분포: [i]는 2^i 이상 2^(i+1) 미만 cycle. I/O가 있었던 fault와 없었던 fault를 따로 셈 */
+static long long minor_hist[VMSTAT_HIST_BUCKETS];
+static long long major_hist[VMSTAT_HIST_BUCKETS];
 
 /* 가상 메모리 서브시스템을 초기화합니다.
  * 각 서브시스템의 초기화 코드를 호출합니다. */
@@ -22,7 +112,35 @@ vm_init (void) {
 	register_inspect_intr ();  // 디버깅용 인터럽트 등록
 	/* 위의 줄은 수정하지 마시오. */
 	/* TODO: 여기에 코드를 작성하세요. */
-	list_init (&frame_table);
+	struct palloc_stats st;
+
+	palloc_get_stats (PAL_USER, &st);
+	frame_cnt = st.total;
+	frame_base_pfn = vtop (st.base) >> PGBITS;
+	frame_table = calloc (frame_cnt, sizeof *frame_table);
+	if (frame_table == NULL)
+		PANIC ("vm_init: cannot allocate frame table");
+	clock_handspread = frame_cnt / 4 > 0 ? frame_cnt / 4 : 1;
+	clock_back = 0;
+	clock_front = clock_handspread % frame_cnt;
+	lock_init (&frame_lock);
+	text_init ();
+	ksm_init ();
+
+	sema_init (&kswapd_sema, 0);
+
+	/* 고정을 풀지 않으므로 evict 되지도, 해제되지도 않음 */
+	zero_frame = vm_get_frame ();
+	memset (zero_frame->kva, 0, PGSIZE);
+	zero_sum = hash_bytes (zero_frame->kva, PGSIZE);
+
+	if (kswapd_enabled)
+		thread_create ("kswapd", PRI_DEFAULT, kswapd, NULL);
+	if (ksm_pages_to_scan > 0)
+		thread_create ("ksmd", PRI_DEFAULT, ksmd, NULL);
+	if (wss_interval_ms > 0)
+		thread_create ("wssd", PRI_DEFAULT, wssd, NULL);
+	reap_init ();
 }
 
 /* 페이지의 타입을 반환합니다.
@@ -98,6 +216,7 @@ install_page (void *upage, void *kpage, bool writable) {
 
 
 /* 헬퍼 함수들 */
+static struct page *spt_lookup (struct supplemental_page_table *spt, void *va);
 static struct frame *vm_get_victim (void);
 static bool vm_do_claim_page (struct page *page);
 static struct frame *vm_evict_frame (void);
@@ -112,8 +231,9 @@ vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable,
 
 	struct supplemental_page_table *spt = &thread_current ()->spt;
 
-	/* upage가 이미 사용 중인지 확인합니다. */
-	if (spt_find_page (spt, upage) == NULL) {
+	/* upage가 이미 사용 중인지 확인합니다. 구간(VMA)에서 페이지를 만드는 중일 수도 있으므로
+	 * 구간을 보지 않고 SPT에 이미 있는지만 봅니다. */
+	if (spt_lookup (spt, upage) == NULL) {
 		/* TODO: 페이지를 생성하고, VM 타입에 따라 initializer를 가져옵니다.
 		 * TODO: 그런 다음 uninit_new를 호출하여 "uninit" 페이지 구조체를 생성합니다.
 		 * TODO: uninit_new 호출 후 필요한 필드를 수정하세요. */
@@ -129,10 +249,17 @@ vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable,
             case VM_FILE:
                 initializer = file_backed_initializer;
                 break;
+            case VM_SHM:
+                initializer = shm_initializer;
+                break;
 		}
 		uninit_new(page, upage, init, type, aux, initializer);
 
 		page->writable = writable;
+		page->owner = thread_current ();
+		/* 구간 안의 페이지는 구간에 준 madvise 힌트를 물려받음 */
+		struct vm_area *area = vma_find (&spt->vmas, upage);
+		page->advice = area != NULL ? area->advice : MADV_NORMAL;
 		/* TODO: 생성한 페이지를 spt에 삽입합니다. */
 		return spt_insert_page(spt,page);
 	}
@@ -140,243 +267,2089 @@ err:
 	return false;
 }
 
-/* spt에서 VA에 해당하는 페이지를 찾아 반환합니다.
+/* spt에 이미 만들어져 있는 VA의 페이지를 반환합니다. 구간(VMA)은 보지 않습니다.
  * 실패 시 NULL을 반환합니다. */
-struct page *spt_find_page(struct supplemental_page_table *spt, void *va) {
+static struct page *
+spt_lookup (struct supplemental_page_table *spt, void *va) {
     struct page key;                 // 스택에 키만 생성 (힙 할당 금지)
     struct hash_elem *e;
 
+    if (spt->radix)
+        return radix_find (&spt->tree, pg_round_down (va));
     key.va = pg_round_down(va);      // 키는 va만 맞으면 됨 (hash/less가 va 기준이어야 함)
     e = hash_find(&spt->pages, &key.hash_elem);
     return e ? hash_entry(e, struct page, hash_elem) : NULL;
 }
+
+/* spt에서 VA에 해당하는 페이지를 찾아 반환합니다.
+ * 아직 없지만 VA가 현재 프로세스의 구간(VMA) 안이면 그 자리에서 페이지를 만듭니다.
+ * 실패 시 NULL을 반환합니다. */
+struct page *spt_find_page(struct supplemental_page_table *spt, void *va) {
+    struct page *page = spt_lookup (spt, va);
+
+    if (page == NULL && spt == &thread_current ()->spt && vma_fault_in (spt, va))
+        page = spt_lookup (spt, va);
+    return page;
+}
+
+/* [START, END)가 spt의 페이지 수보다 작으면 주소마다 찾는 편이, 아니면 spt 전체를 훑는 편이 쌉니다. */
+static bool
+range_is_small (struct supplemental_page_table *spt, void *start, void *end) {
+    return (size_t) (end - start) / PGSIZE <= spt_size (spt);
+}
+
+/* radix_walk()에 넘길 spt_for_each_in_range()의 인자 */
+struct range_walk {
+    void (*fn) (struct page *, void *);
+    void *aux;
+};
+
+static void
+range_walk_page (void *page, void *aux) {
+    struct range_walk *w = aux;
+
+    w->fn (page, w->aux);
+}
+
+static void
+range_found (void *page UNUSED, void *found) {
+    *(bool *) found = true;
+}
+
+/* spt에 [START, END) 안의 페이지가 하나도 없으면 true를 반환합니다. 구간(VMA)은 보지 않습니다. */
+bool
+spt_range_empty (struct supplemental_page_table *spt, void *start, void *end) {
+    struct hash_iterator i;
+    bool found = false;
+    void *va;
+
+    /* radix tree는 빈 부분을 건너뛰며 주소 순서로 훑으므로 구간 크기와 상관없이 walk 한 번 */
+    if (spt->radix) {
+        radix_walk (&spt->tree, start, end, range_found, &found);
+        return !found;
+    }
+    if (range_is_small (spt, start, end)) {
+        for (va = start; va < end; va += PGSIZE)
+            if (spt_lookup (spt, va) != NULL)
+                return false;
+        return true;
+    }
+    hash_first (&i, &spt->pages);
+    while (hash_next (&i)) {
+        struct page *p = hash_entry (hash_cur (&i), struct page, hash_elem);
+
+        if (start <= p->va && p->va < end)
+            return false;
+    }
+    return true;
+}
+
+/* spt에 만들어져 있는 [START, END) 안의 페이지마다 FN(page, AUX)를 부릅니다.
+ * 순서는 radix tree면 주소 순서, 해시면 정해져 있지 않습니다.
+ * FN은 그 페이지를 spt에서 빼고 해제해도 됩니다. 구간(VMA)의 만들어지지 않은 페이지는 건너뜁니다. */
+void
+spt_for_each_in_range (struct supplemental_page_table *spt, void *start, void *end,
+        void (*fn) (struct page *, void *), void *aux) {
+    struct hash_iterator i;
+    struct page **pages;
+    size_t cnt = 0, n;
+    void *va;
+
+    if (spt->radix) {
+        struct range_walk w = { fn, aux };
+
+        radix_walk (&spt->tree, start, end, range_walk_page, &w);
+        return;
+    }
+    if (!range_is_small (spt, start, end)) {
+        /* 훑는 동안 지우면 안 되므로 먼저 모아 둠 */
+        pages = malloc (hash_size (&spt->pages) * sizeof *pages);
+        if (pages != NULL) {
+            hash_first (&i, &spt->pages);
+            while (hash_next (&i)) {
+                struct page *p = hash_entry (hash_cur (&i), struct page, hash_elem);
+
+                if (start <= p->va && p->va < end)
+                    pages[cnt++] = p;
+            }
+            for (n = 0; n < cnt; n++)
+                fn (pages[n], aux);
+            free (pages);
+            return;
+        }
+    }
+    for (va = start; va < end; va += PGSIZE) {
+        struct page *p = spt_lookup (spt, va);
+
+        if (p != NULL)
+            fn (p, aux);
+    }
+}
 /* PAGE를 spt에 삽입합니다. 삽입 시 유효성 검사를 수행합니다. */
 bool
 spt_insert_page (struct supplemental_page_table *spt UNUSED,
 		struct page *page UNUSED) {
 	/* TODO: 이 함수를 구현하세요. */
+	if (spt->radix)
+		return radix_insert (&spt->tree, page->va, page);
 	return insert_page(&spt->pages, page);
 }
 
+/* PAGE를 spt에서 빼기만 합니다. 해제는 호출자가 합니다. */
+void
+spt_delete_page (struct supplemental_page_table *spt, struct page *page) {
+	if (spt->radix)
+		radix_remove (&spt->tree, page->va);
+	else
+		hash_delete (&spt->pages, &page->hash_elem);
+}
+
+/* spt에 만들어져 있는 페이지 수를 반환합니다. */
+size_t
+spt_size (struct supplemental_page_table *spt) {
+	return spt->radix ? spt->tree.cnt : hash_size (&spt->pages);
+}
+
 /* 페이지를 spt에서 제거하고 메모리를 해제합니다. */
 void
 spt_remove_page (struct supplemental_page_table *spt, struct page *page) {
 	vm_dealloc_page (page);
 }
 
-/* 희생될 프레임을 선택합니다. */
-static struct frame *
-vm_get_victim (void) {
-	struct frame *victim = NULL;
-	/* TODO: 희생 페이지 선택 정책은 여러분이 정하세요. */
-	struct thread *curr = thread_current();
-	struct list_elem *e = start;
+/* COUNTER에 DELTA를 더합니다.
+ * 다른 프로세스의 eviction이 카운터를 동시에 고칠 수 있으므로 인터럽트를 끄고 갱신합니다. */
+void
+vm_usage_add (size_t *counter, int delta) {
+	enum intr_level old_level = intr_disable ();
+	*counter += delta;
+	intr_set_level (old_level);
+}
 
-	for (start = e; start != list_end(&frame_table); start = list_next(start))
-	{
-		victim = list_entry(start, struct frame, frame_elem);
-		if (pml4_is_accessed(curr->pml4, victim->page->va))
-			pml4_set_accessed(curr->pml4, victim->page->va, 0);
-		else
-			return victim;
-	}
-	for (start = list_begin(&frame_table); start != e; start = list_next(start))
-	{
-		victim = list_entry(start, struct frame, frame_elem);
-		if (pml4_is_accessed(curr->pml4, victim->page->va))
-			pml4_set_accessed(curr->pml4, victim->page->va, 0);
-		else
-			return victim;
-	}
-	return victim;
+/* 페이지가 프레임에 올라왔음을 소유 프로세스의 RSS에 반영합니다. */
+static void
+rss_inc (struct thread *t) {
+	enum intr_level old_level = intr_disable ();
+	if (++t->vm_usage.rss > t->vm_usage.rss_peak)
+		t->vm_usage.rss_peak = t->vm_usage.rss;
+	intr_set_level (old_level);
 }
 
-/* 하나의 페이지를 swap out 하고 해당 프레임을 반환합니다.
- * 실패 시 NULL을 반환합니다. */
-static struct frame *
-vm_evict_frame (void) {
-    struct frame *victim = vm_get_victim ();
-    /* victim을 swap out */
-    swap_out(victim->page);
-    /* evict 후 프레임은 재사용될 예정이므로 페이지 역참조는 비워둠 */
-    return victim;
+/* VM 이벤트 EV를 N번 일어난 것으로 프로세스 T와 시스템 전체에 셉니다.
+ * 시스템 전체의 수는 여러 스레드가 고치므로 인터럽트를 끄고 갱신합니다. */
+static void
+vm_event_add (struct thread *t, enum vmstat_event ev, long long n) {
+	enum intr_level old_level = intr_disable ();
+	t->vm_events[ev] += n;
+	vm_events[ev] += n;
+	intr_set_level (old_level);
 }
 
-/* palloc()을 사용하여 프레임을 얻습니다.
- * 사용 가능한 페이지가 없다면, 프레임을 eviction 하여 메모리를 확보합니다.
- * 항상 유효한 주소를 반환해야 합니다. */
+/* VM 이벤트 EV를 N번 일어난 것으로 현재 프로세스와 시스템 전체에 셉니다. */
+void
+vm_event (enum vmstat_event ev, long long n) {
+	vm_event_add (thread_current (), ev, n);
+}
+
+/* VM 이벤트 EV의 수를 반환합니다. ALL이면 시스템 전체, 아니면 현재 프로세스의 수입니다.
+ * EV가 잘못되었으면 -1. */
+long long
+vm_event_cnt (enum vmstat_event ev, bool all) {
+	if ((unsigned) ev >= VMSTAT_EVENT_CNT)
+		return -1;
+	return all ? vm_events[ev] : thread_current ()->vm_events[ev];
+}
+
+/* VM 이벤트 수를 ST에 채웁니다. ALL이면 시스템 전체, 아니면 현재 프로세스의 수이며,
+ * fault 시간 분포와 swap 사용량은 언제나 시스템 전체의 것입니다. */
+void
+vm_get_stats (struct vmstat *st, bool all) {
+	memcpy (st->events, all ? vm_events : thread_current ()->vm_events,
+			sizeof st->events);
+	memcpy (st->minor_hist, minor_hist, sizeof st->minor_hist);
+	memcpy (st->major_hist, major_hist, sizeof st->major_hist);
+	swap_stats (&st->swap_total, &st->swap_used);
+}
+
+/* 물리 페이지 KVA에 해당하는 프레임 테이블 칸을 반환합니다. */
 static struct frame *
-vm_get_frame (void) {
-	/* TODO: 이 함수를 구현하세요. */
-	struct frame *frame = (struct frame*)malloc(sizeof(struct frame));
-	frame->kva=palloc_get_page(PAL_USER);
+frame_from_kva (void *kva) {
+	uint64_t pfn = vtop (kva) >> PGBITS;
 
-	if(frame->kva == NULL)
-	{
-		frame = vm_evict_frame();
-		frame->page=NULL;
-		return frame;
-	}
+	ASSERT (pfn - frame_base_pfn < frame_cnt);
+	return &frame_table[pfn - frame_base_pfn];
+}
 
-	list_push_back(&frame_table, &frame->frame_elem);
+/* FRAME의 칸을 비우고 그 물리 페이지를 반환합니다. 물리 페이지는 호출자가 user pool에 돌려줘야 합니다.
+ * frame_lock을 잡고 호출해야 합니다. */
+static void *
+frame_retire (struct frame *frame) {
+	void *kva = frame->kva;
 
-	frame -> page = NULL;
+	ASSERT (frame->ref_cnt == 0);
+	text_remove (frame);
+	ksm_remove (frame);
+	frame->ksm_merged = false;
+	frame->kva = NULL;
+	frame->page = NULL;
+	frame->pin_cnt = 0;
+	frame->reclaim = false;
+	frame_used_cnt--;
+	return kva;
+}
 
-	ASSERT (frame != NULL);
-	ASSERT (frame->page == NULL);
-	return frame;
+/* FRAME의 물리 페이지를 user pool에 돌려주고 칸을 비웁니다. frame_lock을 잡고 호출해야 합니다. */
+static void
+frame_release (struct frame *frame) {
+	palloc_free_page (frame_retire (frame));
 }
 
-/* 스택을 성장시킵니다. */
+/* FRAME을 매핑한 페이지도, 고정한 쪽도 없으면 풀어 줍니다. frame_lock을 잡고 호출해야 합니다. */
 static void
-vm_stack_growth (void *addr UNUSED) {
-	if(vm_alloc_page(VM_ANON | VM_MARKER_0, addr, 1))
-	{
-		vm_claim_page(addr);
-		thread_current()->stack_bottom-=PGSIZE;
+frame_put (struct frame *frame) {
+	if (frame->ref_cnt == 0 && frame->pin_cnt == 0)
+		frame_release (frame);
+}
+
+/* PAGE를 FRAME에 연결합니다. fork 이후에는 한 프레임을 여러 페이지가 공유할 수 있습니다.
+ * frame_lock을 잡고 호출해야 합니다. */
+static void
+frame_add_page (struct frame *frame, struct page *page) {
+	if (frame->ref_cnt++ == 0)
+		frame->page = page;
+	list_push_back (&frame->pages, &page->share_elem);
+	page->frame = frame;
+	/* 새 프레임의 내용은 MADV_FREE 이후의 것이므로 버리면 안 됨 */
+	page->lazyfree = false;
+	/* 지금 올라온 페이지는 방금 참조된 것으로 봄 */
+	page->idle = 0;
+	if (page->mlocked)
+		frame->lock_cnt++;
+}
+
+/* PAGE를 자기 프레임의 공유 목록에서 뺍니다. 남은 참조 수를 반환합니다.
+ * 대표 페이지(frame->page)였다면 남은 페이지 중 하나로 바꿉니다. frame_lock을 잡고 호출해야 합니다. */
+static int
+frame_remove_page (struct page *page) {
+	struct frame *frame = page->frame;
+
+	list_remove (&page->share_elem);
+	page->frame = NULL;
+	if (page->mlocked)
+		frame->lock_cnt--;
+	if (--frame->ref_cnt == 0)
+		frame->page = NULL;
+	else if (frame->page == page)
+		frame->page = list_entry (list_front (&frame->pages), struct page, share_elem);
+	return frame->ref_cnt;
+}
+
+/* 주소 공간을 통째로 정리할 때 한 묶음으로 모아서 돌려줄 것들.
+ * 페이지 하나가 물리 페이지와 swap slot을 하나씩만 가지므로 배열 크기가 같음 */
+#define TEARDOWN_BATCH 128
+
+struct teardown {
+	struct page *pages[TEARDOWN_BATCH];   /* 정리할 페이지 */
+	size_t page_cnt;
+	void *kvas[TEARDOWN_BATCH];           /* user pool에 돌려줄 물리 페이지 */
+	size_t kva_cnt;
+	size_t slots[TEARDOWN_BATCH];         /* 참조를 내려놓을 swap slot */
+	size_t slot_cnt;
+};
+
+static long long reap_space_cnt;   /* 정리한 주소 공간 수 */
+static long long reap_page_cnt;    /* 그때 정리한 페이지 수 */
+static long long reap_batch_cnt;   /* 묶음 수 */
+
+/* PAGE를 자기 프레임에서 떼어 냅니다. frame_lock을 잡고 호출해야 합니다.
+ * TD가 NULL이면 매핑을 지우고 마지막 참조였던 물리 페이지를 바로 돌려줍니다.
+ * TD가 있으면 page table째 사라질 주소 공간이므로 매핑은 그대로 두고, 물리 페이지는 TD에 모읍니다. */
+static void
+frame_unmap_page (struct page *page, struct teardown *td) {
+	struct frame *frame = page->frame;
+
+	/* PTE의 present 비트를 먼저 지워야 pml4_destroy()가 같은 페이지를 다시 해제하지 않음 */
+	if (td == NULL && page->owner->pml4 != NULL)
+		pml4_clear_page (page->owner->pml4, page->va);
+	vm_usage_add (&page->owner->vm_usage.rss, -1);
+	/* 공유 익명 프레임의 마지막 매핑이면 객체가 내용을 잃지 않게 함 */
+	if (frame->ref_cnt == 1 && page_get_type (page) == VM_SHM)
+		shm_frame_unmapped (page);
+	/* kswapd가 쓰는 중이면 프레임은 kswapd가 끝난 뒤 풀어 줌 */
+	frame_remove_page (page);
+	if (td != NULL && frame->ref_cnt == 0 && frame->pin_cnt == 0)
+		td->kvas[td->kva_cnt++] = frame_retire (frame);
+	else
+		frame_put (frame);
+	if (page->mlocked) {
+		page->mlocked = false;
+		vm_usage_add (&page->owner->vm_usage.locked, -1);
 	}
 }
 
-/* write-protected 페이지에 대한 fault를 처리합니다. */
-static bool
-vm_handle_wp (struct page *page UNUSED) {
+/* PAGE에 연결된 프레임을 해제합니다.
+ * 매핑을 지우고, 이 페이지가 마지막 참조였다면 물리 페이지를 user pool에 돌려줍니다.
+ * 프레임이 없으면 아무것도 하지 않습니다. */
+void
+vm_free_frame (struct page *page) {
+	lock_acquire (&frame_lock);
+	if (page->frame != NULL)
+		frame_unmap_page (page, NULL);
+	lock_release (&frame_lock);
 }
 
-/* 성공 시 true를 반환합니다. */
-bool
-vm_try_handle_fault (struct intr_frame *f UNUSED, void *addr UNUSED,
-		bool user UNUSED, bool write UNUSED, bool not_present UNUSED) {
-	struct supplemental_page_table *spt UNUSED = &thread_current ()->spt;
-	struct page *page = NULL;
-	/* TODO: 접근 오류가 유효한지 확인합니다. */
-	/* TODO: 여기에 코드를 작성하세요. */
-	if(is_kernel_vaddr(addr)) return false;
+/* FRAME을 매핑한 모든 (pml4, va) 중 하나라도 accessed 비트가 켜져 있으면 true를 반환합니다.
+ * working-set 표본이 비트를 지우면서 남긴 young도 accessed로 봅니다.
+ * CLEAR이면 검사하면서 비트와 young을 지웁니다. */
+static bool
+frame_accessed (struct frame *frame, bool clear) {
+	bool accessed = frame->young;
+	struct list_elem *e;
 
-	void *rsp_stack = is_kernel_vaddr(f->rsp) ? thread_current()->rsp_stack : f->rsp;
-	if(not_present)
-	{
-		if(!vm_claim_page(addr))
-		{
-			if(rsp_stack - 8 <= addr && USER_STACK - 0x100000 <= addr && addr <= USER_STACK)
-			{
-				vm_stack_growth(thread_current()->stack_bottom-PGSIZE);
-				return true;
-			}
-			return false;
+	if (!clear && accessed)
+		return true;
+	frame->young = false;
+	for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e)) {
+		struct page *page = list_entry (e, struct page, share_elem);
+		uint64_t *pml4 = page->owner->pml4;
+
+		if (pml4 != NULL && pml4_is_accessed (pml4, page->va)) {
+			accessed = true;
+			if (!clear)
+				break;
+			pml4_set_accessed (pml4, page->va, 0);
 		}
-		else
-			return true;
 	}
-	return false;
+	return accessed;
 }
 
-/* 페이지를 해제합니다.
- * 이 함수는 수정하지 마세요. */
-void
-vm_dealloc_page (struct page *page) {
-	destroy (page);
-	free (page);
+/* FRAME을 eviction 후보로 볼 수 있는지: 사용 중이고, 페이지가 매핑되어 있고,
+ * 고정되지도 mlock 되지도 않은 프레임 */
+static bool
+frame_evictable (struct frame *frame) {
+	return frame->kva != NULL && frame->ref_cnt > 0 && frame->pin_cnt == 0
+		&& frame->lock_cnt == 0;
 }
 
-/* 주어진 VA에 해당하는 페이지를 할당합니다. */
-bool
-vm_claim_page (void *va UNUSED) {
-	struct page *page = NULL;
-	/* TODO: 이 함수를 구현하세요. */
-    page = spt_find_page(&thread_current()->spt,va);
+/* 희생될 프레임을 선택합니다. frame_lock을 잡고 호출해야 합니다.
+ * 두 바늘을 함께 돌리면서 앞 바늘은 accessed 비트를 지우고,
+ * 뒷 바늘은 앞 바늘이 지나간 뒤 다시 접근되지 않은 프레임을 고릅니다.
+ * 두 바퀴를 돌아도 없으면 뒷 바늘이 만난 첫 후보를 내보냅니다. */
+static struct frame *
+vm_get_victim (void) {
+	struct frame *fallback = NULL;
+	size_t i;
 
-    if(page == NULL){
+	for (i = 0; i < 2 * frame_cnt; i++) {
+		struct frame *front = &frame_table[clock_front];
+		struct frame *back = &frame_table[clock_back];
+
+		if (frame_evictable (front))
+			frame_accessed (front, true);
+		clock_front = (clock_front + 1) % frame_cnt;
+		clock_back = (clock_back + 1) % frame_cnt;
+		vm_event (VMSTAT_SCAN, 1);
+
+		if (frame_evictable (back)) {
+			/* MADV_SEQUENTIAL: 한 번 지나간 페이지는 다시 쓰이지 않을 것으로 보고 먼저 내보냄 */
+			if (back->page->advice == MADV_SEQUENTIAL || !frame_accessed (back, false))
+				return back;
+			if (fallback == NULL)
+				fallback = back;
+		}
+	}
+	return fallback;
+}
+
+/* VICTIM을 바로 swap out 합니다. frame_lock을 잡고 호출해야 합니다.
+ * 프레임을 공유하는 페이지가 여럿이면 swap_out()이 역매핑을 따라 한 번에 모두의 매핑을 끊습니다.
+ * 성공하면 VICTIM은 비어 있지만 아직 사용 중인 프레임으로 남습니다. */
+static bool
+frame_evict (struct frame *victim) {
+    struct list_elem *e;
+
+    /* victim을 swap out */
+    if (anon_discardable (victim))
+        lazyfree_cnt++;
+    if (!swap_out(victim->page))
         return false;
+    text_remove (victim);
+    ksm_remove (victim);
+    victim->ksm_merged = false;
+    for (e = list_begin (&victim->pages); e != list_end (&victim->pages); e = list_next (e)) {
+        struct page *page = list_entry (e, struct page, share_elem);
+        vm_usage_add (&page->owner->vm_usage.rss, -1);
     }
+    vm_event (VMSTAT_EVICT, 1);
+    /* evict 후 프레임은 재사용될 예정이므로 페이지 역참조는 비워둠 */
+    list_init (&victim->pages);
+    victim->ref_cnt = 0;
+    victim->page = NULL;
+    return true;
+}
 
-    return vm_do_claim_page (page);
+/* 하나의 프레임을 swap out 하고 해당 프레임을 반환합니다. frame_lock을 잡고 호출해야 합니다.
+ * kswapd가 따라잡지 못했을 때 fault 경로가 직접 쓰는 길입니다.
+ * 실패 시 NULL을 반환합니다. */
+static struct frame *
+vm_evict_frame (void) {
+    struct frame *victim = vm_get_victim ();
+
+    if (victim == NULL || !frame_evict (victim))
+        return NULL;
+    return victim;
 }
 
-/* 주어진 PAGE를 할당하고 MMU를 설정합니다. */
-static bool
-vm_do_claim_page (struct page *page) {
-	struct frame *frame = vm_get_frame ();
+/* 빈 프레임이 low watermark 아래면 kswapd를 깨웁니다. */
+static void
+kswapd_wake (void) {
+	struct palloc_stats st;
+	enum intr_level old_level;
 
-	/* 링크 설정 */
-	frame->page = page;
-	page->frame = frame;
+	if (!kswapd_enabled)
+		return;
+	palloc_get_stats (PAL_USER, &st);
+	if (st.free >= st.wmark_low)
+		return;
 
-	/* TODO: 페이지 테이블 엔트리를 추가하여 페이지의 VA와 프레임의 PA를 매핑합니다. */
-	if(install_page(page->va, frame->kva, page->writable))
-	{
-        return swap_in(page, frame->kva);
-    }
-    return false;
+	old_level = intr_disable ();
+	if (!kswapd_awake) {
+		kswapd_awake = true;
+		kswapd_wake_cnt++;
+		sema_up (&kswapd_sema);
+	}
+	intr_set_level (old_level);
 }
 
-void
-supplemental_page_table_init (struct supplemental_page_table *spt UNUSED) {
-	hash_init(&spt->pages, page_hash, page_less, NULL);
+/* FRAME을 매핑한 페이지마다 소유 프로세스의 VM 이벤트 EV를 N만큼 셉니다. frame_lock을 잡고 호출해야 합니다. */
+static void
+frame_charge (struct frame *frame, enum vmstat_event ev, long long n) {
+	struct list_elem *e;
+
+	for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e))
+		vm_event_add (list_entry (e, struct page, share_elem)->owner, ev, n);
 }
 
-/* 보조 페이지 테이블을 src로부터 dst로 복사합니다. */
-bool supplemental_page_table_copy(struct supplemental_page_table *dst UNUSED,
-								  struct supplemental_page_table *src UNUSED)
-{
-	// project 3
-	struct hash_iterator i;
-	hash_first(&i, &src->pages);
-	while (hash_next(&i))
-	{
-		struct page *parent_page = hash_entry(hash_cur(&i), struct page, hash_elem);
-		enum vm_type type = page_get_type(parent_page);
-		void *upage = parent_page->va;
-		bool writable = parent_page->writable;
-		vm_initializer *init = parent_page->uninit.init;
-		void *aux = parent_page->uninit.aux;
-
-		if (parent_page->operations->type != VM_UNINIT)
-		{
-			// dst에 페이지 만들고 즉시 클레임
-			if (!vm_alloc_page(type, upage, writable))
-				return false;
-			if (!vm_claim_page(upage))
-				return false;
+/* PICK이 고르는 익명·공유 익명 페이지 프레임을 최대 KSWAPD_BATCH개 swap에 한꺼번에 씁니다.
+ * 빈 프레임이 TARGET에 닿을 만큼만 고르며, 바로 내보내는 프레임도 묶음 크기에 셉니다.
+ * PICK은 frame_lock을 잡은 채 불리며, 더 고를 프레임이 없으면 NULL을 반환합니다.
+ * slot은 swap_alloc()이 소유 프로세스의 주소 창에 맞춰 고르며, slot 순서로 정렬해서 씁니다.
+ * 고른 프레임은 매핑을 끊고 고정한 채 frame_lock 없이 쓰므로, 그동안 fault 경로가 막히지 않습니다.
+ * 쓰는 도중 다시 접근된 프레임(reclaim이 풀린 프레임)은 그대로 두고 slot만 돌려줍니다.
+ * 파일 페이지는 바로 내보냅니다. TRIM이면 실제로 내보낸 페이지를 소유 프로세스의 VMSTAT_TRIM으로 셉니다.
+ * 묶음을 썼으면 *BATCH_CNT를 늘리고, 비운 프레임 수를 반환합니다. */
+static size_t
+reclaim_frames (struct frame *(*pick) (void), long long *batch_cnt, size_t target,
+		bool trim) {
+	struct {
+		struct frame *frame;
+		size_t slot;
+	} batch[KSWAPD_BATCH];
+	size_t cnt = 0, freed = 0, want, i, j;
+	struct palloc_stats st;
+	struct list_elem *e;
 
-			// dst에서 페이지 찾아서 프레임 내용 복사
-			struct page *child_page = spt_find_page(dst, upage);
-			if (child_page == NULL)
-				return false;
+	palloc_get_stats (PAL_USER, &st);
+	want = st.free < target ? target - st.free : 0;
+	if (want > KSWAPD_BATCH)
+		want = KSWAPD_BATCH;
 
-			memcpy(child_page->frame->kva, parent_page->frame->kva, PGSIZE);
+	lock_acquire (&frame_lock);
+	while (cnt + freed < want) {
+		struct frame *victim = pick ();
+		enum vm_type type;
+		size_t slot;
+
+		if (victim == NULL)
+			break;
+		type = VM_TYPE (victim->page->operations->type);
+		/* 파일 페이지와 MADV_FREE 후 쓰이지 않은 익명 페이지는 묶지 않고 바로 내보냄 */
+		if ((type != VM_ANON && type != VM_SHM) || anon_discardable (victim)) {
+			/* frame_evict()가 성공하면 페이지 목록을 비우므로 먼저 세고, 실패하면 되돌림 */
+			if (trim)
+				frame_charge (victim, VMSTAT_TRIM, 1);
+			if (!frame_evict (victim)) {
+				if (trim)
+					frame_charge (victim, VMSTAT_TRIM, -1);
+				break;
+			}
+			frame_release (victim);
+			freed++;
 			continue;
 		}
-		else if (parent_page->operations->type == VM_UNINIT)
-		{
-			if (!vm_alloc_page_with_initializer(type, upage, writable, init, aux))
-				return false;
+		slot = swap_alloc (victim->page);
+		if (slot == SWAP_ERROR)
+			break;
+
+		victim->pin_cnt++;
+		victim->reclaim = true;
+		for (e = list_begin (&victim->pages); e != list_end (&victim->pages); e = list_next (e)) {
+			struct page *page = list_entry (e, struct page, share_elem);
+			pml4_clear_page (page->owner->pml4, page->va);
 		}
-		else
-		{
-			if (!vm_alloc_page(type, upage, writable))
-				return false;
-			if (!vm_claim_page(upage))
-				return false;
+
+		/* slot 순서로 끼워 넣음 */
+		for (j = cnt++; j > 0 && batch[j - 1].slot > slot; j--)
+			batch[j] = batch[j - 1];
+		batch[j].frame = victim;
+		batch[j].slot = slot;
+	}
+	lock_release (&frame_lock);
+
+	for (i = 0; i < cnt; i++)
+		swap_write (batch[i].slot, batch[i].frame->kva);
+
+	lock_acquire (&frame_lock);
+	for (i = 0; i < cnt; i++) {
+		struct frame *frame = batch[i].frame;
+
+		frame->pin_cnt--;
+		if (frame->reclaim && frame->ref_cnt > 0) {
+			for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e)) {
+				struct page *page = list_entry (e, struct page, share_elem);
+				vm_usage_add (&page->owner->vm_usage.rss, -1);
+				if (trim)
+					vm_event_add (page->owner, VMSTAT_TRIM, 1);
+			}
+			if (page_get_type (frame->page) == VM_SHM)
+				shm_swap_commit (frame, batch[i].slot);
+			else
+				anon_swap_commit (frame, batch[i].slot);
+			list_init (&frame->pages);
+			frame->ref_cnt = 0;
+			frame->page = NULL;
+		} else
+			swap_free (batch[i].slot);
+		frame->reclaim = false;
+		if (frame->ref_cnt == 0 && frame->pin_cnt == 0) {
+			frame_release (frame);
+			freed++;
 		}
+	}
+	lock_release (&frame_lock);
 
-		if (parent_page->operations->type != VM_UNINIT)
-		{
-			struct page *child_page = spt_find_page(dst, upage);
-			memcpy(child_page->frame->kva, parent_page->frame->kva, PGSIZE);
+	if (cnt > 0)
+		(*batch_cnt)++;
+	return freed;
+}
+
+/* clock이 고르는 프레임을 한 묶음 내보냅니다. 비운 프레임 수를 반환합니다. */
+static size_t
+kswapd_reclaim (void) {
+	struct palloc_stats st;
+	size_t freed;
+
+	palloc_get_stats (PAL_USER, &st);
+	freed = reclaim_frames (vm_get_victim, &kswapd_batch_cnt, st.wmark_high, false);
+
+	kswapd_reclaim_cnt += freed;
+	return freed;
+}
+
+/* 백그라운드 회수 스레드. 깨워지면 빈 프레임이 high watermark에 닿을 때까지 회수합니다. */
+static void
+kswapd (void *aux UNUSED) {
+	struct palloc_stats st;
+	enum intr_level old_level;
+
+	for (;;) {
+		sema_down (&kswapd_sema);
+		do
+			palloc_get_stats (PAL_USER, &st);
+		while (st.free < st.wmark_high && kswapd_reclaim () > 0);
+
+		old_level = intr_disable ();
+		kswapd_awake = false;
+		intr_set_level (old_level);
+	}
+}
+
+/* FRAME이 합칠 후보인지: 사용 중이고, 고정되지 않았고, kswapd가 내보내는 중이 아닌 익명 페이지 프레임 */
+static bool
+ksm_candidate (struct frame *frame) {
+	return frame_evictable (frame) && !frame->reclaim
+		&& VM_TYPE (frame->page->operations->type) == VM_ANON;
+}
+
+/* FRAME을 매핑한 모든 페이지의 쓰기 권한을 뺏습니다. 이후 쓰려는 쪽은 vm_handle_wp()에서
+ * frame_lock을 기다리므로, frame_lock을 잡고 있는 동안 내용이 바뀌지 않습니다. */
+static void
+frame_write_protect (struct frame *frame) {
+	struct list_elem *e;
+
+	for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e)) {
+		struct page *page = list_entry (e, struct page, share_elem);
+		pml4_set_writable (page->owner->pml4, page->va, false);
+	}
+}
+
+/* FRAME의 페이지를 모두 같은 내용의 STABLE로 옮겨 읽기 전용으로 매핑하고 FRAME을 돌려줍니다. */
+static void
+ksm_merge (struct frame *frame, struct frame *stable) {
+	while (!list_empty (&frame->pages)) {
+		struct page *page = list_entry (list_front (&frame->pages), struct page, share_elem);
+
+		frame_remove_page (page);
+		frame_add_page (stable, page);
+		pml4_set_page (page->owner->pml4, page->va, stable->kva, false);
+		vm_event_add (page->owner, VMSTAT_KSM_MERGE, 1);
+	}
+	if (stable != zero_frame)
+		stable->ksm_merged = true;
+	frame_release (frame);
+	ksm_merge_cnt++;
+}
+
+/* FRAME 하나를 살펴봅니다. frame_lock을 잡고 호출해야 합니다.
+ * 지난번과 checksum이 다르면 자주 바뀌는 페이지로 보고 다음 번으로 넘깁니다.
+ * 같으면 같은 checksum의 프레임과 쓰기를 막은 채 내용을 비교해, 같을 때만 합칩니다. */
+static void
+ksm_scan_frame (struct frame *frame) {
+	struct frame *stable;
+	uint64_t sum;
+
+	if (!ksm_candidate (frame))
+		return;
+	ksm_scan_cnt++;
+	sum = hash_bytes (frame->kva, PGSIZE);
+	if (sum != frame->ksm_sum) {
+		ksm_remove (frame);
+		frame->ksm_sum = sum;
+		return;
+	}
+	if (frame->ksm_listed)
+		return;
+
+	/* 0으로 찬 프레임은 표 대신 zero_frame으로 */
+	stable = sum == zero_sum ? zero_frame : ksm_lookup (sum);
+	if (stable == NULL) {
+		ksm_insert (frame);
+		return;
+	}
+	if (stable != zero_frame && !ksm_candidate (stable))
+		return;
+	frame_write_protect (frame);
+	frame_write_protect (stable);
+	if (memcmp (frame->kva, stable->kva, PGSIZE) != 0) {
+		if (stable == zero_frame)
+			return;
+		/* 표에 넣은 뒤 내용이 바뀐 프레임은 새 프레임으로 바꿈 */
+		ksm_remove (stable);
+		ksm_insert (frame);
+		return;
+	}
+	ksm_merge (frame, stable);
+}
+
+/* 같은 페이지 합치기 스레드. 한 번에 프레임 하나씩만 frame_lock을 잡고 살펴봅니다. */
+static void
+ksmd (void *aux UNUSED) {
+	int64_t ticks = (int64_t) ksm_sleep_ms * TIMER_FREQ / 1000;
+	size_t i;
+
+	for (;;) {
+		timer_sleep (ticks > 0 ? ticks : 1);
+		for (i = 0; i < ksm_pages_to_scan; i++) {
+			lock_acquire (&frame_lock);
+			ksm_scan_frame (&frame_table[ksm_cursor]);
+			ksm_cursor = (ksm_cursor + 1) % frame_cnt;
+			lock_release (&frame_lock);
 		}
 	}
-	return true;
 }
 
-static void page_destructor(struct hash_elem *e, void *aux UNUSED)
-{
-	struct page *p = hash_entry(e, struct page, hash_elem);
-	vm_dealloc_page(p);
+/* FRAME을 매핑한 페이지마다 accessed 비트를 보고 지워서 idle을 갱신하고,
+ * working set에 드는 페이지를 소유 프로세스의 wss_count에 셉니다. frame_lock을 잡고 호출해야 합니다.
+ * 지운 비트는 young으로 남겨 clock이 여전히 참조된 프레임으로 보게 합니다. */
+static void
+wss_sample_frame (struct frame *frame) {
+	struct list_elem *e;
+
+	if (frame->kva == NULL || frame->ref_cnt == 0 || frame->reclaim)
+		return;
+	for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e)) {
+		struct page *page = list_entry (e, struct page, share_elem);
+		struct thread *owner = page->owner;
+
+		if (owner->pml4 == NULL)
+			continue;
+		if (pml4_is_accessed (owner->pml4, page->va)) {
+			pml4_set_accessed (owner->pml4, page->va, 0);
+			frame->young = true;
+			page->idle = 0;
+			owner->wss_referenced = true;
+		} else if (page->idle < UINT8_MAX)
+			page->idle++;
+		if (page->idle < wss_window)
+			owner->wss_count++;
+	}
 }
+
+/* 표본 하나를 다 뜬 뒤 스레드 T의 working set을 vm_usage에 옮기고 다음 표본을 준비합니다.
+ * 인터럽트를 끄고 호출해야 합니다. */
+static void
+wss_publish (struct thread *t, void *aux UNUSED) {
+	t->vm_usage.wss = t->wss_count;
+	if (t->wss_count > t->vm_usage.wss_peak)
+		t->vm_usage.wss_peak = t->wss_count;
+	t->wss_idle = t->wss_referenced ? 0 : t->wss_idle + 1;
+	t->wss_count = 0;
+	t->wss_referenced = false;
+}
+
+/* FRAME을 미리 내보내도 되는지: 매핑한 모든 페이지가 차갑고 그 소유 프로세스가 모두 idle인 프레임 */
+static bool
+frame_cold (struct frame *frame) {
+	struct list_elem *e;
+
+	if (!frame_evictable (frame) || frame->reclaim)
+		return false;
+	for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e)) {
+		struct page *page = list_entry (e, struct page, share_elem);
+		uint64_t *pml4 = page->owner->pml4;
+
+		if (page->idle < wss_window || page->owner->wss_idle < WSS_IDLE_SAMPLES
+				|| pml4 == NULL || pml4_is_accessed (pml4, page->va))
+			return false;
+	}
+	return true;
+}
+
+/* trim_cursor부터 차가운 프레임을 찾아 반환합니다. 한 번 다듬을 때 프레임 테이블을 한 바퀴까지만 봅니다.
+ * frame_lock을 잡고 호출해야 합니다. */
+static struct frame *
+trim_get_victim (void) {
+	while (trim_scan_left > 0) {
+		struct frame *frame = &frame_table[trim_cursor];
+
+		trim_cursor = (trim_cursor + 1) % frame_cnt;
+		trim_scan_left--;
+		if (frame_cold (frame))
+			return frame;
+	}
+	return NULL;
+}
+
+/* 빈 프레임이 user pool의 1/4보다 적은 동안 idle 프로세스의 차가운 페이지를 kswapd처럼 묶어서 내보냅니다.
+ * 그래서 일하는 프로세스의 fault가 low watermark에 닿아 직접 evict 하는 일이 줄어듭니다. */
+static void
+wss_trim (void) {
+	struct palloc_stats st;
+	size_t freed;
+
+	trim_scan_left = frame_cnt;
+	do {
+		palloc_get_stats (PAL_USER, &st);
+		if (st.free >= st.total / 4)
+			break;
+		freed = reclaim_frames (trim_get_victim, &trim_batch_cnt, st.total / 4, true);
+		trim_reclaim_cnt += freed;
+	} while (freed > 0);
+}
+
+/* working-set 표본 스레드. 한 번에 프레임 하나씩만 frame_lock을 잡고 표본을 뜬 뒤,
+ * 프로세스마다 working set을 갱신하고 idle 프로세스를 다듬습니다. */
+static void
+wssd (void *aux UNUSED) {
+	int64_t ticks = (int64_t) wss_interval_ms * TIMER_FREQ / 1000;
+	enum intr_level old_level;
+	size_t i;
+
+	for (;;) {
+		timer_sleep (ticks > 0 ? ticks : 1);
+		for (i = 0; i < frame_cnt; i++) {
+			lock_acquire (&frame_lock);
+			wss_sample_frame (&frame_table[i]);
+			lock_release (&frame_lock);
+		}
+		old_level = intr_disable ();
+		thread_foreach (wss_publish, NULL);
+		intr_set_level (old_level);
+		wss_sample_cnt++;
+		if (wss_trim_enabled)
+			wss_trim ();
+	}
+}
+
+/* palloc()을 사용하여 프레임을 얻습니다.
+ * 사용 가능한 페이지가 없다면, 프레임을 eviction 하여 메모리를 확보합니다.
+ * 돌려주는 프레임은 고정(pinned)되어 있으며, 호출자가 페이지를 연결한 뒤 풀어야 합니다.
+ * 항상 유효한 주소를 반환해야 합니다. */
+static struct frame *
+vm_get_frame (void) {
+	/* TODO: 이 함수를 구현하세요. */
+	struct frame *frame;
+	struct palloc_stats st;
+	void *kva;
+
+	/* low watermark 아래로 내려가면 eviction 전에 shrinker로 high watermark까지 회수 시도 */
+	palloc_get_stats (PAL_USER, &st);
+	if (st.free < st.wmark_low) {
+		shrink_cnt++;
+		shrink_freed += palloc_shrink (PAL_USER, st.wmark_high - st.free);
+	}
+
+	lock_acquire (&frame_lock);
+	kva = palloc_get_page(PAL_USER);
+	if(kva != NULL)
+	{
+		frame = frame_from_kva (kva);
+		frame->kva = kva;
+		list_init (&frame->pages);
+		frame->ref_cnt = 0;
+		frame->lock_cnt = 0;
+		frame->page = NULL;
+		frame->reclaim = false;
+		frame_used_cnt++;
+	}
+	else
+	{
+		frame = vm_evict_frame();
+		if (frame == NULL)
+			PANIC ("vm_get_frame: out of frames and swap");
+	}
+	frame->pin_cnt = 1;
+	frame->young = false;
+	lock_release (&frame_lock);
+	kswapd_wake ();
+
+	ASSERT (frame != NULL);
+	ASSERT (frame->page == NULL);
+	return frame;
+}
+
+/* 현재 프로세스의 스택 구간을 만들고 USER_STACK 바로 아래 첫 페이지를 할당합니다.
+ * 구간은 stack_limit 페이지와 그 아래 guard 페이지 하나로, 다른 mmap이 스택 자리를 차지하지 못하게 합니다.
+ * 성공 시 true를 반환합니다. */
+bool
+vm_stack_init (void) {
+	struct thread *curr = thread_current ();
+	void *stack_bottom = (void *) USER_STACK - PGSIZE;
+	struct vm_area area = {
+		.start = (void *) USER_STACK - (stack_limit + 1) * PGSIZE,
+		.end = (void *) USER_STACK,
+		.type = VM_ANON,
+		.writable = true,
+		.stack = true,
+	};
+
+	if (!vma_insert (&curr->spt.vmas, &area))
+		return false;
+	if (!vm_alloc_page (VM_ANON | VM_MARKER_0, stack_bottom, true)
+			|| !vm_claim_page (stack_bottom))
+		return false;
+	curr->stack_bottom = stack_bottom;
+	curr->stack_ahead = 0;
+	return true;
+}
+
+/* 스택 구간 AREA 안의 ADDR에서 난 fault로 스택을 키웁니다. RSP는 fault 당시 사용자 rsp입니다.
+ * rsp 아래 red zone보다 먼 곳이면 잘못된 접근이고, guard 페이지에 닿았으면 스택 넘침이므로 false를 반환합니다.
+ * ADDR과 RSP 중 낮은 쪽부터 지금 스택 바닥까지는 이미 스택이므로 한 번에 매핑해서,
+ * 큰 지역 변수를 잡은 함수도 fault 한 번으로 끝나게 합니다.
+ * 그 아래로는 stack_ahead 페이지를 미리 매핑합니다. stack_ahead는 스택을 키우는 fault마다
+ * 두 배로, 이번에 키운 만큼보다는 크게 늘려서(STACK_AHEAD_MAX까지) 깊은 재귀일수록 fault가 드물어집니다. */
+static bool
+vm_stack_growth (struct vm_area *area, void *addr, void *rsp) {
+	struct thread *curr = thread_current ();
+	void *guard = area->start;
+	void *low, *va;
+	size_t room, ahead, need = 0, mapped = 0;
+
+	if ((uintptr_t) addr + STACK_RED_ZONE < (uintptr_t) rsp)
+		return false;
+	if (pg_round_down (addr) == guard) {
+		stack_overflow_cnt++;
+		return false;
+	}
+
+	/* rsp가 guard 아래로 내려갔어도 그 위의 접근은 맞는 접근이므로 guard 바로 위까지만 매핑 */
+	low = pg_round_down (addr < rsp ? addr : rsp);
+	if (low <= guard)
+		low = guard + PGSIZE;
+	room = (low - guard) / PGSIZE - 1;
+	ahead = curr->stack_ahead < room ? curr->stack_ahead : room;
+
+	/* 위쪽으로 올라가다 이미 있는 스택 페이지를 만나면 멈춤 */
+	for (va = low - ahead * PGSIZE; va < (void *) USER_STACK; va += PGSIZE) {
+		if (spt_lookup (&curr->spt, va) != NULL) {
+			if (va >= low)
+				break;
+			continue;
+		}
+		if (!vm_alloc_page (VM_ANON | VM_MARKER_0, va, true) || !vm_claim_page (va))
+			return false;
+		if (va < low)
+			mapped++;
+		else
+			need++;
+	}
+
+	if (low - ahead * PGSIZE < curr->stack_bottom)
+		curr->stack_bottom = low - ahead * PGSIZE;
+	ahead = curr->stack_ahead * 2 > need ? curr->stack_ahead * 2 : need;
+	curr->stack_ahead = ahead < STACK_AHEAD_MAX ? ahead : STACK_AHEAD_MAX;
+	if (curr->stack_ahead == 0)
+		curr->stack_ahead = 1;
+
+	vm_event (VMSTAT_FAULT_STACK, 1);
+	stack_grow_pages += need;
+	stack_ahead_pages += mapped;
+	return true;
+}
+
+/* write-protected 페이지에 대한 fault를 처리합니다.
+ * fork 이후 공유 중인 프레임이나 zero_frame이면 복사본을 만들어 이 페이지만 옮기고(copy-on-write),
+ * 이미 혼자 쓰고 있는 프레임이나 공유 익명 프레임이면 쓰기 권한만 되돌립니다. */
+static bool
+vm_handle_wp (struct page *page) {
+	struct frame *old, *new;
+	bool success;
+
+	if (!page->writable)
+		return false;
+
+	lock_acquire (&frame_lock);
+	old = page->frame;
+	if (old == NULL) {
+		/* 그새 evict 되었으면 다시 실행해서 not-present fault로 처리 */
+		lock_release (&frame_lock);
+		return true;
+	}
+	if ((old->ref_cnt == 1 && old != zero_frame) || page_get_type (page) == VM_SHM) {
+		pml4_set_writable (page->owner->pml4, page->va, true);
+		lock_release (&frame_lock);
+		return true;
+	}
+
+	/* 복사하는 동안 old가 evict 되지 않도록 고정 */
+	old->pin_cnt++;
+	lock_release (&frame_lock);
+
+	new = vm_get_frame ();
+	if (old == zero_frame)
+		memset (new->kva, 0, PGSIZE);
+	else
+		copy_page (new->kva, old->kva);
+
+	lock_acquire (&frame_lock);
+	old->pin_cnt--;
+	frame_remove_page (page);
+	frame_put (old);
+	frame_add_page (new, page);
+	new->pin_cnt--;
+	success = pml4_set_page (page->owner->pml4, page->va, new->kva, true);
+	lock_release (&frame_lock);
+	if (old == zero_frame)
+		zero_cow_cnt++;
+	else
+		vm_event (VMSTAT_FAULT_COW, 1);
+	return success;
+}
+
+/* 아직 쓴 적 없는, 즉 내용이 모두 0인 익명 페이지면 true */
+static bool
+page_is_zero_fill (struct page *page) {
+	if (page->frame != NULL)
+		return false;
+	if (page->operations->type == VM_UNINIT)
+		return VM_TYPE (page->uninit.type) == VM_ANON && page->uninit.init == NULL;
+	return VM_TYPE (page->operations->type) == VM_ANON && page->anon.swap_index == -1;
+}
+
+/* ADDR의 페이지가 아직 쓴 적 없는 익명 페이지면 프레임을 새로 받지 않고
+ * zero_frame을 읽기 전용으로 매핑합니다. 읽기 fault에서만 부릅니다. 매핑했으면 true. */
+static bool
+vm_claim_zero (void *addr) {
+	struct page *page = spt_find_page (&thread_current ()->spt, addr);
+	bool success;
+
+	if (page == NULL || !page_is_zero_fill (page))
+		return false;
+	/* uninit이면 anon으로 바꿈. KVA가 NULL이면 anon_initializer는 내용을 건드리지 않음 */
+	if (page->operations->type == VM_UNINIT && !swap_in (page, NULL))
+		return false;
+
+	lock_acquire (&frame_lock);
+	frame_add_page (zero_frame, page);
+	success = pml4_set_page (page->owner->pml4, page->va, zero_frame->kva, false);
+	if (!success)
+		frame_remove_page (page);
+	lock_release (&frame_lock);
+	if (success) {
+		rss_inc (page->owner);
+		vm_event (VMSTAT_FAULT_ZERO, 1);
+	}
+	return success;
+}
+
+/* 성공 시 true를 반환합니다. */
+static bool
+handle_fault (struct intr_frame *f UNUSED, void *addr UNUSED,
+		bool user UNUSED, bool write UNUSED, bool not_present UNUSED) {
+	struct supplemental_page_table *spt UNUSED = &thread_current ()->spt;
+	struct page *page = NULL;
+	/* TODO: 접근 오류가 유효한지 확인합니다. */
+	/* TODO: 여기에 코드를 작성하세요. */
+	if(is_kernel_vaddr(addr)) return false;
+
+	/* present인데 fault가 났다면 쓰기 보호 위반: COW로 공유된 페이지인지 확인 */
+	if(!not_present)
+	{
+		if(!write)
+			return false;
+		page = spt_find_page(spt, addr);
+		return page != NULL && vm_handle_wp(page);
+	}
+
+	void *rsp_stack = is_kernel_vaddr(f->rsp) ? thread_current()->rsp_stack : f->rsp;
+	if(not_present)
+	{
+		if(!write && vm_claim_zero(addr))
+			return true;
+		if(!vm_claim_page(addr))
+		{
+			struct vm_area *area = vma_find(&spt->vmas, addr);
+
+			if(area != NULL && area->stack)
+				return vm_stack_growth(area, addr, rsp_stack);
+			if(area != NULL && area->uffd)
+				return uffd_handle_fault(addr, write);
+			return false;
+		}
+		else
+			return true;
+	}
+	return false;
+}
+
+/* page fault를 처리하고 종류별로 셉니다. 처리하는 동안 swap이나 파일에서 읽었으면 major,
+ * 아니면 minor fault로 보고 걸린 시간을 그 분포에 기록합니다. 성공 시 true를 반환합니다. */
+bool
+vm_try_handle_fault (struct intr_frame *f, void *addr,
+		bool user, bool write, bool not_present) {
+	long long *events = thread_current ()->vm_events;
+	long long io = events[VMSTAT_SWAP_IN] + events[VMSTAT_FILE_IN]
+		+ events[VMSTAT_FAULT_USER];
+	uint64_t start = rdtsc ();
+	bool success = handle_fault (f, addr, user, write, not_present);
+	uint64_t cycles = rdtsc () - start;
+	int bucket = cycles > 0 ? 63 - __builtin_clzll (cycles) : 0;
+
+	if (bucket >= VMSTAT_HIST_BUCKETS)
+		bucket = VMSTAT_HIST_BUCKETS - 1;
+	vm_event (VMSTAT_FAULT, 1);
+	if (!success)
+		vm_event (VMSTAT_FAULT_BAD, 1);
+	else if (events[VMSTAT_SWAP_IN] + events[VMSTAT_FILE_IN]
+			+ events[VMSTAT_FAULT_USER] != io) {
+		vm_event (VMSTAT_FAULT_MAJOR, 1);
+		major_hist[bucket]++;
+	} else {
+		vm_event (VMSTAT_FAULT_MINOR, 1);
+		minor_hist[bucket]++;
+	}
+	return success;
+}
+
+/* 페이지를 해제합니다.
+ * 이 함수는 수정하지 마세요. */
+void
+vm_dealloc_page (struct page *page) {
+	destroy (page);
+	free (page);
+}
+
+/* 주어진 VA에 해당하는 페이지를 할당합니다. */
+bool
+vm_claim_page (void *va UNUSED) {
+	struct page *page = NULL;
+	/* TODO: 이 함수를 구현하세요. */
+    page = spt_find_page(&thread_current()->spt,va);
+
+    if(page == NULL){
+        return false;
+    }
+
+    return vm_do_claim_page (page);
+}
+
+/* 내용을 채운 고정된 FRAME을 PAGE에 연결하고 매핑한 뒤 고정을 풉니다. */
+static bool
+frame_map (struct frame *frame, struct page *page) {
+	struct container *text = file_backed_text (page);
+	bool success;
+
+	/* 링크 설정 */
+	lock_acquire (&frame_lock);
+	frame_add_page (frame, page);
+	frame->pin_cnt--;
+
+	/* TODO: 페이지 테이블 엔트리를 추가하여 페이지의 VA와 프레임의 PA를 매핑합니다. */
+	success = install_page(page->va, frame->kva, page->writable);
+	/* 실행 파일의 읽기 전용 페이지면 다른 프로세스도 쓸 수 있게 캐시에 올림 */
+	if (success && text != NULL)
+		text_insert (frame, file_get_inode (text->file), text->offset,
+				text->page_read_bytes);
+	lock_release (&frame_lock);
+	if (success)
+		rss_inc (page->owner);
+	return success;
+}
+
+/* 고정된 FRAME의 고정을 풉니다. 아무 페이지에도 연결되어 있지 않으면 user pool에 돌려줍니다. */
+void
+vm_unpin_frame (struct frame *frame) {
+	lock_acquire (&frame_lock);
+	frame->pin_cnt--;
+	frame_put (frame);
+	lock_release (&frame_lock);
+}
+
+/* 새 프레임을 고정해서 얻고 SRC부터 한 페이지를 복사해 반환합니다. SRC는 현재 프로세스의 사용자 주소여도 됩니다.
+ * 호출자는 프레임을 vm_install_frame()에 넘기거나 vm_unpin_frame()으로 돌려줍니다. */
+struct frame *
+vm_fill_frame (const void *src) {
+	struct frame *frame = vm_get_frame ();
+
+	memcpy (frame->kva, src, PGSIZE);
+	return frame;
+}
+
+/* 현재 프로세스의 VA에 익명 페이지를 만들고 이미 채운 FRAME을 매핑합니다.
+ * FRAME은 vm_fill_frame()이 준 고정된 프레임이며 이 함수가 넘겨받습니다. NULL이면 0으로 채운 페이지를 올립니다.
+ * VA에 이미 페이지가 있으면 false. */
+bool
+vm_install_frame (void *va, struct frame *frame, bool writable) {
+	struct page *page;
+
+	if (!vm_alloc_page (VM_ANON, va, writable)
+			|| (page = spt_lookup (&thread_current ()->spt, va)) == NULL) {
+		if (frame != NULL)
+			vm_unpin_frame (frame);
+		return false;
+	}
+	if (frame == NULL)
+		return vm_do_claim_page (page);
+	/* uninit을 anon으로 바꿈. KVA가 NULL이면 anon_initializer는 내용을 건드리지 않음 */
+	if (!swap_in (page, NULL)) {
+		vm_unpin_frame (frame);
+		return false;
+	}
+	return frame_map (frame, page);
+}
+
+/* PAGE가 프레임에 올라와 있으면 그 프레임을 고정해서 반환합니다. 호출자는 내용을 읽은 뒤 vm_unpin_frame()을 부릅니다.
+ * 올라와 있지 않거나 kswapd가 내보내는 중이면 NULL. */
+struct frame *
+vm_pin_frame (struct page *page) {
+	struct frame *frame;
+
+	lock_acquire (&frame_lock);
+	frame = page->frame;
+	if (frame != NULL && !frame->reclaim)
+		frame->pin_cnt++;
+	else
+		frame = NULL;
+	lock_release (&frame_lock);
+	return frame;
+}
+
+/* 익명 페이지 PAGE의 내용 전체를 호출자가 덮어쓸 수 있게, PAGE 혼자 쓰는 프레임을 고정해서 반환합니다.
+ * 호출자는 커널 주소로 내용을 채운 뒤 vm_unpin_frame()을 부릅니다.
+ * 어차피 덮어쓰므로 fork나 zero_frame으로 공유하던 프레임은 복사하지 않고 새 프레임으로 옮기고,
+ * 아직 쓴 적 없는 페이지는 0으로 채우지 않고 프레임만 붙입니다.
+ * 익명 페이지가 아니거나, swap에 내용이 있거나, kswapd가 내보내는 중이면 NULL. */
+struct frame *
+vm_pin_fill_frame (struct page *page) {
+	struct frame *old, *new;
+
+	if (!page->writable || page_get_type (page) != VM_ANON)
+		return NULL;
+	/* uninit이면 anon으로 바꿈. KVA가 NULL이면 anon_initializer는 내용을 건드리지 않음 */
+	if (page->operations->type == VM_UNINIT
+			&& (page->uninit.init != NULL || !swap_in (page, NULL)))
+		return NULL;
+
+	lock_acquire (&frame_lock);
+	old = page->frame;
+	if (old != NULL && old->ref_cnt == 1 && old != zero_frame && !old->reclaim) {
+		old->pin_cnt++;
+		/* 새로 쓰는 내용이므로 MADV_FREE 후라도 버리면 안 됨 */
+		page->lazyfree = false;
+		lock_release (&frame_lock);
+		return old;
+	}
+	lock_release (&frame_lock);
+	if (old == NULL && page->anon.swap_index != -1)
+		return NULL;
+
+	new = vm_get_frame ();
+	lock_acquire (&frame_lock);
+	old = page->frame;
+	if ((old == NULL && page->anon.swap_index != -1) || (old != NULL && old->reclaim)) {
+		/* 그새 evict 되었거나 되는 중: 보통 경로로 읽게 함 */
+		new->pin_cnt--;
+		frame_put (new);
+		lock_release (&frame_lock);
+		return NULL;
+	}
+	if (old != NULL) {
+		frame_remove_page (page);
+		frame_put (old);
+		zero_copy_cow_cnt++;
+	}
+	frame_add_page (new, page);
+	if (!pml4_set_page (page->owner->pml4, page->va, new->kva, true)) {
+		frame_remove_page (page);
+		new->pin_cnt--;
+		frame_put (new);
+		new = NULL;
+	}
+	lock_release (&frame_lock);
+	if (new != NULL && old == NULL)
+		rss_inc (page->owner);
+	return new;
+}
+
+/* INODE의 OFS부터 한 페이지가 text 캐시에 있으면 KVA로 복사하고 true를 반환합니다. */
+bool
+vm_read_cached (struct inode *inode, off_t ofs, void *kva) {
+	struct frame *frame;
+
+	lock_acquire (&frame_lock);
+	frame = text_lookup (inode, ofs, PGSIZE);
+	if (frame != NULL)
+		copy_page (kva, frame->kva);
+	lock_release (&frame_lock);
+	return frame != NULL;
+}
+
+/* PAGE가 프레임에 올라와 있고 그 프레임을 매핑한 페이지 중 하나라도 dirty면,
+ * 모든 매핑의 dirty 비트를 지우고 프레임을 고정해서 반환합니다. 호출자는 내용을 쓴 뒤 vm_unpin_frame()을 부릅니다.
+ * 현재 프로세스의 매핑은 TLB를 비우지 않으므로, 호출자가 여러 페이지를 모은 뒤
+ * 내용을 쓰기 전에 pml4_flush_tlb()를 한 번 불러야 합니다. 깨끗하거나 올라와 있지 않으면 NULL. */
+struct frame *
+vm_pin_dirty_frame (struct page *page) {
+	uint64_t *pml4 = thread_current ()->pml4;
+	struct frame *frame;
+	struct list_elem *e;
+	bool dirty = false;
+
+	lock_acquire (&frame_lock);
+	frame = page->frame;
+	if (frame != NULL)
+		for (e = list_begin (&frame->pages); e != list_end (&frame->pages); e = list_next (e)) {
+			struct page *p = list_entry (e, struct page, share_elem);
+
+			if (p->owner->pml4 == pml4)
+				dirty |= pml4_test_clear_dirty (pml4, p->va);
+			else if (p->owner->pml4 != NULL && pml4_is_dirty (p->owner->pml4, p->va)) {
+				pml4_set_dirty (p->owner->pml4, p->va, false);
+				dirty = true;
+			}
+		}
+	if (dirty)
+		frame->pin_cnt++;
+	lock_release (&frame_lock);
+	return dirty ? frame : NULL;
+}
+
+/* 주어진 PAGE를 할당하고 MMU를 설정합니다. 이웃 페이지를 미리 읽지는 않습니다. */
+static bool
+do_claim_page (struct page *page) {
+	struct frame *frame;
+	bool success;
+
+	/* kswapd가 내보내는 중이라 매핑만 끊긴 프레임이면 내보내기를 취소하고 다시 매핑 */
+	lock_acquire (&frame_lock);
+	frame = page->frame;
+	if (frame != NULL) {
+		frame->reclaim = false;
+		/* 공유 익명 프레임은 여러 프로세스가 함께 씀. 나머지는 혼자 쓰는 프레임만 쓰기 가능 */
+		success = pml4_set_page (page->owner->pml4, page->va, frame->kva, page->writable
+				&& (page_get_type (page) == VM_SHM
+					|| (frame->ref_cnt == 1 && frame != zero_frame)));
+		lock_release (&frame_lock);
+		remap_cnt++;
+		return success;
+	}
+	lock_release (&frame_lock);
+
+	frame = vm_get_frame ();
+
+	/* 내용을 먼저 채움. 프레임이 고정되어 있고 역매핑에도 없으므로 그동안 evict 되지 않음 */
+	page->frame = frame;
+	if (!swap_in(page, frame->kva))
+	{
+		page->frame = NULL;
+		vm_unpin_frame (frame);
+		return false;
+	}
+
+	return frame_map (frame, page);
+}
+
+/* swap에서 SLOT을 읽어 온 PAGE 뒤로, 다음 slot들에 차례로 놓인 다음 가상 페이지들을 미리 읽어 옵니다.
+ * swap_alloc()이 한 주소 창의 페이지를 같은 순서로 한 cluster에 놓으므로 대개 이어져 있습니다.
+ * 빈 프레임이 low watermark 아래면 미리 읽느라 다른 페이지를 내보내지 않도록 멈춥니다.
+ * 미리 읽은 페이지는 accessed 비트가 꺼진 채 매핑되므로, 쓰이지 않으면 clock이 먼저 내보냅니다. */
+static void
+swap_readahead (struct page *page, size_t slot) {
+	struct palloc_stats st;
+	int i;
+
+	for (i = 1; i <= SWAP_RA_PAGES; i++) {
+		struct page *next = spt_find_page (&page->owner->spt, page->va + i * PGSIZE);
+
+		if (next == NULL || next->frame != NULL
+				|| VM_TYPE (next->operations->type) != VM_ANON
+				|| next->anon.swap_index != (int) (slot + i))
+			break;
+		palloc_get_stats (PAL_USER, &st);
+		if (st.free < st.wmark_low || !do_claim_page (next))
+			break;
+		readahead_cnt++;
+	}
+}
+
+/* 실행 파일의 읽기 전용 페이지 PAGE가 text 캐시에 있으면, 즉 같은 프로그램을 실행한 다른 프로세스가
+ * 이미 읽어 둔 프레임이 있으면 그 프레임을 함께 매핑합니다. 캐시에 없으면 false를 반환합니다.
+ * SUCCESS에 매핑 결과를 돌려줍니다. */
+static bool
+text_share (struct page *page, bool *success) {
+	struct container *text = file_backed_text (page);
+	struct frame *frame;
+
+	if (text == NULL)
+		return false;
+	lock_acquire (&frame_lock);
+	frame = text_lookup (file_get_inode (text->file), text->offset,
+			text->page_read_bytes);
+	if (frame == NULL) {
+		lock_release (&frame_lock);
+		return false;
+	}
+	file_backed_loaded (page, frame->kva);
+	frame_add_page (frame, page);
+	*success = install_page (page->va, frame->kva, false);
+	lock_release (&frame_lock);
+	if (*success)
+		rss_inc (page->owner);
+	text_share_cnt++;
+	return true;
+}
+
+/* PAGE가 text 캐시에 있는지 봅니다. */
+static bool
+text_present (struct page *page) {
+	struct container *text = file_backed_text (page);
+	bool present;
+
+	if (text == NULL)
+		return false;
+	lock_acquire (&frame_lock);
+	present = text_lookup (file_get_inode (text->file), text->offset,
+			text->page_read_bytes) != NULL;
+	lock_release (&frame_lock);
+	return present;
+}
+
+/* 빈 프레임을 low watermark 아래로 내리지 않고 한 번에 읽을 수 있는 최대 페이지 수 */
+static size_t
+batch_limit (void) {
+	struct palloc_stats st;
+	size_t cnt;
+
+	palloc_get_stats (PAL_USER, &st);
+	cnt = st.free > st.wmark_low ? st.free - st.wmark_low : 1;
+	return cnt < FAULT_AROUND_MAX ? cnt : FAULT_AROUND_MAX;
+}
+
+/* 파일에서 이어지는 CNT개의 페이지 PAGES를 한 번의 파일 읽기로 채우고 매핑합니다.
+ * 다른 프로세스가 이미 읽어 둔 이웃은 그 fault 때 캐시에서 매핑하도록 남겨 둡니다.
+ * 묶음 읽기에 실패하면 PAGES[0]만 읽습니다. 읽은 페이지 수를 *CNT에 돌려주고 PAGES[0]의 결과를 반환합니다. */
+static bool
+file_read_pages (struct page **pages, size_t *cnt_) {
+	size_t cnt = *cnt_, i;
+	bool success;
+
+	for (i = 1; i < cnt; i++)
+		if (text_present (pages[i]))
+			break;
+	*cnt_ = cnt = i;
+	if (cnt == 1)
+		return do_claim_page (pages[0]);
+
+	for (i = 0; i < cnt; i++)
+		pages[i]->frame = vm_get_frame ();
+	if (!file_backed_read_around (pages, cnt)) {
+		for (i = 0; i < cnt; i++) {
+			vm_unpin_frame (pages[i]->frame);
+			pages[i]->frame = NULL;
+		}
+		*cnt_ = 1;
+		return do_claim_page (pages[0]);
+	}
+
+	success = frame_map (pages[0]->frame, pages[0]);
+	for (i = 1; i < cnt; i++)
+		frame_map (pages[i]->frame, pages[i]);
+	fault_around_reads++;
+	return success;
+}
+
+/* 파일 기반 PAGE와 같은 매핑에서 바로 뒤따르는, 아직 올라오지 않은 페이지들을
+ * 한 번의 파일 읽기로 함께 채우고 매핑합니다(fault-around).
+ * 함께 매핑한 페이지는 accessed 비트가 꺼진 채 매핑되므로, 쓰이지 않으면 clock이 먼저 내보냅니다.
+ * 빈 프레임이 low watermark 아래면 이웃 페이지를 붙이지 않고, 묶음 읽기에 실패하면 PAGE만 읽습니다. */
+static bool
+file_fault_around (struct page *page) {
+	struct page *pages[FAULT_AROUND_MAX];
+	size_t cnt = file_backed_around (page, pages, batch_limit ());
+	bool success = file_read_pages (pages, &cnt);
+
+	fault_around_cnt += cnt - 1;
+	return success;
+}
+
+/* 공유 익명 PAGE를 매핑합니다. 객체에 이미 프레임이 있으면 그 프레임을 쓰기 가능하게 함께 매핑하고,
+ * 없으면 새 프레임을 swap이나 0으로 채워 객체에 기록합니다.
+ * 객체의 lock이 두 프로세스가 같은 페이지를 따로 채우지 않게 막습니다. */
+static bool
+shm_claim (struct page *page) {
+	struct shm *obj;
+	struct shm_slot *slot;
+	struct frame *frame;
+	bool success;
+
+	/* uninit이면 shm 페이지로 바꿈. 내용은 아래에서 채움 */
+	if (page->operations->type == VM_UNINIT && !swap_in (page, NULL))
+		return false;
+	obj = page->shm.obj;
+	slot = &obj->slots[page->shm.idx];
+
+	lock_acquire (&obj->lock);
+	lock_acquire (&frame_lock);
+	frame = slot->frame;
+	if (frame != NULL) {
+		/* kswapd가 내보내는 중이면 취소 */
+		frame->reclaim = false;
+		frame_add_page (frame, page);
+		success = pml4_set_page (page->owner->pml4, page->va, frame->kva, page->writable);
+		if (!success)
+			frame_remove_page (page);
+		else if (slot->held) {
+			/* 다시 매핑되었으니 객체가 붙잡아 둔 고정을 풂 */
+			frame->pin_cnt--;
+			slot->held = false;
+		}
+		lock_release (&frame_lock);
+		lock_release (&obj->lock);
+		if (success) {
+			rss_inc (page->owner);
+			shm_share_cnt++;
+		}
+		return success;
+	}
+	lock_release (&frame_lock);
+
+	frame = vm_get_frame ();
+	page->frame = frame;
+	swap_in (page, frame->kva);
+	lock_acquire (&frame_lock);
+	slot->frame = frame;
+	lock_release (&frame_lock);
+	success = frame_map (frame, page);
+	lock_release (&obj->lock);
+	shm_load_cnt++;
+	return success;
+}
+
+/* 주어진 PAGE를 할당하고 MMU를 설정합니다.
+ * swap에서 읽어 오는 익명 페이지면 이웃 페이지도 미리 읽어 오고,
+ * 파일 기반 페이지면 같은 매핑의 이웃 페이지를 함께 읽어 매핑합니다. */
+static bool
+vm_do_claim_page (struct page *page) {
+	int slot = -1;
+
+	if (page->frame == NULL && page_get_type (page) == VM_SHM)
+		return shm_claim (page);
+
+	if (page->frame == NULL && page_get_type (page) == VM_FILE) {
+		bool success;
+
+		if (text_share (page, &success))
+			return success;
+		return file_fault_around (page);
+	}
+	/* MADV_RANDOM이면 이웃 slot을 미리 읽어도 쓰일 가능성이 낮음 */
+	if (VM_TYPE (page->operations->type) == VM_ANON && page->frame == NULL
+			&& page->advice != MADV_RANDOM)
+		slot = page->anon.swap_index;
+	if (!do_claim_page (page))
+		return false;
+	if (slot != -1)
+		swap_readahead (page, slot);
+	return true;
+}
+
+/* 현재 프로세스의 [START, END) 페이지를 미리 프레임에 올려 이후 접근에서 fault가 나지 않게 합니다.
+ * 파일 기반 페이지는 파일에서 이어지는 만큼 FAULT_AROUND_MAX개씩 묶어 한 번에 읽습니다.
+ * FORCE가 아니면(MADV_WILLNEED) 빈 프레임이 low watermark 아래로 내려가면 멈추고,
+ * 아직 쓴 적 없는 익명 페이지는 첫 접근 때 zero_frame을 매핑하도록 남겨 둡니다. */
+void
+vm_populate (void *start, void *end, bool force) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	struct page *pages[FAULT_AROUND_MAX];
+	struct palloc_stats st;
+	void *va = start;
+
+	while (va < end) {
+		struct page *page = spt_find_page (spt, va);
+		size_t cnt = 1, max;
+		bool success;
+
+		if (!force) {
+			palloc_get_stats (PAL_USER, &st);
+			if (st.free < st.wmark_low)
+				break;
+		}
+		if (page == NULL || page->frame != NULL
+				|| (!force && page_is_zero_fill (page))) {
+			va += PGSIZE;
+			continue;
+		}
+		/* 공유 익명 페이지는 객체의 프레임을 함께 쓰거나 객체에 기록해야 하므로 shm_claim()으로 */
+		if (page_get_type (page) == VM_SHM)
+			vm_do_claim_page (page);
+		else if (page_get_type (page) != VM_FILE)
+			do_claim_page (page);
+		else if (!text_share (page, &success)) {
+			max = batch_limit ();
+			if (max > (size_t) (end - va) / PGSIZE)
+				max = (end - va) / PGSIZE;
+			cnt = file_backed_run (page, pages, max);
+			file_read_pages (pages, &cnt);
+		}
+		populate_cnt += cnt;
+		va += cnt * PGSIZE;
+	}
+}
+
+/* spt_for_each_in_range() 콜백: mlock 된 페이지가 있으면 *AUX를 true로 */
+static void
+page_find_mlocked (struct page *page, void *found) {
+	if (page->mlocked)
+		*(bool *) found = true;
+}
+
+/* spt_for_each_in_range() 콜백: 페이지의 접근 패턴 힌트를 *AUX로 바꿈 */
+static void
+page_advise (struct page *page, void *advice) {
+	page->advice = *(int *) advice;
+}
+
+/* spt_for_each_in_range() 콜백: MADV_DONTNEED. 내용을 버리고 다음 접근 때 다시 채움 */
+static void
+page_dontneed (struct page *page, void *aux UNUSED) {
+	if (page->operations->type == VM_ANON)
+		anon_discard (page);
+	else if (page->operations->type == VM_FILE)
+		file_backed_discard (page);
+}
+
+/* spt_for_each_in_range() 콜백: MADV_FREE. 익명 페이지의 dirty 비트를 지워 두고,
+ * 그 뒤로 쓰이지 않은 채 evict 되면 swap에 쓰지 않고 버림. swap에만 있는 내용은 바로 버림 */
+static void
+page_lazyfree (struct page *page, void *aux UNUSED) {
+	if (page->operations->type != VM_ANON)
+		return;
+	lock_acquire (&frame_lock);
+	if (page->frame == NULL) {
+		lock_release (&frame_lock);
+		anon_discard (page);
+		return;
+	}
+	if (page->frame != zero_frame && !page->mlocked) {
+		pml4_set_dirty (page->owner->pml4, page->va, false);
+		page->lazyfree = true;
+	}
+	lock_release (&frame_lock);
+}
+
+/* 현재 프로세스의 [ADDR, ADDR + LENGTH)에 madvise(2)의 ADVICE를 적용합니다.
+ * NORMAL, RANDOM, SEQUENTIAL은 구간과 이미 만든 페이지에 힌트를 기록합니다.
+ * 구간을 나누지 않으므로 구간의 일부만 지정해도 구간 전체의 새 페이지가 힌트를 따릅니다.
+ * 범위가 잘못되었거나, 알 수 없는 ADVICE이거나, mlock 된 페이지를 DONTNEED 하려 하면 false. */
+bool
+vm_madvise (void *addr, size_t length, int advice) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	void *end = pg_round_up (addr + length);
+	bool locked = false;
+
+	if (pg_ofs (addr) != 0 || end < addr || (end > addr && !is_user_vaddr (end - 1)))
+		return false;
+
+	switch (advice) {
+		case MADV_NORMAL:
+		case MADV_RANDOM:
+		case MADV_SEQUENTIAL:
+			vma_advise (&spt->vmas, addr, end, advice);
+			spt_for_each_in_range (spt, addr, end, page_advise, &advice);
+			return true;
+		case MADV_WILLNEED:
+			vm_populate (addr, end, false);
+			return true;
+		case MADV_DONTNEED:
+			spt_for_each_in_range (spt, addr, end, page_find_mlocked, &locked);
+			if (locked)
+				return false;
+			spt_for_each_in_range (spt, addr, end, page_dontneed, NULL);
+			return true;
+		case MADV_FREE:
+			spt_for_each_in_range (spt, addr, end, page_lazyfree, NULL);
+			return true;
+		default:
+			return false;
+	}
+}
+
+/* PAGE를 프레임에 올리고 evict 되지 않게 고정합니다.
+ * kswapd가 내보내는 중인 프레임이면 다시 매핑해서 내보내기를 취소한 뒤 고정합니다. */
+static bool
+page_mlock (struct page *page) {
+	for (;;) {
+		lock_acquire (&frame_lock);
+		if (page->frame != NULL && !page->frame->reclaim) {
+			if (!page->mlocked) {
+				page->mlocked = true;
+				page->frame->lock_cnt++;
+				vm_usage_add (&page->owner->vm_usage.locked, 1);
+			}
+			lock_release (&frame_lock);
+			return true;
+		}
+		lock_release (&frame_lock);
+		if (!vm_do_claim_page (page))
+			return false;
+	}
+}
+
+/* spt_for_each_in_range() 콜백: 페이지의 mlock을 풂 */
+static void
+page_munlock (struct page *page, void *aux UNUSED) {
+	lock_acquire (&frame_lock);
+	if (page->mlocked) {
+		page->mlocked = false;
+		page->frame->lock_cnt--;
+		vm_usage_add (&page->owner->vm_usage.locked, -1);
+	}
+	lock_release (&frame_lock);
+}
+
+/* 현재 프로세스의 [ADDR, ADDR + LENGTH)를 담은 페이지를 모두 프레임에 올리고 고정합니다.
+ * 범위에 없는 페이지가 있거나, 고정한 페이지가 mlock_limit을 넘게 되면 아무것도 하지 않고 false.
+ * 도중에 프레임을 얻지 못해도, 이번에 고정한 페이지를 다시 풀고 false. */
+bool
+vm_mlock (const void *addr, size_t length) {
+	struct thread *curr = thread_current ();
+	void *start = pg_round_down (addr);
+	void *end = pg_round_up (addr + length);
+	struct bitmap *locked;
+	size_t need = 0, i;
+	bool ok = true;
+	void *va;
+
+	if (end < start || (end > start && !is_user_vaddr (end - 1)))
+		return false;
+	for (va = start; va < end; va += PGSIZE) {
+		struct page *page = spt_find_page (&curr->spt, va);
+
+		if (page == NULL)
+			return false;
+		if (!page->mlocked)
+			need++;
+	}
+	if (curr->vm_usage.locked + need > mlock_limit)
+		return false;
+	if (need == 0)
+		return true;
+
+	/* 이번에 고정한 페이지를 기억해 두었다가 실패하면 그것만 풂 */
+	locked = bitmap_create ((end - start) / PGSIZE);
+	if (locked == NULL)
+		return false;
+	for (va = start, i = 0; ok && va < end; va += PGSIZE, i++) {
+		struct page *page = spt_find_page (&curr->spt, va);
+
+		if (page->mlocked)
+			continue;
+		ok = page_mlock (page);
+		if (ok)
+			bitmap_mark (locked, i);
+	}
+	if (!ok)
+		for (va = start, i = 0; va < end; va += PGSIZE, i++)
+			if (bitmap_test (locked, i))
+				page_munlock (spt_find_page (&curr->spt, va), NULL);
+	bitmap_destroy (locked);
+	return ok;
+}
+
+/* 현재 프로세스의 [ADDR, ADDR + LENGTH)의 mlock을 풉니다. 고정하지 않은 페이지는 건너뜁니다. */
+bool
+vm_munlock (const void *addr, size_t length) {
+	void *start = pg_round_down (addr);
+	void *end = pg_round_up (addr + length);
+
+	if (end < start || (end > start && !is_user_vaddr (end - 1)))
+		return false;
+	spt_for_each_in_range (&thread_current ()->spt, start, end, page_munlock, NULL);
+	return true;
+}
+
+void
+supplemental_page_table_init (struct supplemental_page_table *spt UNUSED) {
+	spt->radix = spt_radix;
+	if (spt->radix)
+		radix_init(&spt->tree);
+	else
+		hash_init(&spt->pages, page_hash, page_less, NULL);
+	vma_init(&spt->vmas);
+}
+
+/* 프레임에 올라와 있는 부모 페이지 PARENT를 자식 페이지 CHILD와 공유합니다.
+ * 두 매핑 모두 읽기 전용으로 두고, 먼저 쓰는 쪽이 vm_handle_wp()에서 복사본을 가져갑니다.
+ * frame_lock을 잡고 호출해야 합니다. */
+static bool
+vm_share_frame (struct page *child, struct page *parent) {
+	struct frame *frame = parent->frame;
+
+	/* kswapd가 내보내는 중이면 취소. 자식 매핑이 살아 있는 프레임을 swap으로 넘기면 안 됨 */
+	frame->reclaim = false;
+	if (!pml4_set_page (child->owner->pml4, child->va, frame->kva, false))
+		return false;
+	if (parent->writable)
+		pml4_set_writable (parent->owner->pml4, parent->va, false);
+	frame_add_page (frame, child);
+	rss_inc (child->owner);
+	cow_share_cnt++;
+	return true;
+}
+
+/* 부모 페이지 PARENT_PAGE의 사본을 만들어 dst에 넣습니다.
+ * 페이지 내용은 복사하지 않고 프레임과 swap slot을 부모와 공유합니다(copy-on-write). */
+static bool
+spt_copy_page(struct supplemental_page_table *dst, struct page *parent_page)
+{
+	/* 공유 익명 페이지는 자식이 처음 접근할 때 복사한 구간의 객체에서 찾아 매핑함 */
+	if (page_get_type(parent_page) == VM_SHM)
+		return true;
+
+	struct page *child_page = malloc(sizeof *child_page);
+
+	if (child_page == NULL)
+		return false;
+
+	/* 타입별 데이터(uninit의 initializer, anon의 swap slot, file의 container)까지 그대로 가져옴 */
+	*child_page = *parent_page;
+	child_page->owner = thread_current ();
+	child_page->frame = NULL;
+	/* mlock은 fork로 물려주지 않음 */
+	child_page->mlocked = false;
+	if (!spt_insert_page(dst, child_page))
+	{
+		free(child_page);
+		return false;
+	}
+
+	/* container는 munmap이나 destroy에서 해제되므로 부모와 공유하면 안 됨 */
+	if (page_get_type(child_page) == VM_FILE && !file_backed_fork(child_page))
+		return false;
+
+	if (parent_page->operations->type == VM_UNINIT)
+		return true;
+
+	/* 프레임에 있는지는 다른 프로세스의 eviction과 겹치지 않게 frame_lock 아래에서 봐야 함 */
+	bool success = true;
+	lock_acquire(&frame_lock);
+	if (parent_page->frame != NULL)
+		success = vm_share_frame(child_page, parent_page);
+	else if (VM_TYPE(parent_page->operations->type) == VM_ANON)
+		anon_swap_fork(child_page);
+	lock_release(&frame_lock);
+	return success;
+}
+
+/* radix_walk()에 넘길 supplemental_page_table_copy()의 인자 */
+struct copy_walk {
+	struct supplemental_page_table *dst;
+	bool success;
+};
+
+static void
+copy_walk_page(void *page, void *aux)
+{
+	struct copy_walk *w = aux;
+
+	if (w->success)
+		w->success = spt_copy_page(w->dst, page);
+}
+
+/* 보조 페이지 테이블을 src로부터 dst로 복사합니다.
+ * 페이지 내용은 복사하지 않고 프레임과 swap slot을 부모와 공유합니다(copy-on-write).
+ * radix tree면 주소 순서로 복사합니다.
+ * 현재 스레드가 dst를 가진 자식 프로세스여야 합니다. */
+bool supplemental_page_table_copy(struct supplemental_page_table *dst UNUSED,
+								  struct supplemental_page_table *src UNUSED)
+{
+	// project 3
+	struct hash_iterator i;
+
+	/* 구간을 먼저 복사해야 file 페이지의 container가 자식의 파일을 가리키게 할 수 있음 */
+	if (!vma_copy(&dst->vmas, &src->vmas))
+		return false;
+	if (src->radix)
+	{
+		struct copy_walk w = { dst, true };
+
+		radix_walk(&src->tree, NULL, (void *) KERN_BASE, copy_walk_page, &w);
+		return w.success;
+	}
+	hash_first(&i, &src->pages);
+	while (hash_next(&i))
+		if (!spt_copy_page(dst, hash_entry(hash_cur(&i), struct page, hash_elem)))
+			return false;
+	return true;
+}
+
+static void page_destructor(struct hash_elem *e, void *aux UNUSED)
+{
+	struct page *p = hash_entry(e, struct page, hash_elem);
+	vm_dealloc_page(p);
+}
+
+static void
+radix_page_destructor(void *page, void *aux UNUSED)
+{
+	vm_dealloc_page(page);
+}
+
+/* TD에 모인 페이지를 한꺼번에 정리합니다.
+ * frame_lock을 한 번 잡고 모든 프레임을 떼어 낸 뒤, 물리 페이지와 swap slot을 각각 한 번에 돌려줍니다. */
+static void
+teardown_flush (struct teardown *td)
+{
+	size_t i;
+
+	lock_acquire(&frame_lock);
+	for (i = 0; i < td->page_cnt; i++)
+		if (td->pages[i]->frame != NULL)
+			frame_unmap_page(td->pages[i], td);
+	lock_release(&frame_lock);
+
+	for (i = 0; i < td->page_cnt; i++)
+	{
+		struct page *page = td->pages[i];
+
+		/* 익명 페이지의 swap slot은 모았다가 내려놓음. destroy는 프레임도 slot도 없는 페이지만 보게 됨 */
+		if (VM_TYPE(page->operations->type) == VM_ANON && page->anon.swap_index != -1)
+		{
+			td->slots[td->slot_cnt++] = page->anon.swap_index;
+			page->anon.swap_index = -1;
+			vm_usage_add(&page->owner->vm_usage.swap, -1);
+		}
+		vm_dealloc_page(page);
+	}
+
+	palloc_free_pages(td->kvas, td->kva_cnt);
+	swap_free_multiple(td->slots, td->slot_cnt);
+	reap_page_cnt += td->page_cnt;
+	reap_batch_cnt++;
+	td->page_cnt = td->kva_cnt = td->slot_cnt = 0;
+}
+
+static void
+teardown_page (void *page, void *td_)
+{
+	struct teardown *td = td_;
+
+	td->pages[td->page_cnt++] = page;
+	if (td->page_cnt == TEARDOWN_BATCH)
+		teardown_flush(td);
+}
+
+static void
+teardown_hash_page (struct hash_elem *e, void *td)
+{
+	teardown_page(hash_entry(e, struct page, hash_elem), td);
+}
+
+/* 공유 mmap 구간을 munmap처럼 정리합니다. dirty 페이지는 파일에 쓰고 파일을 닫습니다.
+ * 현재 스레드의 SPT여야 합니다. */
+void spt_unmap_shared(struct supplemental_page_table *spt)
+{
+	struct vm_areas *vmas = &spt->vmas;
+	size_t i = 0;
+
+	ASSERT(spt == &thread_current()->spt);
+	while (i < vmas->cnt)
+	{
+		if (vmas->areas[i].shared)
+			do_munmap(vmas->areas[i].start);
+		else
+			i++;
+	}
+}
+
+/* 스레드 T의 남은 페이지, 구간, swap 예약을 모두 정리합니다.
+ * 페이지를 묶음으로 모아 프레임과 swap slot을 한꺼번에 돌려줍니다.
+ * page table의 매핑은 지우지 않으므로, 그 뒤에 pml4_destroy_tables()로 table만 해제해야 합니다.
+ * T가 실행 중이 아니어도 됩니다(reaper 스레드가 부름). */
+void spt_teardown(struct thread *t)
+{
+	struct supplemental_page_table *spt = &t->spt;
+	struct teardown *td = palloc_get_page(0);
+
+	if (td == NULL)
+	{
+		/* 묶음을 둘 곳이 없으면 하나씩 정리함. 매핑도 하나씩 지워짐 */
+		if (spt->radix)
+			radix_destroy(&spt->tree, radix_page_destructor, NULL);
+		else
+			hash_destroy(&spt->pages, page_destructor);
+	}
+	else
+	{
+		td->page_cnt = td->kva_cnt = td->slot_cnt = 0;
+		if (spt->radix)
+			radix_destroy(&spt->tree, teardown_page, td);
+		else
+		{
+			spt->pages.aux = td;
+			hash_destroy(&spt->pages, teardown_hash_page);
+		}
+		if (td->page_cnt > 0)
+			teardown_flush(td);
+		palloc_free_page(td);
+		reap_space_cnt++;
+	}
+	vma_destroy(&spt->vmas);
+	swap_release(t);
+}
+
 /* 보조 페이지 테이블이 사용하는 자원을 해제합니다. */
 void supplemental_page_table_kill(struct supplemental_page_table *spt UNUSED)
 {
 	/* TODO: 해당 스레드가 보유한 모든 supplemental_page_table을 제거하고,
 	 * TODO: 수정된 내용을 저장소에 기록합니다. */
-	hash_destroy(&spt->pages, page_destructor);
+	spt_unmap_shared(spt);
+	spt_teardown(thread_current());
+}
+
+/* fault 시간 분포 HIST에서 PERCENT 백분위 fault가 속한 구간의 상한(cycle)을 구합니다. */
+static uint64_t
+fault_percentile (const long long *hist, int percent) {
+	long long total = 0, seen = 0;
+	int i;
+
+	for (i = 0; i < VMSTAT_HIST_BUCKETS; i++)
+		total += hist[i];
+	if (total == 0)
+		return 0;
+	for (i = 0; i < VMSTAT_HIST_BUCKETS; i++) {
+		seen += hist[i];
+		if (seen * 100 >= total * percent)
+			break;
+	}
+	return i < VMSTAT_HIST_BUCKETS - 1 ? 1ULL << (i + 1) : UINT64_MAX;
+}
+
+/* VM 통계를 출력합니다. */
+void
+vm_print_stats (void) {
+	size_t swap_total, swap_used;
+	struct zswap_stats zs;
+	size_t ksm_shared = 0, ksm_sharing = 0, i;
+	long long uffd_copied, uffd_zeroed;
+	long long scans_per_victim = vm_events[VMSTAT_EVICT]
+		? vm_events[VMSTAT_SCAN] * 100 / vm_events[VMSTAT_EVICT] : 0;
+
+	swap_stats (&swap_total, &swap_used);
+	zswap_get_stats (&zs);
+	printf ("VM: %zu frames in use, %lld evictions, "
+			"%lld shrinks freed %lld pages, swap %zu of %zu pages used\n",
+			frame_used_cnt, vm_events[VMSTAT_EVICT], shrink_cnt, shrink_freed,
+			swap_used, swap_total);
+	printf ("VM: %lld page faults: %lld major, %lld minor, %lld unhandled, "
+			"%lld grew the stack\n",
+			vm_events[VMSTAT_FAULT], vm_events[VMSTAT_FAULT_MAJOR],
+			vm_events[VMSTAT_FAULT_MINOR], vm_events[VMSTAT_FAULT_BAD],
+			vm_events[VMSTAT_FAULT_STACK]);
+	printf ("VM: minor fault latency p50 < %llu, p90 < %llu, p99 < %llu cycles\n",
+			fault_percentile (minor_hist, 50), fault_percentile (minor_hist, 90),
+			fault_percentile (minor_hist, 99));
+	printf ("VM: major fault latency p50 < %llu, p90 < %llu, p99 < %llu cycles\n",
+			fault_percentile (major_hist, 50), fault_percentile (major_hist, 90),
+			fault_percentile (major_hist, 99));
+	printf ("VM: %lld pages swapped in, %lld swapped out, %lld read from files\n",
+			vm_events[VMSTAT_SWAP_IN], vm_events[VMSTAT_SWAP_OUT],
+			vm_events[VMSTAT_FILE_IN]);
+	printf ("VM: %lld frames scanned by the clock, %lld.%02lld per victim, "
+			"%lld remapped while being reclaimed\n", vm_events[VMSTAT_SCAN],
+			scans_per_victim / 100, scans_per_victim % 100, remap_cnt);
+	printf ("VM: kswapd woken %lld times, %lld batches, %lld frames reclaimed\n",
+			kswapd_wake_cnt, kswapd_batch_cnt, kswapd_reclaim_cnt);
+	printf ("VM: %lld pages read ahead from swap\n", readahead_cnt);
+	printf ("VM: working set sampled %lld times, %lld cold pages of idle "
+			"processes trimmed, %lld frames in %lld batches\n", wss_sample_cnt,
+			vm_events[VMSTAT_TRIM], trim_reclaim_cnt, trim_batch_cnt);
+	printf ("VM: zswap %zu pages in %zu pool pages, %zu zero pages, "
+			"ratio %lld.%02lld, %lld incompressible\n",
+			zs.stored, zs.pool_pages, zs.zero,
+			zs.comp_bytes ? zs.orig_bytes / zs.comp_bytes : 0,
+			zs.comp_bytes ? zs.orig_bytes * 100 / zs.comp_bytes % 100 : 0,
+			zs.rejects);
+	printf ("VM: zswap kept %lld page writes and %lld page reads off the disk, "
+			"%lld written back\n", zs.stores, zs.loads, zs.writebacks);
+	printf ("VM: %lld file pages faulted around in %lld reads\n",
+			fault_around_cnt, fault_around_reads);
+	printf ("VM: %lld dirty file pages written back in %lld writes\n",
+			writeback_pages, writeback_writes);
+	printf ("VM: zero-copy read %lld pages from disk and %lld from the text cache, "
+			"%lld without a copy-on-write copy; wrote %lld pages\n",
+			zero_copy_disk, zero_copy_cached, zero_copy_cow_cnt, zero_copy_writes);
+	printf ("VM: %lld pages populated ahead of use, %lld lazily freed pages dropped\n",
+			populate_cnt, lazyfree_cnt);
+	printf ("VM: %lld text pages mapped from the text cache, %zu cached\n",
+			text_share_cnt, text_cached ());
+	printf ("VM: %lld pages shared by fork, %lld copied on write\n",
+			cow_share_cnt, vm_events[VMSTAT_FAULT_COW]);
+	printf ("VM: shared anonymous memory %lld pages loaded, %lld mapped from "
+			"another process\n", shm_load_cnt, shm_share_cnt);
+	printf ("VM: stack grew %lld pages up to faults and %lld ahead of use, "
+			"%lld overflows hit the guard page\n", stack_grow_pages, stack_ahead_pages,
+			stack_overflow_cnt);
+	uffd_get_stats (&uffd_copied, &uffd_zeroed);
+	printf ("VM: %lld faults resolved by user-level handlers, %lld pages "
+			"copied and %lld zeroed\n", vm_events[VMSTAT_FAULT_USER], uffd_copied,
+			uffd_zeroed);
+	printf ("VM: %lld address spaces torn down, %lld pages in %lld batches\n",
+			reap_space_cnt, reap_page_cnt, reap_batch_cnt);
+	printf ("VM: zero page mapped by %d pages, %lld read faults served, "
+			"%lld promoted on write\n",
+			zero_frame != NULL ? zero_frame->ref_cnt : 0, vm_events[VMSTAT_FAULT_ZERO],
+			zero_cow_cnt);
+
+	lock_acquire (&frame_lock);
+	for (i = 0; i < frame_cnt; i++)
+		if (frame_table[i].kva != NULL && frame_table[i].ksm_merged) {
+			ksm_shared++;
+			ksm_sharing += frame_table[i].ref_cnt;
+		}
+	lock_release (&frame_lock);
+	printf ("VM: ksm scanned %lld frames, merged %lld, "
+			"%zu frames shared by %zu pages, %zu in the table\n",
+			ksm_scan_cnt, ksm_merge_cnt, ksm_shared, ksm_sharing,
+			ksm_listed_cnt ());
 }
@@ -0,0 +1,171 @@
+/* vma.c: 주소 공간의 구간(VMA)
+ *
+ * mmap 한 번이나 실행 파일의 PT_LOAD 세그먼트 하나처럼 같은 방식으로 채워지는 주소 범위를
+ * 구간 하나로 기록합니다. 구간은 주소 순으로 정렬된 배열에 두고 이진 탐색으로 찾습니다.
+ * 구간 안의 페이지는 처음 찾을 때(대개 첫 fault) struct page를 만들어 SPT에 넣으므로,
+ * 큰 mmap도 만드는 비용이 페이지 수와 무관합니다. */
+
+#include "vm/vm.h"
+#include "vm/vma.h"
+#include <string.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* 구간 목록을 빈 상태로 초기화합니다. */
+void
+vma_init (struct vm_areas *vmas) {
+	vmas->areas = NULL;
+	vmas->cnt = vmas->cap = 0;
+}
+
+/* VA 이상에서 끝나는 첫 구간의 번호, 즉 VA를 담거나 VA 뒤에 오는 첫 구간의 번호를 반환합니다. */
+static size_t
+lower_bound (struct vm_areas *vmas, const void *va) {
+	size_t lo = 0, hi = vmas->cnt;
+
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+
+		if (vmas->areas[mid].end <= va)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* VA를 담은 구간을 반환합니다. 없으면 NULL. 구간을 넣거나 빼면 포인터는 무효가 됩니다. */
+struct vm_area *
+vma_find (struct vm_areas *vmas, const void *va) {
+	size_t i = lower_bound (vmas, va);
+
+	if (i < vmas->cnt && vmas->areas[i].start <= va)
+		return &vmas->areas[i];
+	return NULL;
+}
+
+/* [START, END)와 겹치는 구간이 있으면 true를 반환합니다. */
+bool
+vma_overlaps (struct vm_areas *vmas, const void *start, const void *end) {
+	size_t i = lower_bound (vmas, start);
+
+	return i < vmas->cnt && vmas->areas[i].start < end;
+}
+
+/* AREA를 복사해 넣습니다. 다른 구간과 겹치거나 메모리가 없으면 false를 반환합니다.
+ * 성공하면 AREA->file은 구간이 소유합니다. */
+bool
+vma_insert (struct vm_areas *vmas, const struct vm_area *area) {
+	size_t i;
+
+	ASSERT (pg_ofs (area->start) == 0 && pg_ofs (area->end) == 0);
+	ASSERT (area->start < area->end);
+
+	if (vma_overlaps (vmas, area->start, area->end))
+		return false;
+	if (vmas->cnt == vmas->cap) {
+		size_t cap = vmas->cap ? vmas->cap * 2 : 4;
+		struct vm_area *areas = realloc (vmas->areas, cap * sizeof *areas);
+
+		if (areas == NULL)
+			return false;
+		vmas->areas = areas;
+		vmas->cap = cap;
+	}
+	i = lower_bound (vmas, area->start);
+	memmove (&vmas->areas[i + 1], &vmas->areas[i],
+			(vmas->cnt - i) * sizeof *vmas->areas);
+	vmas->areas[i] = *area;
+	vmas->cnt++;
+	return true;
+}
+
+/* AREA를 빼고 그 파일을 닫거나 공유 객체의 참조를 내려놓습니다.
+ * 구간 안의 페이지는 호출자가 먼저 정리해야 합니다. */
+void
+vma_remove (struct vm_areas *vmas, struct vm_area *area) {
+	size_t i = area - vmas->areas;
+
+	ASSERT (i < vmas->cnt);
+	file_close (area->file);
+	if (area->shm != NULL)
+		shm_put (area->shm);
+	memmove (&vmas->areas[i], &vmas->areas[i + 1],
+			(vmas->cnt - i - 1) * sizeof *vmas->areas);
+	vmas->cnt--;
+}
+
+/* fork: SRC의 구간을 DST로 복사합니다. 파일은 구간마다 다시 열어 자식이 따로 소유하고,
+ * 공유 익명 구간은 같은 객체를 가리키게 해서 부모와 자식이 함께 씁니다.
+ * 사용자가 처리하는 구간은 등록이 넘어가지 않으므로 자식에게는 보통 익명 구간이 됩니다. */
+bool
+vma_copy (struct vm_areas *dst, struct vm_areas *src) {
+	size_t i;
+
+	if (src->cnt == 0)
+		return true;
+	dst->areas = malloc (src->cnt * sizeof *dst->areas);
+	if (dst->areas == NULL)
+		return false;
+	dst->cap = src->cnt;
+	for (i = 0; i < src->cnt; i++) {
+		dst->areas[i] = src->areas[i];
+		dst->areas[i].uffd = false;
+		if (src->areas[i].shm != NULL)
+			shm_get (src->areas[i].shm);
+		else if (src->areas[i].file != NULL) {
+			dst->areas[i].file = file_reopen (src->areas[i].file);
+			if (dst->areas[i].file == NULL)
+				return false;
+		}
+		dst->cnt++;
+	}
+	return true;
+}
+
+/* [START, END)와 겹치는 모든 구간의 힌트를 ADVICE로 바꿉니다.
+ * 구간을 나누지 않으므로 구간의 일부만 지정해도 구간 전체에 적용됩니다. */
+void
+vma_advise (struct vm_areas *vmas, const void *start, const void *end,
+		int advice) {
+	size_t i;
+
+	for (i = lower_bound (vmas, start); i < vmas->cnt && vmas->areas[i].start < end; i++)
+		vmas->areas[i].advice = advice;
+}
+
+/* 모든 구간의 파일을 닫고 공유 객체의 참조를 내려놓은 뒤 목록을 비웁니다. */
+void
+vma_destroy (struct vm_areas *vmas) {
+	size_t i;
+
+	for (i = 0; i < vmas->cnt; i++) {
+		file_close (vmas->areas[i].file);
+		if (vmas->areas[i].shm != NULL)
+			shm_put (vmas->areas[i].shm);
+	}
+	free (vmas->areas);
+	vma_init (vmas);
+}
+
+/* 현재 프로세스의 SPT에 아직 없는 VA의 페이지를, VA를 담은 구간에 맞게 만들어 넣습니다.
+ * VA가 어느 구간에도 없거나 메모리가 없으면 false를 반환합니다. */
+bool
+vma_fault_in (struct supplemental_page_table *spt, void *va) {
+	struct vm_area *area;
+
+	ASSERT (spt == &thread_current ()->spt);
+
+	area = vma_find (&spt->vmas, va);
+	/* 스택 페이지는 rsp를 보고 vm_try_handle_fault()가 만들고,
+	 * 사용자가 처리하는 구간의 페이지는 처리 프로세스가 채워 줌 */
+	if (area == NULL || area->stack || area->uffd)
+		return false;
+	if (area->type == VM_SHM)
+		return shm_fault_in (area, pg_round_down (va));
+	if (area->type == VM_ANON)
+		return vm_alloc_page (VM_ANON, pg_round_down (va), area->writable);
+	return file_backed_fault_in (area, pg_round_down (va));
+}
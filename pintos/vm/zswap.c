@@ -0,0 +1,308 @@
+/* zswap.c: swap 디스크 앞에 두는 압축 메모리 캐시
+ *
+ * swap_write()가 내보내는 페이지를 먼저 여기서 압축해 커널 메모리(pool)에 둡니다.
+ * 모두 0인 페이지는 slot의 비트 하나로만 기록하고, 압축해도 ZSWAP_MAX_LEN보다 크면 디스크로 보냅니다.
+ * pool은 크기 등급(size class)별 slab입니다. pool 페이지 하나를 한 등급의 같은 크기 객체로 나누고,
+ * 등급마다 빈 객체가 있는 페이지 목록을 둡니다. 압축한 페이지는 자기 길이를 담는 가장 작은 등급에 들어갑니다.
+ * pool이 zswap_max_pages에 닿으면 가장 오래전에 넣은 항목부터(LRU) 풀어서 원래 slot의 디스크 자리에 씁니다.
+ * kernel pool이 모자랄 때도 shrinker로 같은 순서로 디스크에 써서 pool 페이지를 돌려줍니다.
+ * 항목은 slot의 마지막 참조가 풀릴 때(swap_free) 사라지므로, fork로 공유한 slot도 여러 번 읽을 수 있습니다. */
+
+#include "vm/zswap.h"
+#include <bitmap.h>
+#include <list.h>
+#include <string.h>
+#include "vm/lz.h"
+#include "vm/swap.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+#define ZSWAP_CLASS_SIZE 64                    /* 등급 간격(바이트) */
+#define ZSWAP_MAX_LEN (PGSIZE / 2)             /* 이보다 크면 pool 페이지 하나에 둘도 못 넣어 이득이 없음 */
+#define ZSWAP_CLASSES (ZSWAP_MAX_LEN / ZSWAP_CLASS_SIZE)
+#define ZSWAP_WB_MAX 8                         /* 한 번 넣을 때 디스크로 내보내는 최대 항목 수 */
+
+/* 한 등급의 객체로 나눈 pool 페이지 */
+struct zpage {
+	struct list_elem elem;      /* 등급의 partial 목록 원소 */
+	uint8_t *kva;
+	void *free;                 /* 빈 객체 목록. 빈 객체 앞 8바이트에 다음 객체 주소를 둠 */
+	uint16_t cls;
+	uint16_t used;              /* 쓰고 있는 객체 수 */
+};
+
+/* pool에 들어 있는 slot 하나 */
+struct zswap_entry {
+	struct list_elem lru_elem;
+	size_t slot;
+	struct zpage *zp;
+	void *obj;
+	uint16_t len;               /* 압축한 길이 */
+};
+
+size_t zswap_max_pages = ZSWAP_DEFAULT_PAGES;
+
+static size_t slot_cnt;
+static struct zswap_entry **entries;   /* slot별 항목. 없으면 NULL */
+static struct bitmap *zero_slots;      /* 모두 0인 페이지를 담은 slot */
+static struct list partial[ZSWAP_CLASSES];  /* 등급별로 빈 객체가 있는 pool 페이지 */
+static struct list lru;                /* 넣은 순서. 앞이 가장 오래됨 */
+static uint8_t *cbuf;                  /* 압축 결과를 받는 페이지 */
+static uint8_t *wbuf;                  /* 디스크로 내보낼 때 푸는 페이지 */
+static void *work;                     /* lz_compress()의 작업 공간 */
+static struct zswap_stats stats;
+/* 위의 모든 것을 보호. swap_lock보다 나중에 잡음.
+ * LRU 항목을 디스크에 쓰는 동안에도 잡고 있어서 그 slot을 다른 스레드가 중간에 읽지 못함 */
+static struct lock zswap_lock;
+
+static size_t zswap_shrink (size_t target);
+
+/* kernel pool이 모자라면 pool 페이지를 돌려줌 */
+static struct shrinker zswap_shrinker = {
+	.name = "zswap",
+	.shrink = zswap_shrink,
+};
+
+/* slot SLOT_CNT개를 위한 캐시를 만듭니다. zswap_max_pages가 0이면 꺼 둡니다. */
+void
+zswap_init (size_t slot_cnt_) {
+	size_t i;
+
+	lock_init (&zswap_lock);
+	list_init (&lru);
+	for (i = 0; i < ZSWAP_CLASSES; i++)
+		list_init (&partial[i]);
+	if (zswap_max_pages == 0 || slot_cnt_ == 0)
+		return;
+
+	entries = calloc (slot_cnt_, sizeof *entries);
+	zero_slots = bitmap_create (slot_cnt_);
+	cbuf = palloc_get_page (0);
+	wbuf = palloc_get_page (0);
+	work = palloc_get_page (0);
+	if (entries == NULL || zero_slots == NULL || cbuf == NULL || wbuf == NULL
+			|| work == NULL)
+		PANIC ("zswap_init: out of memory");
+	slot_cnt = slot_cnt_;
+	palloc_register_shrinker (0, &zswap_shrinker);
+}
+
+/* KVA의 한 페이지가 모두 0이면 true */
+static bool
+page_is_zero (const void *kva) {
+	const uint64_t *p = kva;
+	size_t i;
+
+	for (i = 0; i < PGSIZE / sizeof *p; i++)
+		if (p[i] != 0)
+			return false;
+	return true;
+}
+
+static size_t
+class_size (size_t cls) {
+	return (cls + 1) * ZSWAP_CLASS_SIZE;
+}
+
+/* CLS 등급 객체 하나를 할당하고 그 pool 페이지를 *ZP에 돌려줍니다.
+ * pool이 zswap_max_pages에 닿았거나 메모리가 없으면 NULL. */
+static void *
+obj_alloc (size_t cls, struct zpage **zp_) {
+	struct zpage *zp;
+	void *obj;
+
+	if (!list_empty (&partial[cls]))
+		zp = list_entry (list_front (&partial[cls]), struct zpage, elem);
+	else {
+		size_t size = class_size (cls), i;
+
+		if (stats.pool_pages >= zswap_max_pages || (zp = malloc (sizeof *zp)) == NULL)
+			return NULL;
+		zp->kva = palloc_get_page (0);
+		if (zp->kva == NULL) {
+			free (zp);
+			return NULL;
+		}
+		zp->cls = cls;
+		zp->used = 0;
+		zp->free = NULL;
+		for (i = PGSIZE / size; i-- > 0; ) {
+			*(void **) (zp->kva + i * size) = zp->free;
+			zp->free = zp->kva + i * size;
+		}
+		list_push_front (&partial[cls], &zp->elem);
+		stats.pool_pages++;
+	}
+
+	obj = zp->free;
+	zp->free = *(void **) obj;
+	zp->used++;
+	if (zp->free == NULL)
+		list_remove (&zp->elem);
+	*zp_ = zp;
+	return obj;
+}
+
+/* ZP의 객체 OBJ를 돌려줍니다. 페이지가 비면 pool에서 뺍니다. */
+static void
+obj_free (struct zpage *zp, void *obj) {
+	if (zp->free == NULL)
+		list_push_front (&partial[zp->cls], &zp->elem);
+	*(void **) obj = zp->free;
+	zp->free = obj;
+	if (--zp->used == 0) {
+		list_remove (&zp->elem);
+		palloc_free_page (zp->kva);
+		free (zp);
+		stats.pool_pages--;
+	}
+}
+
+/* 항목 E를 pool에서 뺍니다. zswap_lock을 잡고 호출해야 합니다. */
+static void
+entry_free (struct zswap_entry *e) {
+	entries[e->slot] = NULL;
+	list_remove (&e->lru_elem);
+	obj_free (e->zp, e->obj);
+	stats.stored--;
+	free (e);
+}
+
+/* SLOT에 대해 기억하던 것을 잊습니다. zswap_lock을 잡고 호출해야 합니다. */
+static void
+slot_drop (size_t slot) {
+	if (bitmap_test (zero_slots, slot)) {
+		bitmap_reset (zero_slots, slot);
+		stats.zero--;
+	}
+	if (entries[slot] != NULL)
+		entry_free (entries[slot]);
+}
+
+/* 가장 오래된 항목을 풀어서 디스크의 자기 slot에 쓰고 pool에서 뺍니다. */
+static void
+writeback_oldest (void) {
+	struct zswap_entry *e = list_entry (list_front (&lru), struct zswap_entry, lru_elem);
+
+	if (!lz_decompress (e->obj, e->len, wbuf, PGSIZE))
+		PANIC ("zswap: slot %zu is corrupted", e->slot);
+	swap_disk_write (e->slot, wbuf);
+	stats.writebacks++;
+	entry_free (e);
+}
+
+/* 오래된 항목부터 디스크에 써서 pool 페이지를 TARGET개까지 돌려주고, 돌려준 수를 반환합니다.
+ * palloc_get_page()가 부르므로, 이미 zswap_lock을 잡은 채 pool 페이지를 얻으려던 중이면
+ * 아무것도 하지 않습니다. 페이지는 그 안의 항목이 모두 빠져야 돌아갑니다. */
+static size_t
+zswap_shrink (size_t target) {
+	size_t before, freed;
+
+	if (slot_cnt == 0 || lock_held_by_current_thread (&zswap_lock)
+			|| !lock_try_acquire (&zswap_lock))
+		return 0;
+	before = stats.pool_pages;
+	while (before - stats.pool_pages < target && !list_empty (&lru))
+		writeback_oldest ();
+	freed = before - stats.pool_pages;
+	lock_release (&zswap_lock);
+	return freed;
+}
+
+/* KVA의 한 페이지를 SLOT의 내용으로 메모리에 둡니다.
+ * 꺼져 있거나, 압축이 잘 안 되거나, 공간을 만들지 못하면 false를 반환하고 호출자가 디스크에 씁니다. */
+bool
+zswap_store (size_t slot, const void *kva) {
+	struct zswap_entry *e;
+	struct zpage *zp;
+	size_t len, cls;
+	void *obj;
+	int i;
+
+	if (slot >= slot_cnt)
+		return false;
+	lock_acquire (&zswap_lock);
+	slot_drop (slot);
+	if (page_is_zero (kva)) {
+		bitmap_mark (zero_slots, slot);
+		stats.zero++;
+		stats.stores++;
+		lock_release (&zswap_lock);
+		return true;
+	}
+
+	len = lz_compress (kva, PGSIZE, cbuf, ZSWAP_MAX_LEN, work);
+	if (len == 0 || (e = malloc (sizeof *e)) == NULL) {
+		stats.rejects++;
+		lock_release (&zswap_lock);
+		return false;
+	}
+	cls = (len - 1) / ZSWAP_CLASS_SIZE;
+	obj = obj_alloc (cls, &zp);
+	for (i = 0; obj == NULL && i < ZSWAP_WB_MAX && !list_empty (&lru); i++) {
+		writeback_oldest ();
+		obj = obj_alloc (cls, &zp);
+	}
+	if (obj == NULL) {
+		free (e);
+		lock_release (&zswap_lock);
+		return false;
+	}
+
+	memcpy (obj, cbuf, len);
+	e->slot = slot;
+	e->zp = zp;
+	e->obj = obj;
+	e->len = len;
+	entries[slot] = e;
+	list_push_back (&lru, &e->lru_elem);
+	stats.stored++;
+	stats.stores++;
+	stats.orig_bytes += PGSIZE;
+	stats.comp_bytes += len;
+	lock_release (&zswap_lock);
+	return true;
+}
+
+/* SLOT이 메모리에 있으면 KVA로 풀어 놓고 true를, 없으면 false를 반환합니다. */
+bool
+zswap_load (size_t slot, void *kva) {
+	bool found = true;
+
+	if (slot >= slot_cnt)
+		return false;
+	lock_acquire (&zswap_lock);
+	if (bitmap_test (zero_slots, slot))
+		memset (kva, 0, PGSIZE);
+	else if (entries[slot] != NULL) {
+		struct zswap_entry *e = entries[slot];
+
+		if (!lz_decompress (e->obj, e->len, kva, PGSIZE))
+			PANIC ("zswap: slot %zu is corrupted", slot);
+	} else
+		found = false;
+	if (found)
+		stats.loads++;
+	lock_release (&zswap_lock);
+	return found;
+}
+
+/* 비워진 SLOT을 캐시에서 지웁니다. */
+void
+zswap_invalidate (size_t slot) {
+	if (slot >= slot_cnt)
+		return;
+	lock_acquire (&zswap_lock);
+	slot_drop (slot);
+	lock_release (&zswap_lock);
+}
+
+/* 통계를 ST에 복사합니다. */
+void
+zswap_get_stats (struct zswap_stats *st) {
+	lock_acquire (&zswap_lock);
+	*st = stats;
+	lock_release (&zswap_lock);
+}